@@ -44,10 +44,10 @@
 #include "mptype.h"
 #include <vector>
 
-class MPString;
-
 namespace MaxPlus {
 
+class MPString;
+
 class Sizes : public std::vector<unsigned int> {
 public:
     [[nodiscard]] Sizes refineWith(const Sizes &s) const;
@@ -48,6 +48,7 @@
 #include "maxplus/base/string/cstring.h"
 #include <cassert>
 #include <cmath>
+#include <functional>
 
 #define MPTIME_MAXVAL 1.0e+30
 #define MPTIME_MIN_INF_VAL -1.0e+30
@@ -229,4 +230,12 @@ inline MPString timeToLaTeXString(MPTime val) {
 }
 
 } // namespace MaxPlus
+
+// hash an MPTime consistently with its (exact) equality
+template <> struct std::hash<MaxPlus::MPTime> {
+    std::size_t operator()(const MaxPlus::MPTime &t) const noexcept {
+        return std::hash<MaxPlus::CDouble>()(static_cast<MaxPlus::CDouble>(t));
+    }
+};
+
 #endif
\ No newline at end of file
@@ -90,6 +90,72 @@ CDouble maximumCycleMeanKarpGeneral(MCMgraph &g);
 /// critical node.</returns>
 CDouble maximumCycleMeanKarpDoubleGeneral(MCMgraph &g, const MCMnode **criticalNode = nullptr);
 
+/// <summary>
+///		The algorithms available to compute the maximum cycle mean or ratio of an
+///		MCMgraph. Automatic selects an algorithm based on the graph.
+/// </summary>
+enum class MCMAlgorithm { Automatic, Karp, KarpDouble, Howard, DasdanGupta, YoungTarjanOrlin };
+
+/// <summary>
+///		The thresholds for the selection of Young-Tarjan-Orlin over Howard by
+///		selectMaximumCycleMeanAlgorithm. The defaults are calibrated with maxplus_bench.
+///		A threshold that cannot be met, e.g. a share above 1, disables its criterion.
+/// </summary>
+struct MCMSelectionThresholds {
+    // smallest share of the edges that have no delay
+    CDouble minZeroDelayShare = 0.5;
+    // smallest average out-degree, i.e., number of edges over number of nodes
+    CDouble minDensity = 120.0;
+};
+
+/// <summary>
+///		The function selects the algorithm that is used by maximumCycleMean or
+///		maximumCycleRatio for the graph g if no algorithm is forced. For the cycle
+///		mean, Young-Tarjan-Orlin is selected for graphs that satisfy its assumptions
+///		and in which a large share of the edges has no delay, such as the precedence
+///		graphs of dataflow graphs, or which are dense; see MCMSelectionThresholds.
+///		Howard is selected otherwise, and always for the cycle ratio.
+/// </summary>
+/// <param name="g">graph to analyse</param>
+/// <param name="ratio">select for the cycle ratio instead of the cycle mean</param>
+/// <returns>The selected algorithm, never Automatic.</returns>
+MCMAlgorithm selectMaximumCycleMeanAlgorithm(MCMgraph &g, bool ratio = false);
+
+/// <summary>
+///		The thresholds currently used by selectMaximumCycleMeanAlgorithm.
+/// </summary>
+/// <returns>The current thresholds.</returns>
+MCMSelectionThresholds mcmSelectionThresholds();
+
+/// <summary>
+///		Change the thresholds used by selectMaximumCycleMeanAlgorithm, to recalibrate
+///		the selection for other graphs or machines.
+/// </summary>
+/// <param name="thresholds">the new thresholds</param>
+void setMCMSelectionThresholds(const MCMSelectionThresholds &thresholds);
+
+/// <summary>
+///		The function computes the maximum cycle mean of an MCMgraph.
+///		Does not require that all nodes of the graph have an outgoing edge.
+///		Note that Karp assumes integer edge weights.
+/// </summary>
+/// <param name="g">graph to analyse</param>
+/// <param name="algorithm">optional, the algorithm to use</param>
+/// <returns>The maximum cycle mean of the graph.</returns>
+CDouble maximumCycleMean(MCMgraph &g, MCMAlgorithm algorithm = MCMAlgorithm::Automatic);
+
+/// <summary>
+///		The function computes the maximum cycle ratio of edge weight over edge delay
+///		of an MCMgraph. Only Howard and YoungTarjanOrlin support cycle ratios.
+/// </summary>
+/// <param name="g">graph to analyse</param>
+/// <param name="cycle">optional, will contain the edges of a critical cycle.</param>
+/// <param name="algorithm">optional, the algorithm to use</param>
+/// <returns>The maximum cycle ratio of the graph.</returns>
+CDouble maximumCycleRatio(MCMgraph &g,
+                          std::vector<const MCMedge *> *cycle = nullptr,
+                          MCMAlgorithm algorithm = MCMAlgorithm::Automatic);
+
 /**
  * mcmGetAdjacentActors ()
  * The function returns a list with actors directly reachable from
@@ -0,0 +1,119 @@
+/*
+ *  Eindhoven University of Technology
+ *  Eindhoven, The Netherlands
+ *  Dept. of Electrical Engineering
+ *  Electronics Systems Group
+ *  Model Based Design Lab (https://computationalmodeling.info/)
+ *
+ *  Name            :   mcmapproximate.h
+ *
+ *  Function        :   Approximate the maximum cycle mean or ratio of a
+ *                      graph with guaranteed bounds.
+ *
+ *  Copyright 2023 Eindhoven University of Technology
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the “Software”),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included
+ *  in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#ifndef MAXPLUS_BASE_ANALYSIS_MCM_MCMAPPROXIMATE_H_INCLUDED
+#define MAXPLUS_BASE_ANALYSIS_MCM_MCMAPPROXIMATE_H_INCLUDED
+
+#include "maxplus/base/analysis/mcm/mcmgraph.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace MaxPlus::Graphs {
+
+/**
+ * ApproximateMCM
+ * Anytime computation of the maximum cycle mean (or the maximum cycle ratio of
+ * edge weight over edge delay) of a graph. It maintains a lower bound, the
+ * ratio of a cycle that has been found, and an upper bound, certified by
+ * potentials pi with pi[u] >= w - lambda * d + pi[v] for every edge from u to
+ * v. Both bounds are valid at any time and only move towards each other.
+ *
+ * The bounds are refined with Lawler's parametric search: a queue-based
+ * Bellman-Ford searches a cycle that is positive for the weights w - lambda * d
+ * for a lambda between the bounds. A positive cycle raises the lower bound to
+ * its ratio; otherwise the potentials lower the upper bound to lambda, or
+ * below. The potentials of the last successful check are the starting point
+ * of the next one.
+ *
+ * Refinement stops when the requested relative gap is reached, the time
+ * budget is spent or the cancel flag is set. An interrupted check leaves the
+ * bounds untouched, so the object can be refined further at any later point.
+ * A graph without cycles has both bounds -INFINITY; a graph with a cycle of
+ * zero delay has both bounds INFINITY in ratio mode.
+ */
+class ApproximateMCM {
+public:
+    explicit ApproximateMCM(MCMgraph &g, bool ratio = false);
+
+    // the bounds on the maximum cycle mean or ratio
+    [[nodiscard]] CDouble lowerBound() const { return this->lower; }
+    [[nodiscard]] CDouble upperBound() const { return this->upper; }
+
+    // the edges of a cycle with a mean or ratio equal to the lower bound
+    [[nodiscard]] const std::vector<const MCMedge *> &criticalCycle() const {
+        return this->cycle;
+    }
+
+    // whether the gap between the bounds is at most tolerance relative to their magnitude
+    [[nodiscard]] bool converged(CDouble tolerance) const;
+
+    // refine the bounds, returns whether the gap is within the tolerance
+    bool refine(CDouble tolerance,
+                std::chrono::nanoseconds budget = std::chrono::nanoseconds::max(),
+                const std::atomic<bool> *cancel = nullptr);
+
+private:
+    enum class CheckResult { NoPositiveCycle, PositiveCycle, Interrupted };
+
+    bool ratio;
+    CDouble lower = -INFINITY;
+    CDouble upper = INFINITY;
+    std::vector<const MCMedge *> cycle;
+
+    // the trimmed graph, with the incoming arcs of every node
+    int nrNodes = 0;
+    std::vector<const MCMedge *> arcs;
+    std::vector<int> ij;
+    std::vector<CDouble> w;
+    std::vector<CDouble> d;
+    std::vector<int> inStart;
+    std::vector<int> inArcs;
+
+    // potentials that certify the upper bound
+    std::vector<CDouble> potential;
+
+    // the step above the lower bound that is tried while there is no upper bound
+    CDouble step = 1.0;
+
+    void setCycle(const std::vector<int> &arcsOnCycle);
+    CheckResult check(CDouble lambda,
+                      std::chrono::steady_clock::time_point start,
+                      std::chrono::nanoseconds budget,
+                      const std::atomic<bool> *cancel);
+};
+
+} // namespace MaxPlus::Graphs
+
+#endif
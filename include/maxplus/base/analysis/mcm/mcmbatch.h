@@ -0,0 +1,80 @@
+/*
+ *  Eindhoven University of Technology
+ *  Eindhoven, The Netherlands
+ *  Dept. of Electrical Engineering
+ *  Electronics Systems Group
+ *  Model Based Design Lab (https://computationalmodeling.info/)
+ *
+ *  Name            :   mcmbatch.h
+ *
+ *  Function        :   Compute the maximum cycle mean or ratio of a graph
+ *                      for many weight scenarios at once.
+ *
+ *  Copyright 2023 Eindhoven University of Technology
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the “Software”),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included
+ *  in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#ifndef MAXPLUS_BASE_ANALYSIS_MCM_MCMBATCH_H_INCLUDED
+#define MAXPLUS_BASE_ANALYSIS_MCM_MCMBATCH_H_INCLUDED
+
+#include "maxplus/base/analysis/mcm/mcm.h"
+#include "maxplus/base/analysis/mcm/mcmgraph.h"
+#include <vector>
+
+namespace MaxPlus::Graphs {
+
+/**
+ * maximumCycleMeans ()
+ * Computes the maximum cycle mean of the graph g for a number of weight
+ * scenarios that share the topology of g. Row s of weights holds the edge
+ * weights of scenario s, one for every edge of g.getEdges() in that order; the
+ * weights stored in g itself are ignored. The topology is trimmed once for all
+ * scenarios.
+ *
+ * Supported algorithms are Howard, which runs Howard's algorithm per scenario
+ * warm-started with the policy of the previous scenario, and Karp (or
+ * KarpDouble), which runs Karp's algorithm on a block of scenarios at once with
+ * the scenarios in the innermost loop. Automatic selects Karp for small
+ * graphs and Howard otherwise. The scenarios are distributed over nrThreads
+ * threads, or over the number of hardware threads if nrThreads is 0.
+ *
+ * Like maximumCycleMean, the graph does not need to have an outgoing edge on
+ * every node; the result is -INFINITY for a scenario without cycles. Throws an
+ * MPException if a row of weights does not match the number of edges.
+ */
+std::vector<CDouble> maximumCycleMeans(MCMgraph &g,
+                                       const std::vector<std::vector<CDouble>> &weights,
+                                       MCMAlgorithm algorithm = MCMAlgorithm::Automatic,
+                                       unsigned int nrThreads = 0);
+
+/**
+ * maximumCycleRatios ()
+ * Computes the maximum cycle ratio of edge weight over edge delay for a number
+ * of weight scenarios that share the topology and the delays of g, using
+ * Howard's algorithm. The weights and threads are as for maximumCycleMeans.
+ * The result is INFINITY for all scenarios if the graph has a cycle with zero
+ * total delay.
+ */
+std::vector<CDouble> maximumCycleRatios(MCMgraph &g,
+                                        const std::vector<std::vector<CDouble>> &weights,
+                                        unsigned int nrThreads = 0);
+
+} // namespace MaxPlus::Graphs
+#endif
@@ -0,0 +1,78 @@
+/*
+ *  Eindhoven University of Technology
+ *  Eindhoven, The Netherlands
+ *  Dept. of Electrical Engineering
+ *  Electronics Systems Group
+ *  Model Based Design Lab (https://computationalmodeling.info/)
+ *
+ *  Name            :   mcmcritical.h
+ *
+ *  Function        :   Compute the critical graph of the maximum cycle mean
+ *                      or ratio of a graph.
+ *
+ *  Copyright 2023 Eindhoven University of Technology
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the “Software”),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included
+ *  in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#ifndef MAXPLUS_BASE_ANALYSIS_MCM_MCMCRITICAL_H_INCLUDED
+#define MAXPLUS_BASE_ANALYSIS_MCM_MCMCRITICAL_H_INCLUDED
+
+#include "maxplus/base/analysis/mcm/mcmgraph.h"
+#include <cmath>
+#include <vector>
+
+namespace MaxPlus::Graphs {
+
+/**
+ * CriticalGraph
+ * The critical graph of a graph: the nodes and edges that lie on a cycle with
+ * the maximum cycle mean (or ratio). Edge k runs from nodes[ij[2k]] to
+ * nodes[ij[2k+1]]. The critical classes are the strongly connected components
+ * of the critical graph; nodeClass gives the class of every critical node.
+ */
+struct CriticalGraph {
+    CDouble cycleMean = -INFINITY;
+    std::vector<MCMnode *> nodes;
+    std::vector<const MCMedge *> edges;
+    std::vector<int> ij;
+    std::vector<int> nodeClass;
+    int nrClasses = 0;
+};
+
+/**
+ * criticalGraph ()
+ * Computes the critical graph of the maximum cycle mean, or of the maximum
+ * cycle ratio of edge weight over edge delay if ratio is true. Howard's
+ * algorithm gives the maximum cycle mean and the bias v of the nodes. For the
+ * nodes whose cycle time equals the maximum, every edge from i to j satisfies
+ * w - mean * d + v[j] <= v[i]; the cycles of the edges that satisfy it with
+ * equality are exactly the critical cycles. The critical graph is then found
+ * in linear time as the edges inside the strongly connected components of
+ * these tight edges.
+ *
+ * The graph may be arbitrary; a graph without cycles gives an empty critical
+ * graph. Throws an MPException in ratio mode if the graph has a cycle with
+ * zero delay.
+ */
+CriticalGraph criticalGraph(MCMgraph &g, bool ratio = false);
+
+} // namespace MaxPlus::Graphs
+
+#endif
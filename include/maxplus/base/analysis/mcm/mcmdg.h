@@ -58,11 +58,9 @@ namespace MaxPlus::Graphs {
 /**
  * mcmDG ()
  * The function computes the maximum cycle mean of an MCM graph using
- * Dasdan-Gupta's algorithm.
- * Note: this algorithm assumes that edge weights are integer valued !
- *
- * @todo
- * check if algorithm can be generalized to float edge weights
+ * Dasdan-Gupta's algorithm. The storage is proportional to the number of
+ * (level, node) pairs reached by the breadth-first unfolding of the graph,
+ * which is small for sparse graphs.
  */
 CDouble mcmDG(MCMgraph &mcmGraph);
 
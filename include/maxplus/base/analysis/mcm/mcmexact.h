@@ -0,0 +1,82 @@
+/*
+ *  Eindhoven University of Technology
+ *  Eindhoven, The Netherlands
+ *  Dept. of Electrical Engineering
+ *  Electronics Systems Group
+ *  Model Based Design Lab (https://computationalmodeling.info/)
+ *
+ *  Name            :   mcmexact.h
+ *
+ *  Function        :   Compute the maximum cycle mean or ratio of a graph
+ *                      with integer weights exactly.
+ *
+ *  Copyright 2023 Eindhoven University of Technology
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the “Software”),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included
+ *  in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#ifndef MAXPLUS_BASE_ANALYSIS_MCM_MCMEXACT_H_INCLUDED
+#define MAXPLUS_BASE_ANALYSIS_MCM_MCMEXACT_H_INCLUDED
+
+#include "maxplus/base/analysis/mcm/mcm.h"
+#include "maxplus/base/analysis/mcm/mcmgraph.h"
+#include "maxplus/base/fraction/fraction.h"
+#include <vector>
+
+namespace MaxPlus::Graphs {
+
+/**
+ * maximumCycleRatioExact ()
+ * Computes the maximum cycle ratio of edge weight over edge delay of a graph
+ * with integer weights and delays as a fraction in lowest terms, with a
+ * positive denominator.
+ *
+ * Howard's or Young-Tarjan-Orlin's algorithm (or the one selected by
+ * selectMaximumCycleMeanAlgorithm) finds a candidate critical cycle in
+ * floating point. Its ratio p/q is then certified in 64-bit integer arithmetic
+ * by checking that the weights q*w - p*d have no positive cycle, starting from
+ * the scaled bias of Howard's algorithm. If a positive cycle is found, its
+ * ratio is strictly larger and becomes the next candidate. The result is
+ * therefore exact, also for near-ties that the floating point algorithms do
+ * not resolve, while its cost is usually that of the floating point run plus
+ * one linear pass.
+ *
+ * If cycle is not nullptr, it receives the edges of a critical cycle.
+ *
+ * Throws an MPException if a visible weight or delay is not an integer, if the
+ * graph has no cycles or a cycle with zero delay, if an algorithm other than
+ * Automatic, Howard or YoungTarjanOrlin is selected, or if an intermediate
+ * result does not fit in 64 bits.
+ */
+CFraction maximumCycleRatioExact(MCMgraph &g,
+                                 std::vector<const MCMedge *> *cycle = nullptr,
+                                 MCMAlgorithm algorithm = MCMAlgorithm::Automatic);
+
+/**
+ * maximumCycleMeanExact ()
+ * Computes the maximum cycle mean of a graph with integer weights as a fraction
+ * in lowest terms. It is the maximum cycle ratio with all delays equal to one;
+ * see maximumCycleRatioExact for the method and the exceptions.
+ */
+CFraction maximumCycleMeanExact(MCMgraph &g,
+                                std::vector<const MCMedge *> *cycle = nullptr,
+                                MCMAlgorithm algorithm = MCMAlgorithm::Automatic);
+
+} // namespace MaxPlus::Graphs
+#endif
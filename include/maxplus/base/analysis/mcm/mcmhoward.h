@@ -64,6 +64,31 @@ void convertMCMgraphToMatrix(MCMgraph &g,
                              std::unique_ptr<std::vector<int>> *ij,
                              std::unique_ptr<std::vector<CDouble>> *A);
 
+/**
+ * convertMCMgraphToTrimmedMatrix ()
+ * The function converts the visible part of an arbitrary graph into a sparse
+ * matrix input for Howard's algorithm. Nodes that cannot reach a cycle are
+ * removed. The remaining nodes and the edges corresponding to the arcs are
+ * returned in nodes and arcs respectively; A and D hold the weights and delays
+ * of the arcs.
+ */
+void convertMCMgraphToTrimmedMatrix(MCMgraph &g,
+                                    std::vector<MCMnode *> *nodes,
+                                    std::vector<const MCMedge *> *arcs,
+                                    std::vector<int> *ij,
+                                    std::vector<CDouble> *A,
+                                    std::vector<CDouble> *D);
+
+/**
+ * findZeroTransitCycle ()
+ * Determines if the arcs with zero transit time D contain a cycle. If so, the
+ * arcs of such a cycle are returned in cycle.
+ */
+bool findZeroTransitCycle(const std::vector<int> &ij,
+                          const std::vector<CDouble> &D,
+                          int nr_nodes,
+                          std::vector<int> *cycle);
+
 /**
  * Howard ()
  * Howard Policy Iteration Algorithm for Max Plus Matrices.
@@ -71,6 +96,12 @@ void convertMCMgraphToMatrix(MCMgraph &g,
  * INPUT of Howard Algorithm:
  *      ij,A,nnodes,narcs : sparse description of a matrix.
  *
+ * OPTIONAL INPUT:
+ *      initial_policy: policy to start the iteration from instead of the greedy
+ *                      initial policy, e.g., the optimal policy of an earlier run
+ *                      on a graph with the same structure
+ *      initial_bias: bias vector that belongs to initial_policy
+ *
  * OUTPUT:
  *      chi cycle time vector
  *      v bias
@@ -92,17 +123,44 @@ void Howard(const std::vector<int> &ij,
             std::unique_ptr<std::vector<CDouble>> *v,
             std::unique_ptr<std::vector<int>> *policy,
             int *nr_iterations,
-            int *nr_components);
+            int *nr_components,
+            const std::vector<int> *initial_policy = nullptr,
+            const std::vector<CDouble> *initial_bias = nullptr);
+
+/**
+ * HowardRatio ()
+ * Howard Policy Iteration Algorithm for the maximum cycle ratio A/D.
+ *
+ * INPUT and OUTPUT are as for Howard (), with additionally:
+ *      D transit time of every arc
+ *
+ * ASSUMPTIONS
+ *      As for Howard (), and every cycle has a positive transit time
+ */
+void HowardRatio(const std::vector<int> &ij,
+                 const std::vector<CDouble> &A,
+                 const std::vector<CDouble> &D,
+                 int nr_nodes,
+                 int nr_arcs,
+                 std::unique_ptr<std::vector<CDouble>> *chi,
+                 std::unique_ptr<std::vector<CDouble>> *v,
+                 std::unique_ptr<std::vector<int>> *policy,
+                 int *nr_iterations,
+                 int *nr_components,
+                 const std::vector<int> *initial_policy = nullptr,
+                 const std::vector<CDouble> *initial_bias = nullptr);
 
 /**
  * maximumCycleMeanHoward ()
  * Howard Policy Iteration Algorithm for Max Plus Matrices.
  *
  * INPUT MCMgraph which must have outgoing edges from every node
+ *       optionally, the policy and bias of an earlier run (if non-empty)
  *
  * OUTPUT:
  *      maximum cycle mean
  *      a node on the cycle with maximum cycle mean
+ *      optionally, the optimal policy and bias, to warm-start a next run
  *
  * ASSUMPTIONS
  *      The graph has a non-zero number of nodes
@@ -110,7 +168,10 @@ void Howard(const std::vector<int> &ij,
  *      Every node in the graph has outgoing directed edges
  *
  */
-CDouble maximumCycleMeanHoward(MCMgraph &g, MCMnode **criticalNode);
+CDouble maximumCycleMeanHoward(MCMgraph &g,
+                               MCMnode **criticalNode,
+                               std::vector<int> *policy = nullptr,
+                               std::vector<CDouble> *bias = nullptr);
 
 /**
  * maximumCycleMeanHowardGeneral ()
@@ -125,5 +186,19 @@ CDouble maximumCycleMeanHoward(MCMgraph &g, MCMnode **criticalNode);
  */
 CDouble maximumCycleMeanHowardGeneral(MCMgraph &g, MCMnode **criticalNode);
 
+/**
+ * maximumCycleRatioHoward ()
+ * Howard Policy Iteration Algorithm for the maximum cycle ratio of edge
+ * weight over edge delay.
+ *
+ * INPUT MCMgraph which can be arbitrary
+ *
+ * OUTPUT:
+ *      maximum cycle ratio, or -INFINITY if the graph has no cycles and
+ *      INFINITY if it has a cycle with zero total delay
+ *      if cycle is not nullptr, a critical cycle
+ */
+CDouble maximumCycleRatioHoward(MCMgraph &g, std::vector<const MCMedge *> *cycle = nullptr);
+
 } // namespace MaxPlus::Graphs
 #endif
\ No newline at end of file
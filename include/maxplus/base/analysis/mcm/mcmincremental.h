@@ -0,0 +1,129 @@
+/*
+ *  Eindhoven University of Technology
+ *  Eindhoven, The Netherlands
+ *  Dept. of Electrical Engineering
+ *  Electronics Systems Group
+ *  Model Based Design Lab (https://computationalmodeling.info/)
+ *
+ *  Name            :   mcmincremental.h
+ *
+ *  Function        :   Maintain the maximum cycle mean or ratio of a graph
+ *                      under edge updates.
+ *
+ *  Copyright 2023 Eindhoven University of Technology
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the “Software”),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included
+ *  in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#ifndef MAXPLUS_BASE_ANALYSIS_MCM_MCMINCREMENTAL_H_INCLUDED
+#define MAXPLUS_BASE_ANALYSIS_MCM_MCMINCREMENTAL_H_INCLUDED
+
+#include "maxplus/base/analysis/mcm/mcmgraph.h"
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace MaxPlus::Graphs {
+
+/**
+ * IncrementalMCM
+ * Maintains the maximum cycle mean (or the maximum cycle ratio of edge weight
+ * over edge delay) of a graph under a stream of edge updates. It keeps the
+ * optimal policy of Howard's algorithm together with the cycle time and the
+ * bias of every node. An update is first handled locally: changes that keep
+ * the policy optimal cost O(1), and changes to a policy edge that is not on a
+ * policy cycle shift the bias of the policy tree upstream of the edge. Only
+ * when the optimality conditions are violated on the affected region, or a
+ * policy cycle changes, Howard's algorithm is rerun, warm-started with the
+ * current policy and bias.
+ *
+ * The engine works on its own copy of the visible part of the graph; the
+ * edges are identified by their ids in the graph. Like Howard's algorithm it
+ * assumes that every node has an outgoing edge, an MPException is thrown
+ * otherwise.
+ */
+class IncrementalMCM {
+public:
+    explicit IncrementalMCM(MCMgraph &g, bool ratio = false);
+
+    // the current maximum cycle mean or ratio
+    [[nodiscard]] CDouble value() const { return this->mcm; }
+
+    // the ids of the edges of a critical cycle
+    [[nodiscard]] std::vector<CId> criticalCycle() const;
+
+    // change the weight of an edge, returns the new value
+    CDouble setWeight(CId edgeId, CDouble w);
+
+    // add an edge between two existing nodes, returns the new value
+    CDouble insertEdge(CId edgeId, CId srcId, CId dstId, CDouble w, CDouble d = 1.0);
+
+    // remove an edge, returns the new value
+    CDouble removeEdge(CId edgeId);
+
+    // the number of times Howard's algorithm has been run, including the initial run
+    [[nodiscard]] unsigned int nrRecomputations() const { return this->recomputations; }
+
+private:
+    bool ratio;
+    CDouble mcm = -INFINITY;
+    CDouble epsilon = 0.0;
+    unsigned int recomputations = 0;
+
+    // nodes
+    std::unordered_map<CId, int> nodeIndex;
+    std::vector<std::vector<int>> out;
+    std::vector<std::vector<int>> in;
+
+    // edges, removed edges are marked not alive and their slots are reused
+    std::unordered_map<CId, int> edgeIndex;
+    std::vector<CId> edgeId;
+    std::vector<int> src;
+    std::vector<int> dst;
+    std::vector<CDouble> w;
+    std::vector<CDouble> d;
+    std::vector<bool> alive;
+    std::vector<int> freeEdges;
+
+    // the optimal policy: the chosen edge of every node, the nodes whose
+    // policy edge enters a node, and whether a node is on a policy cycle
+    std::vector<int> policy;
+    std::vector<std::vector<int>> policyIn;
+    std::vector<bool> onCycle;
+    std::vector<CDouble> chi;
+    std::vector<CDouble> v;
+
+    // scratch marks of the nodes in a policy tree, and the number of nodes
+    // visited by the local repair of the current update
+    std::vector<bool> mark;
+    size_t work = 0;
+
+    [[nodiscard]] CDouble transit(int e) const { return this->ratio ? this->d[e] : 1.0; }
+    [[nodiscard]] bool violates(int e) const;
+    [[nodiscard]] std::vector<int> policyTree(int u) const;
+    bool shiftPolicyTree(int u, CDouble delta, int avoid, std::vector<int> &violations);
+    bool repair(std::vector<int> &violations);
+    void setPolicy(int u, int e);
+    int newEdge(CId id, int s, int t, CDouble weight, CDouble delay);
+    CDouble recompute();
+};
+
+} // namespace MaxPlus::Graphs
+
+#endif
@@ -50,6 +50,8 @@
 
 #include "maxplus/base/analysis/mcm/mcmgraph.h"
 #include <cstdint>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace MaxPlus::Graphs {
@@ -185,6 +187,64 @@ void convertMCMgraphToYTOgraph(MCMgraph &g,
 
 void mmcycle(graph &gr, CDouble *lambda, std::vector<const arc *> *cycle);
 
+class AlgYTO;
+
+/**
+ * CompiledYTOgraph
+ * The visible part of an MCMgraph, converted once into the input of
+ * Young-Tarjan-Orlin's algorithm, for repeated queries on the same structure.
+ * It owns the node and arc arrays and the heap of the algorithm; the weight
+ * and delay of an edge can be changed in place, after which the next query
+ * reuses all storage. Nodes may have arbitrary ids and edges are identified
+ * by their ids in the original graph, which need not be kept alive.
+ *
+ * As for the functions above, the graph must have a cycle and the cycles must
+ * have a positive weight (for the maximum ratio and mean) or delay (for the
+ * minimum ratio). The critical cycles are returned as edge ids, following the
+ * edges forward.
+ */
+class CompiledYTOgraph {
+public:
+    explicit CompiledYTOgraph(MCMgraph &g);
+    ~CompiledYTOgraph();
+
+    CompiledYTOgraph(const CompiledYTOgraph &) = delete;
+    CompiledYTOgraph &operator=(const CompiledYTOgraph &) = delete;
+    CompiledYTOgraph(CompiledYTOgraph &&) = delete;
+    CompiledYTOgraph &operator=(CompiledYTOgraph &&) = delete;
+
+    // change the weight or delay of an edge; throws an MPException for unknown edges
+    void setWeight(CId edgeId, CDouble w);
+    void setDelay(CId edgeId, CDouble d);
+
+    // maximum cycle ratio of edge weight over delay
+    CDouble maximumCycleRatio(std::vector<CId> *cycle = nullptr);
+
+    // maximum cycle mean of edge weight
+    CDouble maximumCycleMean(std::vector<CId> *cycle = nullptr);
+
+    // minimum cycle ratio of edge weight over delay
+    CDouble minimumCycleRatio(std::vector<CId> *cycle = nullptr);
+
+private:
+    enum class Query { MaximumRatio, MaximumMean, MinimumRatio };
+
+    graph gr;
+    std::unique_ptr<AlgYTO> alg;
+
+    // the weight, delay and id of the edge of every arc, and the arc of every edge id
+    std::vector<CDouble> w;
+    std::vector<CDouble> d;
+    std::vector<CId> edgeId;
+    std::unordered_map<CId, std::int32_t> arcIndex;
+
+    // the critical cycle of the last query, as arcs
+    std::vector<const arc *> ytoCycle;
+
+    std::int32_t findArc(CId edgeId) const;
+    CDouble solve(Query query, std::vector<CId> *cycle);
+};
+
 } // namespace MaxPlus::Graphs
 
 #endif
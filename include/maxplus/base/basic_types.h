@@ -47,6 +47,7 @@
 
 /* STL functionality */
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
@@ -70,6 +71,11 @@ using CSize = uint64_t;
 /* Doubles */
 using CDouble = double;
 
+/* Combine the hash value h into seed, to hash composite values */
+inline std::size_t hashCombine(std::size_t seed, std::size_t h) {
+    return seed ^ (h + 0x9e3779b97f4a7c15ULL + (seed << 6U) + (seed >> 2U));
+}
+
 } // namespace MaxPlus
 
 #endif
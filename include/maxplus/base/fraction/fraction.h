@@ -60,6 +60,14 @@ public:
         }
     };
 
+    explicit CFraction(const std::int64_t num, const std::int64_t den) : num(num), den(den) {
+        if (den != 0) {
+            this->val = static_cast<CDouble>(num) / static_cast<CDouble>(den);
+        } else {
+            this->val = 0.0;
+        }
+    };
+
     CFraction(const CFraction &f) = default;
 
     explicit CFraction(const CDouble v) : num(0), den(0), val(0.0) {
@@ -0,0 +1,454 @@
+/*
+ *  Eindhoven University of Technology
+ *  Eindhoven, The Netherlands
+ *  Dept. of Electrical Engineering
+ *  Electronics Systems Group
+ *  Model Based Design Lab (https://computationalmodeling.info/)
+ *
+ *  Name            :   arenafsm.h
+ *
+ *  Function        :   Finite State Machine storage in contiguous arenas
+ *
+ *  Copyright 2023 Eindhoven University of Technology
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the “Software”),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included
+ *  in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+
+#ifndef MAXPLUS_BASE_FSM_ARENAFSM_H
+#define MAXPLUS_BASE_FSM_ARENAFSM_H
+
+#include "maxplus/base/exception/exception.h"
+#include "maxplus/base/fsm/fsm.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace MaxPlus::FSM::Arena {
+
+// states and edges are addressed by dense indices, in the order they were added
+using StateIndex = std::uint32_t;
+using EdgeIndex = std::uint32_t;
+
+constexpr StateIndex NO_STATE = std::numeric_limits<StateIndex>::max();
+constexpr EdgeIndex NO_EDGE = std::numeric_limits<EdgeIndex>::max();
+
+// The outgoing edges of a state, in the order in which they were added.
+// The range is invalidated when edges are added to, or the machine is compacted.
+class OutgoingEdges {
+public:
+    class Iterator {
+    public:
+        Iterator(const EdgeIndex *nextOut, EdgeIndex e) : nextOut(nextOut), e(e) {}
+
+        EdgeIndex operator*() const { return this->e; }
+
+        Iterator &operator++() {
+            this->e = this->nextOut[this->e]; // NOLINT(*pointer-arithmetic)
+            return *this;
+        }
+
+        bool operator==(const Iterator &rhs) const { return this->e == rhs.e; }
+        bool operator!=(const Iterator &rhs) const { return this->e != rhs.e; }
+
+    private:
+        const EdgeIndex *nextOut;
+        EdgeIndex e;
+    };
+
+    OutgoingEdges(const EdgeIndex *nextOut, EdgeIndex first) : nextOut(nextOut), first(first) {}
+
+    [[nodiscard]] Iterator begin() const { return {this->nextOut, this->first}; }
+    [[nodiscard]] Iterator end() const { return {this->nextOut, NO_EDGE}; }
+    [[nodiscard]] bool empty() const { return this->first == NO_EDGE; }
+
+private:
+    const EdgeIndex *nextOut;
+    EdgeIndex first;
+};
+
+//
+// A labeled finite state machine of which the states and edges are stored in
+// contiguous arrays, one array per attribute, instead of as individually
+// allocated objects. A state costs its label and two indices, an edge its
+// label and three indices. The outgoing edges of a state are kept as a chain
+// through the edge array (a forward star), such that edges can be added in
+// constant time; compact() renumbers the edges such that the outgoing edges of
+// every state are adjacent (CSR order).
+//
+// The member functions follow the ones of Labeled::FiniteStateMachine, with
+// indices in place of state and edge references. States and edges cannot be
+// removed. A Labeled::FiniteStateMachine can be converted to and from this
+// representation.
+//
+// This is a standalone representation: it does not derive from
+// Abstract::FiniteStateMachine, and none of the analyses of the library (the
+// searches of fsm.h, MCM analysis, the max-plus automata) use it. Client code
+// that wants its memory layout converts its FSM and works on the indices with
+// the member functions below.
+//
+template <typename StateLabelType, typename EdgeLabelType> class FiniteStateMachine {
+public:
+    FiniteStateMachine() = default;
+
+    // convert a labeled FSM; state indices follow the state ids and the order
+    // of the outgoing edges of every state is preserved.
+    explicit FiniteStateMachine(const Labeled::FiniteStateMachine<StateLabelType, EdgeLabelType> &fsm) {
+        const auto &states = fsm.getStates();
+        const auto &edges = fsm.getEdges();
+        this->reserve(states.size(), edges.size());
+
+        std::unordered_map<Abstract::StateRef, StateIndex> index;
+        index.reserve(states.size());
+        for (const auto *s : fsm.getTypedStates()) {
+            index[s] = this->addState(s->getLabel());
+        }
+        for (const auto *s : fsm.getTypedStates()) {
+            StateIndex src = index[s];
+            for (const auto *e : s->getTypedOutgoingEdges()) {
+                this->addEdge(src, e->getLabel(), index[e->getDestination()]);
+            }
+        }
+        for (const auto *s : fsm.getInitialStates()) {
+            this->addInitialState(index[s]);
+        }
+        for (const auto *s : fsm.getFinalStates()) {
+            this->addFinalState(index[s]);
+        }
+    }
+
+    // convert to a labeled FSM; state and edge ids follow the indices.
+    [[nodiscard]] std::unique_ptr<Labeled::FiniteStateMachine<StateLabelType, EdgeLabelType>>
+    toLabeled() const {
+        auto result = std::make_unique<Labeled::FiniteStateMachine<StateLabelType, EdgeLabelType>>();
+        std::vector<Labeled::StateRef<StateLabelType, EdgeLabelType>> refs;
+        refs.reserve(this->nrStates());
+        for (const auto &l : this->stateLabels) {
+            refs.push_back(result->addState(l));
+        }
+        for (EdgeIndex e = 0; e < this->nrEdges(); e++) {
+            result->addEdge(*refs[this->edgeSource[e]],
+                            this->edgeLabels[e],
+                            *refs[this->edgeDestination[e]]);
+        }
+        for (StateIndex s : this->initialStates) {
+            result->addInitialState(*refs[s]);
+        }
+        for (StateIndex s : this->finalStates) {
+            result->addFinalState(*refs[s]);
+        }
+        return result;
+    }
+
+    void reserve(std::size_t nrOfStates, std::size_t nrOfEdges) {
+        this->stateLabels.reserve(nrOfStates);
+        this->firstOut.reserve(nrOfStates);
+        this->lastOut.reserve(nrOfStates);
+        this->edgeLabels.reserve(nrOfEdges);
+        this->edgeSource.reserve(nrOfEdges);
+        this->edgeDestination.reserve(nrOfEdges);
+        this->nextOut.reserve(nrOfEdges);
+    }
+
+    [[nodiscard]] StateIndex nrStates() const {
+        return static_cast<StateIndex>(this->stateLabels.size());
+    }
+
+    [[nodiscard]] EdgeIndex nrEdges() const {
+        return static_cast<EdgeIndex>(this->edgeLabels.size());
+    }
+
+    // add state with the given label
+    StateIndex addState(const StateLabelType &label) {
+        if (this->stateLabels.size() >= NO_STATE) {
+            throw MaxPlus::MPException("Too many states in Arena::FiniteStateMachine.");
+        }
+        auto s = static_cast<StateIndex>(this->stateLabels.size());
+        this->stateLabels.push_back(label);
+        this->firstOut.push_back(NO_EDGE);
+        this->lastOut.push_back(NO_EDGE);
+        this->labelIndex[label] = s;
+        return s;
+    }
+
+    EdgeIndex addEdge(StateIndex src, const EdgeLabelType &lbl, StateIndex dst) {
+        if (src >= this->nrStates() || dst >= this->nrStates()) {
+            throw MaxPlus::MPException("Unknown state in Arena::FiniteStateMachine::addEdge.");
+        }
+        if (this->edgeLabels.size() >= NO_EDGE) {
+            throw MaxPlus::MPException("Too many edges in Arena::FiniteStateMachine.");
+        }
+        auto e = static_cast<EdgeIndex>(this->edgeLabels.size());
+        this->edgeLabels.push_back(lbl);
+        this->edgeSource.push_back(src);
+        this->edgeDestination.push_back(dst);
+        this->nextOut.push_back(NO_EDGE);
+        if (this->lastOut[src] == NO_EDGE) {
+            this->firstOut[src] = e;
+        } else {
+            this->nextOut[this->lastOut[src]] = e;
+        }
+        this->lastOut[src] = e;
+        return e;
+    }
+
+    [[nodiscard]] const StateLabelType &getStateLabel(StateIndex s) const {
+        return this->stateLabels[s];
+    }
+
+    [[nodiscard]] const EdgeLabelType &getEdgeLabel(EdgeIndex e) const {
+        return this->edgeLabels[e];
+    }
+
+    void setEdgeLabel(EdgeIndex e, const EdgeLabelType &l) { this->edgeLabels[e] = l; }
+
+    [[nodiscard]] StateIndex getSource(EdgeIndex e) const { return this->edgeSource[e]; }
+
+    [[nodiscard]] StateIndex getDestination(EdgeIndex e) const {
+        return this->edgeDestination[e];
+    }
+
+    [[nodiscard]] OutgoingEdges getOutgoingEdges(StateIndex s) const {
+        return {this->nextOut.data(), this->firstOut[s]};
+    }
+
+    // set initial state to state with label;
+    void setInitialState(const StateLabelType &label) {
+        this->setInitialState(this->getStateLabeled(label));
+    }
+
+    void setInitialState(StateIndex s) {
+        this->initialStates.clear();
+        this->addInitialState(s);
+    }
+
+    void addInitialState(StateIndex s) {
+        if (std::find(this->initialStates.begin(), this->initialStates.end(), s)
+            == this->initialStates.end()) {
+            this->initialStates.push_back(s);
+        }
+    }
+
+    void addFinalState(StateIndex s) {
+        if (std::find(this->finalStates.begin(), this->finalStates.end(), s)
+            == this->finalStates.end()) {
+            this->finalStates.push_back(s);
+        }
+    }
+
+    // the first of the initial states
+    [[nodiscard]] StateIndex getInitialState() const {
+        if (this->initialStates.empty()) {
+            throw MaxPlus::MPException("FSM has no initial state.");
+        }
+        return this->initialStates.front();
+    }
+
+    [[nodiscard]] const std::vector<StateIndex> &getInitialStates() const {
+        return this->initialStates;
+    }
+
+    [[nodiscard]] const std::vector<StateIndex> &getFinalStates() const {
+        return this->finalStates;
+    }
+
+    // the state most recently added with label l
+    [[nodiscard]] StateIndex getStateLabeled(const StateLabelType &l) const {
+        auto it = this->labelIndex.find(l);
+        if (it == this->labelIndex.end()) {
+            throw MaxPlus::MPException(
+                    "error - state not found in Arena::FiniteStateMachine::getStateLabeled");
+        }
+        return it->second;
+    }
+
+    [[nodiscard]] bool hasStateLabeled(const StateLabelType &l) const {
+        return this->labelIndex.find(l) != this->labelIndex.end();
+    }
+
+    // the state labeled l, or NO_STATE if no such state exists
+    [[nodiscard]] StateIndex checkStateLabeled(const StateLabelType &l) const {
+        auto it = this->labelIndex.find(l);
+        return it == this->labelIndex.end() ? NO_STATE : it->second;
+    }
+
+    // an edge from source to target, or NO_EDGE if no such edge exists
+    [[nodiscard]] EdgeIndex getEdge(StateIndex source, StateIndex target) const {
+        for (EdgeIndex e : this->getOutgoingEdges(source)) {
+            if (this->edgeDestination[e] == target) {
+                return e;
+            }
+        }
+        return NO_EDGE;
+    }
+
+    // check if there exists a transition e = (q1,alpha,q2)
+    [[nodiscard]] EdgeIndex
+    findEdge(const StateLabelType &src, const EdgeLabelType &lbl, const StateLabelType &dst) const {
+        StateIndex s = this->checkStateLabeled(src);
+        if (s == NO_STATE) {
+            return NO_EDGE;
+        }
+        for (EdgeIndex e : this->getOutgoingEdges(s)) {
+            if (this->edgeLabels[e] == lbl
+                && this->stateLabels[this->edgeDestination[e]] == dst) {
+                return e;
+            }
+        }
+        return NO_EDGE;
+    }
+
+    // return all next states reachable via an edge labelled l, in increasing order
+    [[nodiscard]] std::vector<StateIndex> nextStatesOfEdgeLabel(StateIndex s,
+                                                                const EdgeLabelType &l) const {
+        std::vector<StateIndex> result;
+        for (EdgeIndex e : this->getOutgoingEdges(s)) {
+            if (this->edgeLabels[e] == l) {
+                result.push_back(this->edgeDestination[e]);
+            }
+        }
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    // the states reachable from the initial states, in increasing order
+    [[nodiscard]] std::vector<StateIndex> reachableStates() const {
+        std::vector<bool> visited(this->nrStates(), false);
+        std::vector<StateIndex> stack;
+        for (StateIndex s : this->initialStates) {
+            if (!visited[s]) {
+                visited[s] = true;
+                stack.push_back(s);
+            }
+        }
+        while (!stack.empty()) {
+            StateIndex s = stack.back();
+            stack.pop_back();
+            for (EdgeIndex e : this->getOutgoingEdges(s)) {
+                StateIndex d = this->edgeDestination[e];
+                if (!visited[d]) {
+                    visited[d] = true;
+                    stack.push_back(d);
+                }
+            }
+        }
+        std::vector<StateIndex> result;
+        for (StateIndex s = 0; s < this->nrStates(); s++) {
+            if (visited[s]) {
+                result.push_back(s);
+            }
+        }
+        return result;
+    }
+
+    // check for a cycle among all states, reachable or not
+    [[nodiscard]] bool hasDirectedCycle() const {
+        // 0: unvisited, 1: on the DFS stack, 2: done
+        std::vector<std::uint8_t> color(this->nrStates(), 0);
+        std::vector<std::pair<StateIndex, EdgeIndex>> stack;
+        for (StateIndex r = 0; r < this->nrStates(); r++) {
+            if (color[r] != 0) {
+                continue;
+            }
+            color[r] = 1;
+            stack.emplace_back(r, this->firstOut[r]);
+            while (!stack.empty()) {
+                auto &top = stack.back();
+                if (top.second == NO_EDGE) {
+                    color[top.first] = 2;
+                    stack.pop_back();
+                    continue;
+                }
+                StateIndex d = this->edgeDestination[top.second];
+                top.second = this->nextOut[top.second];
+                if (color[d] == 1) {
+                    return true;
+                }
+                if (color[d] == 0) {
+                    color[d] = 1;
+                    stack.emplace_back(d, this->firstOut[d]);
+                }
+            }
+        }
+        return false;
+    }
+
+    // renumber the edges such that the outgoing edges of every state are
+    // adjacent and ordered as before; edge indices are invalidated.
+    void compact() {
+        std::vector<EdgeIndex> order;
+        order.reserve(this->nrEdges());
+        for (StateIndex s = 0; s < this->nrStates(); s++) {
+            for (EdgeIndex e : this->getOutgoingEdges(s)) {
+                order.push_back(e);
+            }
+        }
+        std::vector<EdgeLabelType> labels;
+        std::vector<StateIndex> sources;
+        std::vector<StateIndex> destinations;
+        labels.reserve(order.size());
+        sources.reserve(order.size());
+        destinations.reserve(order.size());
+        for (EdgeIndex e : order) {
+            labels.push_back(std::move(this->edgeLabels[e]));
+            sources.push_back(this->edgeSource[e]);
+            destinations.push_back(this->edgeDestination[e]);
+        }
+        this->edgeLabels = std::move(labels);
+        this->edgeSource = std::move(sources);
+        this->edgeDestination = std::move(destinations);
+
+        std::fill(this->firstOut.begin(), this->firstOut.end(), NO_EDGE);
+        std::fill(this->lastOut.begin(), this->lastOut.end(), NO_EDGE);
+        for (EdgeIndex e = 0; e < this->nrEdges(); e++) {
+            StateIndex src = this->edgeSource[e];
+            if (this->firstOut[src] == NO_EDGE) {
+                this->firstOut[src] = e;
+            } else {
+                this->nextOut[e - 1] = e;
+            }
+            this->nextOut[e] = NO_EDGE;
+            this->lastOut[src] = e;
+        }
+    }
+
+private:
+    // state attributes, indexed by StateIndex
+    std::vector<StateLabelType> stateLabels;
+    std::vector<EdgeIndex> firstOut;
+    std::vector<EdgeIndex> lastOut;
+
+    // edge attributes, indexed by EdgeIndex
+    std::vector<EdgeLabelType> edgeLabels;
+    std::vector<StateIndex> edgeSource;
+    std::vector<StateIndex> edgeDestination;
+    std::vector<EdgeIndex> nextOut;
+
+    LabelIndex<StateLabelType, StateIndex> labelIndex;
+    std::vector<StateIndex> initialStates;
+    std::vector<StateIndex> finalStates;
+};
+
+} // namespace MaxPlus::FSM::Arena
+
+#endif
@@ -44,22 +44,81 @@
 #include "maxplus/base/basic_types.h"
 #include "maxplus/base/exception/exception.h"
 #include "maxplus/base/string/cstring.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <iterator>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 namespace MaxPlus::FSM {
 
+// test whether std::hash supports type T
+template <typename T, typename = void> struct IsHashable : std::false_type {};
+
+template <typename T>
+struct IsHashable<T, std::void_t<decltype(std::hash<T>()(std::declval<const T &>()))>>
+    : std::true_type {};
+
+// index on labels; a hash map if the label type can be hashed, an ordered map otherwise
+template <typename Label, typename Value>
+using LabelIndex = std::conditional_t<IsHashable<Label>::value,
+                                      std::unordered_map<Label, Value>,
+                                      std::map<Label, Value>>;
+
+// hash of a pair of an id and a label
+template <typename Label> struct IdLabelHash {
+    std::size_t operator()(const std::pair<CId, Label> &k) const {
+        return hashCombine(std::hash<CId>()(k.first), std::hash<Label>()(k.second));
+    }
+};
+
+// index on pairs of an id and a label; hashed if the label type can be hashed
+template <typename Label, typename Value>
+using IdLabelIndex = std::conditional_t<IsHashable<Label>::value,
+                                        std::unordered_map<std::pair<CId, Label>, Value, IdLabelHash<Label>>,
+                                        std::map<std::pair<CId, Label>, Value>>;
+
+// a transition between states numbered 0, 1, ..., with a label numbered 0, 1, ...
+struct IndexedTransition {
+    std::uint32_t source;
+    std::uint32_t label;
+    std::uint32_t destination;
+};
+
+// The coarsest partition of the states 0..numberOfStates-1 that refines the
+// initial blocks (numbered 0, 1, ...) and in which states of the same block can
+// make transitions with the same labels to the same blocks, i.e., bisimilarity.
+// Computed with Paige and Tarjan's partition refinement in O(m log n) time.
+// Returns the block of every state, with blocks numbered in order of their
+// smallest state.
+std::vector<std::uint32_t>
+coarsestStablePartition(std::uint32_t numberOfStates,
+                        const std::vector<std::uint32_t> &initialBlocks,
+                        const std::vector<IndexedTransition> &transitions);
+
 // the abstract ancestor of FSM types
 namespace Abstract {
 
-// Unique ID for deterministic sets
+// Unique ID for deterministic sets. The ids are drawn from one atomic counter, so
+// FSMs can be built on several threads at once; the ids of the states and edges
+// created by one thread increase in the order in which they are created. Ids are
+// unique in the process and never reused; once all CId values have been handed
+// out, creating a state or edge throws an MPException instead of wrapping around.
 class WithUniqueID {
 public:
-    WithUniqueID() : id(nextID++) {}
+    WithUniqueID() : id(allocateId()) {}
 
     [[nodiscard]] bool lessThan(const WithUniqueID &rhs) const { return this->id < rhs.id; }
     [[nodiscard]] bool operator==(const WithUniqueID &rhs) const { return this->id == rhs.id; }
@@ -67,7 +126,16 @@ public:
     [[nodiscard]] CId getId() const { return this->id; }
 
 private:
-    static CId nextID;
+    static CId allocateId() {
+        // the counter is wider than CId, so it cannot wrap before the check
+        std::uint64_t next = nextID.fetch_add(1, std::memory_order_relaxed);
+        if (next > std::numeric_limits<CId>::max()) {
+            throw MaxPlus::MPException("Out of unique ids for FSM states and edges.");
+        }
+        return static_cast<CId>(next);
+    }
+
+    static std::atomic<std::uint64_t> nextID;
     CId id;
 };
 
@@ -164,8 +232,26 @@ public:
 
     void removeOutgoingEdge(EdgeRef e) { this->outgoingEdges.erase(e); }
 
+    // the incoming edges, if the FSM keeps track of them
+    [[nodiscard]] const std::vector<EdgeRef> &getIncomingEdges() const {
+        return this->incomingEdges;
+    }
+
+    void insertIncomingEdge(EdgeRef e) { this->incomingEdges.push_back(e); }
+
+    void removeIncomingEdge(EdgeRef e) {
+        auto i = std::find(this->incomingEdges.begin(), this->incomingEdges.end(), e);
+        if (i != this->incomingEdges.end()) {
+            *i = this->incomingEdges.back();
+            this->incomingEdges.pop_back();
+        }
+    }
+
+    void clearIncomingEdges() { this->incomingEdges.clear(); }
+
 private:
     SetOfEdgeRefs outgoingEdges;
+    std::vector<EdgeRef> incomingEdges;
 };
 
 // A set of states
@@ -242,51 +328,249 @@ public:
     [[nodiscard]] virtual const SetOfStates &getStates() const = 0;
     [[nodiscard]] virtual SetOfStateRefs getStateRefs() const = 0;
     [[nodiscard]] virtual const SetOfEdges &getEdges() const = 0;
-};
 
-//
-// A generic DFS strategy on the target FSM
-// overwrite the methods onEnterState, onLeaveState, onTransition and onSimpleCycle with
-// the desired actions
-//
-class DepthFirstSearch {
+    // true if the states compute their outgoing edges when they are first asked for, which
+    // adds states and edges to the FSM and must not be done from several threads at once
+    [[nodiscard]] virtual bool exploresOnDemand() const { return false; }
+};
 
+// A set of states of an FSM, kept as a bitmap on the state ids, counted from the smallest id
+// of a state of the FSM. The bitmap grows with the states inserted, for FSMs that create
+// states while they are explored; states with ids far outside it are kept in a hash set.
+class StateIdSet {
 public:
-    DepthFirstSearch(const DepthFirstSearch &) = delete;
-    DepthFirstSearch &operator=(const DepthFirstSearch &other) = delete;
-    DepthFirstSearch(DepthFirstSearch &&) = delete;
-    DepthFirstSearch &operator=(DepthFirstSearch &&) = delete;
+    explicit StateIdSet(const FiniteStateMachine &fsm) {
+        const SetOfStates &states = fsm.getStates();
+        if (!states.empty()) {
+            this->base = states.begin()->first;
+            this->capacity = states.size();
+            this->grow(states.rbegin()->first - this->base + 1);
+        }
+    }
 
-    // supporting class for DFS stack items
-    class DFSStackItem {
-    public:
-        // constructor
-        explicit DFSStackItem(StateRef s) : state(s) {
-            this->iter = s->getOutgoingEdges().begin();
-        };
+    [[nodiscard]] bool contains(StateRef s) const {
+        std::size_t i = s->getId() - static_cast<std::size_t>(this->base);
+        if (s->getId() >= this->base && i < this->nrBits) {
+            return ((this->bits[i / 64] >> (i % 64)) & 1U) != 0;
+        }
+        return this->others.find(s) != this->others.end();
+    }
 
-        // access state
-        StateRef getState() const { return this->state; }
+    void insert(StateRef s) {
+        this->capacity++;
+        std::size_t i = s->getId() - static_cast<std::size_t>(this->base);
+        if (s->getId() >= this->base && i >= this->nrBits) {
+            this->grow(i + 1);
+        }
+        if (s->getId() >= this->base && i < this->nrBits) {
+            this->bits[i / 64] |= std::uint64_t{1} << (i % 64);
+        } else {
+            this->others.insert(s);
+        }
+    }
 
-        SetOfEdgeRefs::CIter getIter() { return this->iter; }
+    void erase(StateRef s) {
+        std::size_t i = s->getId() - static_cast<std::size_t>(this->base);
+        if (s->getId() >= this->base && i < this->nrBits) {
+            this->bits[i / 64] &= ~(std::uint64_t{1} << (i % 64));
+        } else {
+            this->others.erase(s);
+        }
+    }
 
-        // test if all outgoing edges have been done
-        bool atEnd() { return this->iter == this->state->getOutgoingEdges().end(); }
+private:
+    // extend the bitmap to at least n bits, as far as it stays within 64 bits per state
+    void grow(std::size_t n) {
+        std::size_t limit = 64 * (this->capacity + 1024);
+        if (n > limit || n <= this->nrBits) {
+            return;
+        }
+        this->nrBits = std::min(std::max(n, 2 * this->nrBits), limit);
+        this->bits.resize((this->nrBits + 63) / 64, 0);
+        // states in the hash set that are now in range move to the bitmap
+        for (auto i = this->others.begin(); i != this->others.end();) {
+            std::size_t k = (*i)->getId() - static_cast<std::size_t>(this->base);
+            if ((*i)->getId() >= this->base && k < this->nrBits) {
+                this->bits[k / 64] |= std::uint64_t{1} << (k % 64);
+                i = this->others.erase(i);
+            } else {
+                i++;
+            }
+        }
+    }
 
-        // move to the next edge
-        void advance() { (this->iter)++; }
+    CId base{0};
+    std::size_t capacity{0};
+    std::size_t nrBits{0};
+    std::vector<std::uint64_t> bits;
+    std::unordered_set<StateRef> others;
+};
 
-    private:
-        StateRef state;
-        SetOfEdgeRefs::CIter iter;
+// supporting class for DFS stack items
+class DFSStackItem {
+public:
+    // constructor
+    explicit DFSStackItem(StateRef s) : state(s) {
+        this->iter = s->getOutgoingEdges().begin();
     };
 
-    using DfsStack = std::list<DFSStackItem>;
+    // access state
+    StateRef getState() const { return this->state; }
+
+    SetOfEdgeRefs::CIter getIter() { return this->iter; }
+
+    // test if all outgoing edges have been done
+    bool atEnd() { return this->iter == this->state->getOutgoingEdges().end(); }
+
+    // move to the next edge
+    void advance() { (this->iter)++; }
 
 private:
+    StateRef state;
+    SetOfEdgeRefs::CIter iter;
+};
+
+using DfsStack = std::vector<DFSStackItem>;
+
+// Actions of depthFirstSearch and breadthFirstSearch, which do nothing. Derive from it and
+// hide the actions of interest; they are resolved at compile time.
+struct SearchVisitor {
+    void onEnterState(StateRef /*s*/) {}
+    void onLeaveState(StateRef /*s*/) {}
+    void onTransition(const Edge & /*e*/) {}
+    void onSimpleCycle(DfsStack & /*stack*/) {}
+    [[nodiscard]] bool aborted() const { return false; }
+};
+
+// Depth first search from the starting states, calling the actions of the visitor.
+// With fullDFS, states are visited again when reached along another path.
+template <typename Visitor>
+void depthFirstSearch(const FiniteStateMachine &fsm,
+                      const SetOfStateRefs &startingStates,
+                      Visitor &visitor,
+                      bool fullDFS = false) {
+    StateIdSet visitedStates(fsm);
+    StateIdSet statesOnStack(fsm);
     DfsStack dfsStack;
 
+    for (StateRef s : startingStates) {
+        if (visitor.aborted()) {
+            return;
+        }
+        // skip states we have already visited
+        if (visitedStates.contains(s)) {
+            continue;
+        }
+        dfsStack.emplace_back(s);
+        statesOnStack.insert(s);
+        visitedStates.insert(s);
+        visitor.onEnterState(s);
+
+        while (!visitor.aborted() && !dfsStack.empty()) {
+            DFSStackItem &si = dfsStack.back();
+            // current item complete?
+            if (si.atEnd()) {
+                // pop it from stack
+                StateRef t = si.getState();
+                visitor.onLeaveState(t);
+                statesOnStack.erase(t);
+                if (fullDFS) {
+                    visitedStates.erase(t);
+                }
+                dfsStack.pop_back();
+            } else {
+                // goto next edge
+                const auto *e = *(si.getIter());
+                si.advance();
+                StateRef dest = e->getDestination();
+                if (statesOnStack.contains(dest)) {
+                    // cycle found
+                    visitor.onSimpleCycle(dfsStack);
+                } else if (!visitedStates.contains(dest)) {
+                    // if target state not visited before
+                    dfsStack.emplace_back(dest);
+                    visitor.onTransition(*e);
+                    visitor.onEnterState(dest);
+                    visitedStates.insert(dest);
+                    statesOnStack.insert(dest);
+                }
+            }
+        }
+    }
+}
+
+// The levels of a breadth first search: the starting states, the states reached from those in
+// one transition that were not reached before, and so on. With more than one thread (0 for the
+// number of hardware threads), the edges from large levels are followed in parallel and the
+// states of such a level are ordered by id. An FSM that explores its states on demand, see
+// exploresOnDemand, is always searched from one thread.
+class BFSFrontier {
 public:
+    BFSFrontier(const FiniteStateMachine &fsm,
+                const SetOfStateRefs &startingStates,
+                unsigned int nrThreads = 1);
+
+    [[nodiscard]] const std::vector<StateRef> &getStates() const { return this->current; }
+
+    [[nodiscard]] bool atEnd() const { return this->current.empty(); }
+
+    // move to the next level
+    void advance();
+
+private:
+    // mark s as reached, return false if it was reached before
+    bool claim(StateRef s);
+
+    // as claim, for use by concurrent threads
+    bool claimConcurrently(StateRef s);
+
+    void followEdges(std::size_t first, std::size_t last, std::vector<StateRef> &found);
+
+    StateIdSet reached;
+    CId base{0};
+    std::size_t nrBits{0};
+    std::unique_ptr<std::atomic<std::uint64_t>[]> bits;
+    std::mutex othersMutex;
+    std::unordered_set<StateRef> others;
+    unsigned int nrThreads;
+    std::vector<StateRef> current;
+};
+
+// Breadth first search from the starting states, calling onEnterState and aborted of the
+// visitor, see SearchVisitor, from the calling thread. See BFSFrontier for nrThreads.
+template <typename Visitor>
+void breadthFirstSearch(const FiniteStateMachine &fsm,
+                        const SetOfStateRefs &startingStates,
+                        Visitor &visitor,
+                        unsigned int nrThreads = 1) {
+    for (BFSFrontier frontier(fsm, startingStates, nrThreads); !frontier.atEnd();
+         frontier.advance()) {
+        for (StateRef s : frontier.getStates()) {
+            if (visitor.aborted()) {
+                return;
+            }
+            visitor.onEnterState(s);
+        }
+    }
+}
+
+//
+// A generic DFS strategy on the target FSM
+// overwrite the methods onEnterState, onLeaveState, onTransition and onSimpleCycle with
+// the desired actions
+// (for a fixed set of actions, depthFirstSearch with a SearchVisitor avoids the virtual calls)
+//
+class DepthFirstSearch {
+
+public:
+    DepthFirstSearch(const DepthFirstSearch &) = delete;
+    DepthFirstSearch &operator=(const DepthFirstSearch &other) = delete;
+    DepthFirstSearch(DepthFirstSearch &&) = delete;
+    DepthFirstSearch &operator=(DepthFirstSearch &&) = delete;
+
+    using DFSStackItem = Abstract::DFSStackItem;
+    using DfsStack = Abstract::DfsStack;
+
     virtual ~DepthFirstSearch() = default;
     using DFSStackCIter = DfsStack::const_iterator;
 
@@ -303,74 +587,19 @@ public:
     explicit DepthFirstSearch(const FiniteStateMachine &targetFsm) : fsm(targetFsm) {};
 
     // Execute the depth first search
-    void DoDepthFirstSearch(const SetOfStateRefs &startingStates, // NOLINT(*cognitive-complexity)
-                            bool fullDFS = false) {
-        // store visited states
-        SetOfStateRefs visitedStates;
-        SetOfStateRefs statesOnStack;
-
+    void DoDepthFirstSearch(const SetOfStateRefs &startingStates, bool fullDFS = false) {
+        // forward the actions to the virtual methods
+        struct Visitor {
+            DepthFirstSearch *dfs;
+            void onEnterState(StateRef s) { this->dfs->onEnterState(s); }
+            void onLeaveState(StateRef s) { this->dfs->onLeaveState(s); }
+            void onTransition(const Edge &e) { this->dfs->onTransition(e); }
+            void onSimpleCycle(DfsStack &stack) { this->dfs->onSimpleCycle(stack); }
+            [[nodiscard]] bool aborted() const { return this->dfs->_abort; }
+        };
+        Visitor visitor{this};
         this->_abort = false;
-
-        // for each of the starting states
-        auto nextStartingState = startingStates.begin();
-        while (nextStartingState != startingStates.end()) {
-
-            // skip states we have already visited
-            while (nextStartingState != startingStates.end()
-                   && visitedStates.includesState(*nextStartingState)) {
-                nextStartingState++;
-            }
-            // if we did not find any state anymore
-            if (nextStartingState == startingStates.end()) {
-                break;
-            }
-
-            statesOnStack.clear();
-            StateRef s = *nextStartingState;
-            dfsStack.emplace_back(s);
-            statesOnStack.insert(s);
-            visitedStates.insert(s);
-            this->onEnterState(s);
-
-            while (!this->_abort && !(dfsStack.empty())) {
-                DFSStackItem &si = dfsStack.back();
-                if (!visitedStates.includesState(si.getState())) {
-                    this->onEnterState(si.getState());
-                    visitedStates.insert(si.getState());
-                }
-                // current item complete?
-                if (si.atEnd()) {
-                    // pop it from stack
-                    this->onLeaveState(si.getState());
-                    const auto *const s = si.getState();
-                    statesOnStack.erase(s);
-                    if (fullDFS) {
-                        assert(visitedStates.includesState(s));
-                        visitedStates.erase(s);
-                    }
-                    dfsStack.pop_back();
-                } else {
-                    // goto next edge
-                    const auto *e = *(si.getIter());
-                    si.advance();
-                    StateRef dest = e->getDestination();
-                    bool revisit = statesOnStack.includesState(dest);
-                    if (revisit) {
-                        // cycle found
-                        this->onSimpleCycle(dfsStack);
-                    } else {
-                        if (!visitedStates.includesState(dest)) {
-                            // if target state not visited before
-                            dfsStack.emplace_back(dest);
-                            this->onTransition(*e);
-                            this->onEnterState(dest);
-                            visitedStates.insert(dest);
-                            statesOnStack.insert(dest);
-                        }
-                    }
-                }
-            }
-        }
+        depthFirstSearch(this->fsm, startingStates, visitor, fullDFS);
     }
 
     void DoDepthFirstSearch(const StateRef &startingState, bool fullDFS = false) {
@@ -505,6 +734,57 @@ namespace Labeled {
 // forward declarations
 template <typename StateLabelType, typename EdgeLabelType> class State;
 
+// A view on a set of abstract states or edges, or on the references to them,
+// of which the elements are presented as Ref, the typed reference. A labeled
+// FSM only holds states and edges of its own label types, so the elements are
+// converted without a run-time type check.
+template <typename Ref, typename Iter> class TypedRange {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Ref;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Ref *;
+        using reference = Ref;
+
+        explicit Iterator(Iter it) : it(it) {}
+
+        Ref operator*() const { return static_cast<Ref>(elementOf(*this->it)); }
+
+        Iterator &operator++() {
+            ++this->it;
+            return *this;
+        }
+
+        bool operator==(const Iterator &rhs) const { return this->it == rhs.it; }
+        bool operator!=(const Iterator &rhs) const { return this->it != rhs.it; }
+
+    private:
+        template <typename T> static const T *elementOf(const T *r) { return r; }
+
+        template <typename T>
+        static const T *elementOf(const std::pair<const CId, std::unique_ptr<T>> &p) {
+            return p.second.get();
+        }
+
+        Iter it;
+    };
+
+    TypedRange(Iter first, Iter last) : first(first), last(last) {}
+
+    template <typename Container>
+    explicit TypedRange(const Container &c) : first(c.begin()), last(c.end()) {}
+
+    [[nodiscard]] Iterator begin() const { return Iterator(this->first); }
+    [[nodiscard]] Iterator end() const { return Iterator(this->last); }
+    [[nodiscard]] bool empty() const { return this->first == this->last; }
+
+private:
+    Iter first;
+    Iter last;
+};
+
 template <typename StateLabelType, typename EdgeLabelType> class Edge : public Abstract::Edge {
 public:
     Edge(State<StateLabelType, EdgeLabelType> &src,
@@ -512,6 +792,17 @@ public:
          State<StateLabelType, EdgeLabelType> &dst) :
         Abstract::Edge(src, dst), label(lbl) {}
 
+    // the source and destination are always labeled states of the same types
+    [[nodiscard]] const State<StateLabelType, EdgeLabelType> *getSource() const override {
+        return static_cast<const State<StateLabelType, EdgeLabelType> *>(
+                Abstract::Edge::getSource());
+    }
+
+    [[nodiscard]] const State<StateLabelType, EdgeLabelType> *getDestination() const override {
+        return static_cast<const State<StateLabelType, EdgeLabelType> *>(
+                Abstract::Edge::getDestination());
+    }
+
     [[nodiscard]] const EdgeLabelType &getLabel() const { return this->label; }
     void setLabel(EdgeLabelType l) { this->label = l; }
 
@@ -536,6 +827,23 @@ public:
 template <typename StateLabelType, typename EdgeLabelType>
 using StateRef = const State<StateLabelType, EdgeLabelType> *;
 
+// typed views on the sets of states and edges, and on sets of references to them
+template <typename StateLabelType, typename EdgeLabelType>
+using StateRange = TypedRange<StateRef<StateLabelType, EdgeLabelType>,
+                              Abstract::SetOfStates::const_iterator>;
+
+template <typename StateLabelType, typename EdgeLabelType>
+using StateRefRange = TypedRange<StateRef<StateLabelType, EdgeLabelType>,
+                                 Abstract::SetOfStateRefs::const_iterator>;
+
+template <typename StateLabelType, typename EdgeLabelType>
+using EdgeRange = TypedRange<EdgeRef<StateLabelType, EdgeLabelType>,
+                             Abstract::SetOfEdges::const_iterator>;
+
+template <typename StateLabelType, typename EdgeLabelType>
+using EdgeRefRange = TypedRange<EdgeRef<StateLabelType, EdgeLabelType>,
+                                Abstract::SetOfEdgeRefs::const_iterator>;
+
 // template <typename StateLabelType, typename EdgeLabelType>
 // class SetOfEdgeRefs : public Abstract::SetOfEdgeRefs {
 // public:
@@ -545,28 +853,78 @@ using StateRef = const State<StateLabelType, EdgeLabelType> *;
 template <typename StateLabelType, typename EdgeLabelType>
 class SetOfStates : public Abstract::SetOfStates {
 private:
-    std::map<StateLabelType, State<StateLabelType, EdgeLabelType> *> labelIndex;
+    // Every label maps to the state most recently added with that label and
+    // to the number of states with the label. If the indexed state is removed
+    // while others with the same label remain, the entry is resolved again on
+    // its next use.
+    struct IndexEntry {
+        State<StateLabelType, EdgeLabelType> *state;
+        std::size_t count;
+    };
+    mutable LabelIndex<StateLabelType, IndexEntry> labelIndex;
 
-    void addToStateIndex(StateLabelType l, State<StateLabelType, EdgeLabelType> *s) {
-        this->labelIndex[l] = s;
+    State<StateLabelType, EdgeLabelType> *lookup(const StateLabelType &l) const {
+        auto it = this->labelIndex.find(l);
+        if (it == this->labelIndex.end()) {
+            return nullptr;
+        }
+        if (it->second.state == nullptr) {
+            for (const auto &i : *this) {
+                auto *s = static_cast<State<StateLabelType, EdgeLabelType> *>(i.second.get());
+                if (s->getLabel() == l) {
+                    it->second.state = s;
+                }
+            }
+        }
+        return it->second.state;
     }
 
 public:
-    State<StateLabelType, EdgeLabelType> &withLabel(StateLabelType l) {
-        if (this->labelIndex.find(l) != this->labelIndex.end()) {
-            return *this->labelIndex[l];
+    State<StateLabelType, EdgeLabelType> &withLabel(const StateLabelType &l) {
+        auto *s = this->lookup(l);
+        if (s != nullptr) {
+            return *s;
         }
         throw MaxPlus::MPException("error - state not found in FiniteStateMachine::_withLabel");
     }
 
-    bool hasStateWithLabel(StateLabelType l) {
+    // the state labeled l, or null if no such state exists
+    [[nodiscard]] StateRef<StateLabelType, EdgeLabelType>
+    findWithLabel(const StateLabelType &l) const {
+        return this->lookup(l);
+    }
+
+    [[nodiscard]] bool hasStateWithLabel(const StateLabelType &l) const {
         return this->labelIndex.find(l) != this->labelIndex.end();
     }
 
+    [[nodiscard]] std::size_t countWithLabel(const StateLabelType &l) const {
+        auto it = this->labelIndex.find(l);
+        return it == this->labelIndex.end() ? 0 : it->second.count;
+    }
+
     void addState(std::unique_ptr<State<StateLabelType, EdgeLabelType>> s) {
-        this->addToStateIndex(s->getLabel(), s.get());
+        auto it = this->labelIndex.find(s->getLabel());
+        if (it == this->labelIndex.end()) {
+            this->labelIndex.emplace(s->getLabel(), IndexEntry{s.get(), 1});
+        } else {
+            it->second.state = s.get();
+            it->second.count++;
+        }
         Abstract::SetOfStates::addState(std::move(s));
     }
+
+    void remove(const State<StateLabelType, EdgeLabelType> &s) {
+        auto it = this->labelIndex.find(s.getLabel());
+        if (it != this->labelIndex.end()) {
+            if (--(it->second.count) == 0) {
+                this->labelIndex.erase(it);
+            } else if (it->second.state == &s) {
+                it->second.state = nullptr;
+            }
+        }
+        Abstract::SetOfStates::remove(s);
+    }
 };
 
 template <typename StateLabelType, typename EdgeLabelType>
@@ -582,14 +940,17 @@ public:
 
     [[nodiscard]] const StateLabelType &getLabel() const { return this->stateLabel; }
 
+    // the outgoing edges as labeled edges
+    [[nodiscard]] EdgeRefRange<StateLabelType, EdgeLabelType> getTypedOutgoingEdges() const {
+        return EdgeRefRange<StateLabelType, EdgeLabelType>(this->getOutgoingEdges());
+    }
+
     // return all next states reachable via an edge labelled l
     [[nodiscard]] std::unique_ptr<Abstract::SetOfStateRefs>
     nextStatesOfEdgeLabel(const EdgeLabelType l) const {
 
         auto result = std::make_unique<Abstract::SetOfStateRefs>();
-        const auto &es = static_cast<const Abstract::SetOfEdgeRefs &>(this->getOutgoingEdges());
-        for (const auto &i : es) {
-            auto *e = static_cast<const Edge<StateLabelType, EdgeLabelType> *>(i);
+        for (const auto *e : this->getTypedOutgoingEdges()) {
             if (e->getLabel() == l) {
                 result->insert(e->getDestination());
             }
@@ -599,10 +960,9 @@ public:
 
     // return an arbitrary next state reachable via an edge labelled l
     // or null if no such state exists
-    State<StateLabelType, EdgeLabelType> *nextStateOfEdgeLabel(const EdgeLabelType l) {
-        const auto &es = static_cast<const Abstract::SetOfEdgeRefs &>(this->getOutgoingEdges());
-        for (const auto &i : es) {
-            Edge<StateLabelType, EdgeLabelType> *e = i;
+    [[nodiscard]] StateRef<StateLabelType, EdgeLabelType>
+    nextStateOfEdgeLabel(const EdgeLabelType l) const {
+        for (const auto *e : this->getTypedOutgoingEdges()) {
             if (e->getLabel() == l) {
                 return e->getDestination();
             }
@@ -620,13 +980,71 @@ private:
     // State<StateLabelType, EdgeLabelType> *initialState;
     SetOfStateRefs<StateLabelType, EdgeLabelType> initialStates;
     SetOfStateRefs<StateLabelType, EdgeLabelType> finalStates;
+    // whether the states keep their incoming edges
+    bool incomingEdgesIndexed{false};
+
+    // the optional index on the transitions, by source and label and by source and
+    // destination, with the edges of every key in order of their ids
+    using EdgeList = std::vector<EdgeRef<StateLabelType, EdgeLabelType>>;
+    bool transitionsIndexed{false};
+    IdLabelIndex<EdgeLabelType, EdgeList> edgesBySourceAndLabel;
+    std::unordered_map<std::uint64_t, EdgeList> edgesBySourceAndDestination;
+
+    static std::uint64_t pairKey(Abstract::StateRef src, Abstract::StateRef dst) {
+        return (static_cast<std::uint64_t>(src->getId()) << 32U) | dst->getId();
+    }
+
+    // insert e into the list of key, at the position of its id
+    template <typename Index, typename Key>
+    static void insertIndexed(Index &index, const Key &key, EdgeRef<StateLabelType, EdgeLabelType> e) {
+        auto &l = index[key];
+        l.insert(std::lower_bound(l.begin(),
+                                  l.end(),
+                                  e,
+                                  [](EdgeRef<StateLabelType, EdgeLabelType> a,
+                                     EdgeRef<StateLabelType, EdgeLabelType> b) {
+                                      return a->getId() < b->getId();
+                                  }),
+                 e);
+    }
+
+    // remove e from the list of key
+    template <typename Index, typename Key>
+    static void eraseIndexed(Index &index, const Key &key, EdgeRef<StateLabelType, EdgeLabelType> e) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            auto &l = it->second;
+            l.erase(std::find(l.begin(), l.end(), e));
+            if (l.empty()) {
+                index.erase(it);
+            }
+        }
+    }
+
+    static std::pair<CId, EdgeLabelType> labelKey(EdgeRef<StateLabelType, EdgeLabelType> e) {
+        return std::make_pair(e->getSource()->getId(), e->getLabel());
+    }
+
+    void indexTransition(EdgeRef<StateLabelType, EdgeLabelType> e) {
+        insertIndexed(this->edgesBySourceAndLabel, labelKey(e), e);
+        insertIndexed(this->edgesBySourceAndDestination,
+                      pairKey(e->getSource(), e->getDestination()),
+                      e);
+    }
+
+    void unindexTransition(EdgeRef<StateLabelType, EdgeLabelType> e) {
+        eraseIndexed(this->edgesBySourceAndLabel, labelKey(e), e);
+        eraseIndexed(this->edgesBySourceAndDestination,
+                     pairKey(e->getSource(), e->getDestination()),
+                     e);
+    }
 
     State<StateLabelType, EdgeLabelType> &_getStateLabeled(const StateLabelType &s) {
         return this->states.withLabel(s);
     };
 
     State<StateLabelType, EdgeLabelType> &_getState(const State<StateLabelType, EdgeLabelType> &s) {
-        return dynamic_cast<State<StateLabelType, EdgeLabelType> &>(this->states.withId(s.getId()));
+        return static_cast<State<StateLabelType, EdgeLabelType> &>(this->states.withId(s.getId()));
     };
 
 public:
@@ -656,43 +1074,197 @@ public:
                                                  EdgeLabelType lbl,
                                                  const State<StateLabelType, EdgeLabelType> &dst) {
         // lookup state again to drop const qualifier
-        auto &mySrc = dynamic_cast<State<StateLabelType, EdgeLabelType> &>(
-                this->states.withId(src.getId()));
-        auto &myDst = dynamic_cast<State<StateLabelType, EdgeLabelType> &>(
-                this->states.withId(dst.getId()));
-        bool added = false;
+        auto &mySrc = this->_getState(src);
+        auto &myDst = this->_getState(dst);
         auto ep = std::make_unique<Edge<StateLabelType, EdgeLabelType>>(mySrc, lbl, myDst);
         auto &e = *ep;
         this->edges[e.getId()] = std::move(ep);
         mySrc.addOutGoingEdge(e);
+        if (this->incomingEdgesIndexed) {
+            myDst.insertIncomingEdge(&e);
+        }
+        if (this->transitionsIndexed) {
+            this->indexTransition(&e);
+        }
         return &e;
     };
 
+    // Let the states keep their incoming edges (getIncomingEdges), such that removing a
+    // state takes time linear in its number of edges, instead of in the size of the FSM.
+    void indexIncomingEdges(bool enable = true) {
+        if (enable == this->incomingEdgesIndexed) {
+            return;
+        }
+        this->incomingEdgesIndexed = enable;
+        for (const auto &i : this->states) {
+            i.second->clearIncomingEdges();
+        }
+        if (enable) {
+            for (const auto &i : this->edges) {
+                this->_getState(*static_cast<EdgeRef<StateLabelType, EdgeLabelType>>(i.second.get())
+                                         ->getDestination())
+                        .insertIncomingEdge(i.second.get());
+            }
+        }
+    }
+
+    [[nodiscard]] bool hasIncomingEdgeIndex() const { return this->incomingEdgesIndexed; }
+
+    // Keep an index on the transitions by source and label and by source and destination,
+    // which findEdge and getEdge use, instead of scanning the states or outgoing edges.
+    void indexTransitions(bool enable = true) {
+        if (enable == this->transitionsIndexed) {
+            return;
+        }
+        this->transitionsIndexed = enable;
+        this->edgesBySourceAndLabel.clear();
+        this->edgesBySourceAndDestination.clear();
+        if (enable) {
+            for (const auto *e : this->getTypedEdges()) {
+                this->indexTransition(e);
+            }
+        }
+    }
+
+    [[nodiscard]] bool hasTransitionIndex() const { return this->transitionsIndexed; }
+
     void removeEdge(const Edge<StateLabelType, EdgeLabelType> &e) {
-        auto csrc = dynamic_cast<StateRef<StateLabelType, EdgeLabelType>>(e.getSource());
         // get a non-const version of the state
-        auto &src = this->_getState(*csrc);
+        auto &src = this->_getState(*e.getSource());
         src.removeOutgoingEdge(&e);
+        if (this->incomingEdgesIndexed) {
+            this->_getState(*e.getDestination()).removeIncomingEdge(&e);
+        }
+        if (this->transitionsIndexed) {
+            this->unindexTransition(&e);
+        }
         this->edges.remove(e);
     }
 
     void removeState(const State<StateLabelType, EdgeLabelType> &s) {
         // remove related edges
-        Abstract::SetOfEdgeRefs edgesToRemove;
-        for (auto &it : this->edges) {
-            auto &e = *(it.second);
-            auto src = dynamic_cast<StateRef<StateLabelType, EdgeLabelType>>(e.getSource());
-            auto dst = dynamic_cast<StateRef<StateLabelType, EdgeLabelType>>(e.getDestination());
-            if ((src == &s) || (dst == &s)) {
-                edgesToRemove.insert(&e);
+        std::vector<EdgeRef<StateLabelType, EdgeLabelType>> edgesToRemove;
+        if (this->incomingEdgesIndexed) {
+            for (const auto *e : s.getTypedOutgoingEdges()) {
+                edgesToRemove.push_back(e);
+            }
+            for (const auto *e : s.getIncomingEdges()) {
+                // self-loops are outgoing edges as well
+                if (e->getSource() != &s) {
+                    edgesToRemove.push_back(
+                            static_cast<EdgeRef<StateLabelType, EdgeLabelType>>(e));
+                }
+            }
+        } else {
+            for (const auto *e : this->getTypedEdges()) {
+                if ((e->getSource() == &s) || (e->getDestination() == &s)) {
+                    edgesToRemove.push_back(e);
+                }
             }
         }
         for (const auto *e : edgesToRemove) {
-            this->removeEdge(dynamic_cast<const Edge<StateLabelType, EdgeLabelType> &>(*e));
+            this->removeEdge(*e);
         }
+        this->initialStates.erase(&s);
+        this->finalStates.erase(&s);
         this->states.remove(s);
     }
 
+    // Remove, in time linear in the size of the FSM, the states that cannot be reached from
+    // an initial state (if unreachable) and the dangling states, from which every path ends
+    // in a state without outgoing edges (if dangling), together with their edges.
+    void trim(bool unreachable = true, bool dangling = true) {
+        // number the states
+        std::vector<State<StateLabelType, EdgeLabelType> *> stateOf;
+        std::unordered_map<Abstract::StateRef, std::uint32_t> indexOf;
+        for (const auto &i : this->states) {
+            indexOf[i.second.get()] = static_cast<std::uint32_t>(stateOf.size());
+            stateOf.push_back(static_cast<State<StateLabelType, EdgeLabelType> *>(i.second.get()));
+        }
+        const auto n = static_cast<std::uint32_t>(stateOf.size());
+        std::vector<bool> keep(n, true);
+
+        if (unreachable) {
+            std::vector<bool> reached(n, false);
+            std::vector<std::uint32_t> stack;
+            for (const auto *s : this->initialStates) {
+                std::uint32_t i = indexOf[s];
+                if (!reached[i]) {
+                    reached[i] = true;
+                    stack.push_back(i);
+                }
+            }
+            while (!stack.empty()) {
+                std::uint32_t i = stack.back();
+                stack.pop_back();
+                for (const auto *e : stateOf[i]->getTypedOutgoingEdges()) {
+                    std::uint32_t j = indexOf[e->getDestination()];
+                    if (!reached[j]) {
+                        reached[j] = true;
+                        stack.push_back(j);
+                    }
+                }
+            }
+            keep = std::move(reached);
+        }
+
+        if (dangling) {
+            // the edges into every state, and the number of edges out of it that do not lead
+            // to a dangling state; states of which that number drops to zero are dangling
+            std::vector<std::uint32_t> firstIn(n + 1, 0);
+            std::vector<std::uint32_t> live(n, 0);
+            for (const auto &i : this->edges) {
+                const auto *e = static_cast<EdgeRef<StateLabelType, EdgeLabelType>>(i.second.get());
+                firstIn[indexOf[e->getDestination()] + 1]++;
+                live[indexOf[e->getSource()]]++;
+            }
+            for (std::uint32_t i = 0; i < n; i++) {
+                firstIn[i + 1] += firstIn[i];
+            }
+            std::vector<std::uint32_t> sourceOf(firstIn[n]);
+            std::vector<std::uint32_t> next(firstIn.begin(), firstIn.end() - 1);
+            for (const auto &i : this->edges) {
+                const auto *e = static_cast<EdgeRef<StateLabelType, EdgeLabelType>>(i.second.get());
+                sourceOf[next[indexOf[e->getDestination()]]++] = indexOf[e->getSource()];
+            }
+            std::vector<std::uint32_t> stack;
+            for (std::uint32_t i = 0; i < n; i++) {
+                if (live[i] == 0) {
+                    stack.push_back(i);
+                }
+            }
+            while (!stack.empty()) {
+                std::uint32_t i = stack.back();
+                stack.pop_back();
+                keep[i] = false;
+                for (std::uint32_t k = firstIn[i]; k < firstIn[i + 1]; k++) {
+                    if (--live[sourceOf[k]] == 0) {
+                        stack.push_back(sourceOf[k]);
+                    }
+                }
+            }
+        }
+
+        // remove the edges from and to removed states, then the states
+        std::vector<EdgeRef<StateLabelType, EdgeLabelType>> edgesToRemove;
+        for (const auto &i : this->edges) {
+            const auto *e = static_cast<EdgeRef<StateLabelType, EdgeLabelType>>(i.second.get());
+            if (!keep[indexOf[e->getSource()]] || !keep[indexOf[e->getDestination()]]) {
+                edgesToRemove.push_back(e);
+            }
+        }
+        for (const auto *e : edgesToRemove) {
+            this->removeEdge(*e);
+        }
+        for (std::uint32_t i = 0; i < n; i++) {
+            if (!keep[i]) {
+                this->initialStates.erase(stateOf[i]);
+                this->finalStates.erase(stateOf[i]);
+                this->states.remove(*stateOf[i]);
+            }
+        }
+    }
+
     // set initial state to state with label;
     void setInitialState(StateLabelType label) {
         this->setInitialState(this->states.withLabel(label));
@@ -719,7 +1291,7 @@ public:
             throw MaxPlus::MPException("FSM has no initial state.");
         }
         auto s = this->initialStates.begin();
-        return dynamic_cast<StateRef<StateLabelType, EdgeLabelType>>(*s);
+        return static_cast<StateRef<StateLabelType, EdgeLabelType>>(*s);
     };
 
     [[nodiscard]] const ::MaxPlus::FSM::Abstract::SetOfStateRefs &
@@ -735,22 +1307,8 @@ public:
         return &(this->_getStateLabeled(s));
     };
 
-    bool hasStateLabeled(const StateLabelType &s) {
-        // try the index first
-        State<StateLabelType, EdgeLabelType> *sp = this->states.withLabel(s);
-        if (sp != nullptr) {
-            return true;
-        }
-        // a linear search
-        for (auto &it : this->states) {
-            auto &i = *(it.second);
-            auto &t = dynamic_cast<const State<StateLabelType, EdgeLabelType> &>(i);
-            if ((t.stateLabel) == s) {
-                this->states.addToStateIndex(s, &t);
-                return true;
-            }
-        }
-        return false;
+    [[nodiscard]] bool hasStateLabeled(const StateLabelType &s) const {
+        return this->states.hasStateWithLabel(s);
     };
 
     [[nodiscard]] const SetOfStates<StateLabelType, EdgeLabelType> &getStates() const override {
@@ -769,6 +1327,23 @@ public:
         return this->edges;
     };
 
+    // typed views on the states and edges, for traversals without casts
+    [[nodiscard]] StateRange<StateLabelType, EdgeLabelType> getTypedStates() const {
+        return StateRange<StateLabelType, EdgeLabelType>(this->states);
+    };
+
+    [[nodiscard]] EdgeRange<StateLabelType, EdgeLabelType> getTypedEdges() const {
+        return EdgeRange<StateLabelType, EdgeLabelType>(this->edges);
+    };
+
+    [[nodiscard]] StateRefRange<StateLabelType, EdgeLabelType> getTypedInitialStates() const {
+        return StateRefRange<StateLabelType, EdgeLabelType>(this->initialStates);
+    };
+
+    [[nodiscard]] StateRefRange<StateLabelType, EdgeLabelType> getTypedFinalStates() const {
+        return StateRefRange<StateLabelType, EdgeLabelType>(this->finalStates);
+    };
+
     Abstract::SetOfStateRefs getStateRefs() {
         Abstract::SetOfStateRefs result;
         for (const auto& i : this->states) {
@@ -779,8 +1354,8 @@ public:
 
     std::unique_ptr<Abstract::SetOfEdgeRefs> getEdgeRefs() {
         auto result = std::make_unique<Abstract::SetOfEdgeRefs>();
-        for (auto i : this->edges) {
-            result->insert(&(*(i.second)));
+        for (const auto *e : this->getTypedEdges()) {
+            result->insert(e);
         }
         return result;
     };
@@ -788,11 +1363,11 @@ public:
     EdgeRef<StateLabelType, EdgeLabelType>
     getEdge(const State<StateLabelType, EdgeLabelType> &source,
             const State<StateLabelType, EdgeLabelType> &target) {
-        const auto &e = static_cast<const Abstract::SetOfEdgeRefs &>(source.getOutgoingEdges());
-
-        // collect all labels in edges of s
-        for (const auto &i : e) {
-            auto edge = dynamic_cast<const Edge<StateLabelType, EdgeLabelType> *>(i);
+        if (this->transitionsIndexed) {
+            auto it = this->edgesBySourceAndDestination.find(pairKey(&source, &target));
+            return it == this->edgesBySourceAndDestination.end() ? nullptr : it->second.front();
+        }
+        for (const auto *edge : source.getTypedOutgoingEdges()) {
             if (&target == edge->getDestination()) {
                 return edge;
             }
@@ -802,23 +1377,36 @@ public:
 
     void setEdgeLabel(const EdgeRef<StateLabelType, EdgeLabelType> &e, const EdgeLabelType &l) {
         const auto& p = (*this->edges.find(e->getId())).second;
-        auto ee = dynamic_cast<Edge<StateLabelType, EdgeLabelType>*>(p.get());
-        ee->setLabel(l);
+        auto ee = static_cast<Edge<StateLabelType, EdgeLabelType> *>(p.get());
+        if (this->transitionsIndexed) {
+            // only the key by source and label changes
+            eraseIndexed(this->edgesBySourceAndLabel, labelKey(ee), ee);
+            ee->setLabel(l);
+            insertIndexed(this->edgesBySourceAndLabel, labelKey(ee), ee);
+        } else {
+            ee->setLabel(l);
+        }
     }
 
-    StateRef<StateLabelType, EdgeLabelType> checkStateLabeled(const StateLabelType &l) {
-        if (this->states.hasStateWithLabel(l)) {
-            return &(this->states.withLabel(l));
-        }
-        return nullptr;
+    [[nodiscard]] StateRef<StateLabelType, EdgeLabelType>
+    checkStateLabeled(const StateLabelType &l) const {
+        return this->states.findWithLabel(l);
     };
 
     std::unique_ptr<Abstract::SetOfStateRefs> reachableStates() {
-        // use generic DFS function to add states found
-        Abstract::ReachableStates rs(*this);
-        rs.DoDepthFirstSearch();
+        // collect the states found by a DFS and insert them in order of their ids
+        struct Visitor : Abstract::SearchVisitor {
+            std::vector<Abstract::StateRef> found;
+            void onEnterState(Abstract::StateRef s) { this->found.push_back(s); }
+        };
+        Visitor visitor;
+        Abstract::depthFirstSearch(*this, this->getInitialStates(), visitor);
+        std::sort(visitor.found.begin(), visitor.found.end(), Abstract::StateRefCompareLessThan());
         std::unique_ptr<Abstract::SetOfStateRefs> result =
-                std::make_unique<Abstract::SetOfStateRefs>(rs.result);
+                std::make_unique<Abstract::SetOfStateRefs>();
+        for (const auto *s : visitor.found) {
+            result->insert(result->end(), s);
+        }
         return result;
     };
 
@@ -826,22 +1414,27 @@ public:
     const Edge<StateLabelType, EdgeLabelType> *
     findEdge(StateLabelType src, EdgeLabelType lbl, StateLabelType dst) {
 
-        // get all labels
-        const SetOfStates<StateLabelType, EdgeLabelType> &allStates = this->getStates();
-
-        for (const auto& iter : allStates) {
-            auto s = dynamic_cast<State<StateLabelType, EdgeLabelType> &>(*(iter.second));
-            if (s.stateLabel == src) {
-                const StateRef<StateLabelType, EdgeLabelType> srcState = this->getStateLabeled(src);
-
-                const auto &outgoingEdges =
-                        static_cast<const Abstract::SetOfEdgeRefs &>(srcState->getOutgoingEdges());
+        // the index applies if the source label is unique
+        if (this->transitionsIndexed && this->states.countWithLabel(src) <= 1) {
+            const auto *s = this->states.findWithLabel(src);
+            if (s == nullptr) {
+                return nullptr;
+            }
+            auto it = this->edgesBySourceAndLabel.find(std::make_pair(s->getId(), lbl));
+            if (it != this->edgesBySourceAndLabel.end()) {
+                for (const auto *e : it->second) {
+                    if (e->getDestination()->getLabel() == dst) {
+                        return e;
+                    }
+                }
+            }
+            return nullptr;
+        }
 
-                for (const auto &it : outgoingEdges) {
-                    auto e = dynamic_cast<const Edge<StateLabelType, EdgeLabelType> *>(it);
-                    auto dstState = dynamic_cast<StateRef<StateLabelType, EdgeLabelType>>(
-                            e->getDestination());
-                    if (e->getLabel() == lbl && dstState->getLabel() == dst) {
+        for (const auto *s : this->getTypedStates()) {
+            if (s->getLabel() == src) {
+                for (const auto *e : s->getTypedOutgoingEdges()) {
+                    if (e->getLabel() == lbl && e->getDestination()->getLabel() == dst) {
                         return e;
                     }
                 }
@@ -852,245 +1445,176 @@ public:
 
     // determinize the automaton based on edge labels only.
     // warning: original state labels are ignored
-    // Using the subset construction
+    // Using the subset construction: the states are numbered densely in the
+    // order of their ids, subsets are sorted vectors of those numbers and
+    // every subset that is found is interned in a hash map. A new state gets
+    // the label of the state with the smallest id in its subset.
     std::unique_ptr<FiniteStateMachine<StateLabelType, EdgeLabelType>> determinizeEdgeLabels() {
         std::unique_ptr<FiniteStateMachine<StateLabelType, EdgeLabelType>> result =
                 std::unique_ptr<FiniteStateMachine<StateLabelType, EdgeLabelType>>(
                         dynamic_cast<FiniteStateMachine<StateLabelType, EdgeLabelType> *>(this->newInstance().release()));
 
-        // maintain map of sets of states to the corresponding new states.
-        std::map<const Abstract::SetOfStateRefs, const State<StateLabelType, EdgeLabelType> *>
-                newStatesMap;
-
-        // queue of states that need to be further explored.
-        std::list<std::unique_ptr<Abstract::SetOfStateRefs>> unprocessed;
-
-        // create initial state
-        std::unique_ptr<Abstract::SetOfStateRefs> initialStateSet;
-        initialStateSet = std::make_unique<Abstract::SetOfStateRefs>();
-        initialStateSet->insert(this->getInitialState());
-
-        StateLabelType si = this->getInitialState()->getLabel();
-        const State<StateLabelType, EdgeLabelType> *initialState = result->addState(si);
-        newStatesMap[*initialStateSet] = initialState;
-        result->setInitialState(si);
-
-        // add initial state to list of unprocessed state sets
-        unprocessed.push_back(std::move(initialStateSet));
-
-        while (!unprocessed.empty()) {
-
-            auto it = unprocessed.begin();
-            std::unique_ptr<Abstract::SetOfStateRefs> Q = std::move(*it);
-            unprocessed.erase(it);
-
-            // get all outgoing labels
-            std::set<EdgeLabelType> labels;
-            for (const auto *i : *Q) {
-                auto s = dynamic_cast<const State<StateLabelType, EdgeLabelType> &>(*i);
-                this->insertOutgoingLabels(&s, labels);
+        using Index = std::uint32_t;
+        using Subset = std::vector<Index>;
+
+        // number the states and the edge labels, the latter in the order of the labels
+        std::vector<StateRef<StateLabelType, EdgeLabelType>> stateOf;
+        std::unordered_map<Abstract::StateRef, Index> indexOf;
+        std::vector<EdgeLabelType> labelOf;
+        for (const auto *s : this->getTypedStates()) {
+            indexOf[s] = static_cast<Index>(stateOf.size());
+            stateOf.push_back(s);
+            for (const auto *e : s->getTypedOutgoingEdges()) {
+                labelOf.push_back(e->getLabel());
             }
+        }
+        std::sort(labelOf.begin(), labelOf.end());
+        labelOf.erase(std::unique(labelOf.begin(), labelOf.end()), labelOf.end());
+        LabelIndex<EdgeLabelType, Index> labelIndex;
+        for (Index l = 0; l < labelOf.size(); l++) {
+            labelIndex.emplace(labelOf[l], l);
+        }
 
-            // for each label in labels get the image states into a set QNext
-            for (auto l : labels) {
-
-                // collect image state in QNext
-                std::unique_ptr<Abstract::SetOfStateRefs> QNext =
-                        std::make_unique<Abstract::SetOfStateRefs>();
-
-                // for every state s in Q
-                for (const auto *i : *Q) {
-                    const auto &s = dynamic_cast<const State<StateLabelType, EdgeLabelType> &>(*i);
-                    std::unique_ptr<Abstract::SetOfStateRefs> l_img = s.nextStatesOfEdgeLabel(l);
-
-                    // add all l-images from s to QNext
-                    for (const auto &k : *l_img) {
-                        const auto *simg = k;
-                        QNext->insert(simg);
-                    }
+        // for every state, its (label, successor) pairs, sorted and without duplicates
+        std::vector<std::size_t> firstMove(stateOf.size() + 1, 0);
+        std::vector<std::pair<Index, Index>> moves;
+        for (Index i = 0; i < stateOf.size(); i++) {
+            firstMove[i] = moves.size();
+            for (const auto *e : stateOf[i]->getTypedOutgoingEdges()) {
+                moves.emplace_back(labelIndex.find(e->getLabel())->second,
+                                   indexOf[e->getDestination()]);
+            }
+            std::sort(moves.begin() + static_cast<std::ptrdiff_t>(firstMove[i]), moves.end());
+            moves.erase(std::unique(moves.begin() + static_cast<std::ptrdiff_t>(firstMove[i]),
+                                    moves.end()),
+                        moves.end());
+        }
+        firstMove[stateOf.size()] = moves.size();
+
+        // the subsets found so far, the corresponding new states, and the index on the subsets
+        struct SubsetHash {
+            std::size_t operator()(const Subset &q) const noexcept {
+                std::size_t h = q.size();
+                for (Index i : q) {
+                    h = hashCombine(h, i);
                 }
+                return h;
+            }
+        };
+        std::vector<Subset> subsets;
+        std::vector<StateRef<StateLabelType, EdgeLabelType>> newStates;
+        std::unordered_map<Subset, Index, SubsetHash> subsetIndex;
+
+        auto intern = [&](Subset &&q) {
+            auto it = subsetIndex.find(q);
+            if (it != subsetIndex.end()) {
+                return it->second;
+            }
+            auto n = static_cast<Index>(subsets.size());
+            newStates.push_back(result->addState(stateOf[q.front()]->getLabel()));
+            subsetIndex.emplace(q, n);
+            subsets.push_back(std::move(q));
+            return n;
+        };
 
-                // add new state in fsm if necessary
-                const State<StateLabelType, EdgeLabelType> *ns = nullptr;
-                if (newStatesMap.find(*QNext) == newStatesMap.end()) {
-                    // state does not yet exist, make new state
-                    ns = result->addState(
-                            (dynamic_cast<const State<StateLabelType, EdgeLabelType> &>(
-                                     *(*(QNext->begin()))))
-                                    .getLabel());
-
-                    newStatesMap[*QNext] = ns;
-                    unprocessed.push_back(std::move(QNext));
-                } else {
-                    // state already exists, fetch from newStatesMap
-                    ns = newStatesMap[*QNext];
+        // create initial state
+        Index initial = intern(Subset{indexOf[this->getInitialState()]});
+        result->setInitialState(*newStates[initial]);
+
+        // the subsets are processed in the order in which they are found
+        std::vector<std::pair<Index, Index>> next;
+        for (Index n = 0; n < subsets.size(); n++) {
+            // collect the moves of all states in the subset, grouped by label
+            next.clear();
+            for (Index i : subsets[n]) {
+                next.insert(next.end(),
+                            moves.begin() + static_cast<std::ptrdiff_t>(firstMove[i]),
+                            moves.begin() + static_cast<std::ptrdiff_t>(firstMove[i + 1]));
+            }
+            std::sort(next.begin(), next.end());
+            next.erase(std::unique(next.begin(), next.end()), next.end());
+
+            // for each label, the image states form the next subset
+            auto k = next.begin();
+            while (k != next.end()) {
+                Index l = k->first;
+                Subset qNext;
+                for (; k != next.end() && k->first == l; k++) {
+                    qNext.push_back(k->second);
                 }
-
-                // add an edge in the new fsm
-                result->addEdge(*(newStatesMap[*Q]), l, *ns);
+                Index m = intern(std::move(qNext));
+                result->addEdge(*newStates[n], labelOf[l], *newStates[m]);
             }
         }
 
-        // set initial state
         return result;
     };
 
-    using EquivalenceMap = std::map<const Abstract::State *, Abstract::SetOfStateRefs *>;
-
     // minimize the automaton based on edge and state labels.
+    // States are merged if they are bisimilar, i.e., if they have the same label (unless
+    // ignoreStateLabels) and can make transitions with the same labels to merged states.
+    // A merged state takes the label and the outgoing edges of its state with the smallest id.
     std::unique_ptr<FiniteStateMachine<StateLabelType, EdgeLabelType>>
-    minimizeEdgeLabels(bool ignoreStateLabels = false) { // NOLINT(*cognitive-complexity)
-        // partition refinement algorithm
-
-        // generate a vector of equivalence classes
-        std::list<std::unique_ptr<Abstract::SetOfStateRefs>> eqClasses;
-
-        // populate it with a set of all states
-        std::unique_ptr<Abstract::SetOfStateRefs> initialClass =
-                std::make_unique<Abstract::SetOfStateRefs>(this->getStateRefs());
-        auto *initialClassR = initialClass.get();
-        eqClasses.push_back(std::move(initialClass));
-
-        // initially map all state to the initial class
-        EquivalenceMap eqMap;
-        for (const auto *si : *initialClassR) {
-            auto sp = dynamic_cast<const State<StateLabelType, EdgeLabelType> *>(si);
-            eqMap[sp] = initialClassR;
-        }
-
-        // partition on state labels
-
-        bool changed = false;
-        if (!ignoreStateLabels) {
-            do { // NOLINT(*avoid-do-while)
-                changed = false;
-
-                std::list<std::unique_ptr<Abstract::SetOfStateRefs>> newEqClasses;
-
-                // for every potential equivalence class
-                for (const auto &ic : eqClasses) {
-                    Abstract::SetOfStateRefs *_class = ic.get();
-
-                    auto i = _class->begin();
-
-                    // pick arbitrary state from class
-                    auto s1 = dynamic_cast<const State<StateLabelType, EdgeLabelType> *>(*i);
-
-                    std::unique_ptr<Abstract::SetOfStateRefs> equivSet =
-                            std::make_unique<Abstract::SetOfStateRefs>();
-                    std::unique_ptr<Abstract::SetOfStateRefs> remainingSet =
-                            std::make_unique<Abstract::SetOfStateRefs>();
-                    equivSet->insert(s1);
+    minimizeEdgeLabels(bool ignoreStateLabels = false) {
+        auto x = this->newInstance().release();
+        auto y = static_cast<FiniteStateMachine<StateLabelType, EdgeLabelType>*>(x);
+        std::unique_ptr<FiniteStateMachine<StateLabelType, EdgeLabelType>> result =
+                std::unique_ptr<FiniteStateMachine<StateLabelType, EdgeLabelType>>(y);
 
-                    // check whether all other states have the same label.
-                    while (++i != _class->end()) {
-                        auto s2 = dynamic_cast<const State<StateLabelType, EdgeLabelType> *>(*i);
-                        if (s1->getLabel() == s2->getLabel()) {
-                            equivSet->insert(s2);
-                        } else {
-                            remainingSet->insert(s2);
-                        }
-                    }
-                    // if not, split the class
-                    auto *equivSetR = equivSet.get();
-                    auto *remainingSetR = remainingSet.get();
-                    if (equivSet->size() == _class->size()) {
-                        newEqClasses.push_back(std::move(equivSet));
-                        this->mapStates(eqMap, equivSetR);
-                    } else {
-                        newEqClasses.push_back(std::move(equivSet));
-                        this->mapStates(eqMap, equivSetR);
-                        newEqClasses.push_back(std::move(remainingSet));
-                        this->mapStates(eqMap, remainingSetR);
-                        changed = true;
-                    }
-                }
-                eqClasses = std::move(newEqClasses);
-            } while (changed);
+        // number the states, initially partitioned on their labels
+        std::vector<StateRef<StateLabelType, EdgeLabelType>> stateOf;
+        std::unordered_map<Abstract::StateRef, std::uint32_t> indexOf;
+        std::vector<std::uint32_t> initialBlocks;
+        LabelIndex<StateLabelType, std::uint32_t> blockOfLabel;
+        for (const auto *s : this->getTypedStates()) {
+            indexOf[s] = static_cast<std::uint32_t>(stateOf.size());
+            stateOf.push_back(s);
+            if (ignoreStateLabels) {
+                initialBlocks.push_back(0);
+            } else {
+                auto b = static_cast<std::uint32_t>(blockOfLabel.size());
+                initialBlocks.push_back(blockOfLabel.emplace(s->getLabel(), b).first->second);
+            }
+        }
+        if (stateOf.empty()) {
+            return result;
         }
 
-        // partition refinement on transitions
-        changed = false;
-        do { // NOLINT(*avoid-do-while)
-            changed = false;
-
-            std::list<std::unique_ptr<Abstract::SetOfStateRefs>> newEqClasses;
-
-            // for every potential equivalence class
-            for (const auto &ic : eqClasses) {
-                Abstract::SetOfStateRefs *_class = ic.get();
-
-                auto i = _class->begin();
-
-                // pick arbitrary state from class
-                auto s1 = dynamic_cast<const State<StateLabelType, EdgeLabelType> *>(*i);
-
-                std::unique_ptr<Abstract::SetOfStateRefs> equivSet =
-                        std::make_unique<Abstract::SetOfStateRefs>();
-                std::unique_ptr<Abstract::SetOfStateRefs> remainingSet =
-                        std::make_unique<Abstract::SetOfStateRefs>();
-                equivSet->insert(s1);
-
-                // check whether all other states can go with the same label to
-                // the same set of other equivalence classes.
-                while (++i != _class->end()) {
-                    auto s2 = dynamic_cast<const State<StateLabelType, EdgeLabelType> *>(*i);
-                    if (this->edgesEquivalent(eqMap, s1, s2)) {
-                        equivSet->insert(s2);
-                    } else {
-                        remainingSet->insert(s2);
-                    }
-                }
-                // if not, split the class
-                auto *equivSetR = equivSet.get();
-                auto *remainingSetR = remainingSet.get();
-                if (equivSet->size() == _class->size()) {
-                    newEqClasses.push_back(std::move(equivSet));
-                    this->mapStates(eqMap, equivSetR);
-                } else {
-                    newEqClasses.push_back(std::move(equivSet));
-                    this->mapStates(eqMap, equivSetR);
-                    newEqClasses.push_back(std::move(remainingSet));
-                    this->mapStates(eqMap, remainingSetR);
-                    changed = true;
-                }
+        // number the edge labels
+        std::vector<IndexedTransition> transitions;
+        LabelIndex<EdgeLabelType, std::uint32_t> labelIndex;
+        for (std::uint32_t i = 0; i < stateOf.size(); i++) {
+            for (const auto *e : stateOf[i]->getTypedOutgoingEdges()) {
+                auto l = static_cast<std::uint32_t>(labelIndex.size());
+                l = labelIndex.emplace(e->getLabel(), l).first->second;
+                transitions.push_back({i, l, indexOf[e->getDestination()]});
             }
-            eqClasses = std::move(newEqClasses);
-        } while (changed);
+        }
 
-        auto x = this->newInstance().release(); 
-        auto y = static_cast<FiniteStateMachine<StateLabelType, EdgeLabelType>*>(x);
-        std::unique_ptr<FiniteStateMachine<StateLabelType, EdgeLabelType>> result =
-                std::unique_ptr<FiniteStateMachine<StateLabelType, EdgeLabelType>>(y);
+        const std::vector<std::uint32_t> blockOf = coarsestStablePartition(
+                static_cast<std::uint32_t>(stateOf.size()), initialBlocks, transitions);
 
-        // make a state for every equivalence class
-        std::map<Abstract::SetOfStateRefs *, StateRef<StateLabelType, EdgeLabelType>> newStateMap;
-        CId sid = 0;
-        for (const auto &cli : eqClasses) {
-            // take state label from arbitrary state from the class
-            const State<StateLabelType, EdgeLabelType> *s =
-                    dynamic_cast<const State<StateLabelType, EdgeLabelType> *>(*(cli->begin()));
-            auto ns = result->addState(s->stateLabel);
-            newStateMap[cli.get()] = ns;
-            sid++;
+        // make a state for every block, represented by its first state
+        std::vector<StateRef<StateLabelType, EdgeLabelType>> newStates;
+        std::vector<std::uint32_t> representative;
+        for (std::uint32_t i = 0; i < stateOf.size(); i++) {
+            if (blockOf[i] == newStates.size()) {
+                newStates.push_back(result->addState(stateOf[i]->getLabel()));
+                representative.push_back(i);
+            }
         }
 
         // make the appropriate edges
-        for (const auto &cli : eqClasses) {
-            // take a representative state
-            const auto *s = *(cli->begin());
-            const auto &es = s->getOutgoingEdges();
-            // for every outgoing edge
-            for (const auto *edi : es) {
-                auto ed = dynamic_cast<EdgeRef<StateLabelType, EdgeLabelType>>(edi);
-                result->addEdge(*(newStateMap[cli.get()]),
-                                ed->getLabel(),
-                                *(newStateMap[eqMap[ed->getDestination()]]));
+        for (std::uint32_t b = 0; b < newStates.size(); b++) {
+            for (const auto *e : stateOf[representative[b]]->getTypedOutgoingEdges()) {
+                result->addEdge(*newStates[b],
+                                e->getLabel(),
+                                *newStates[blockOf[indexOf[e->getDestination()]]]);
             }
         }
 
         // set initial state
-        result->setInitialState(*(newStateMap[eqMap[this->getInitialState()]]));
+        result->setInitialState(*newStates[blockOf[indexOf[this->getInitialState()]]]);
 
         return result;
     }
@@ -1099,61 +1623,6 @@ public:
         ::MaxPlus::FSM::Abstract::DetectCycle DC(*this);
         return DC.checkForCycles(nullptr);
     }
-
-private:
-    void insertOutgoingLabels(const State<StateLabelType, EdgeLabelType> *s,
-                              std::set<EdgeLabelType> &labels) {
-        const Abstract::SetOfEdgeRefs &e = s->getOutgoingEdges();
-
-        // collect all labels in edges of s
-        for (const auto *i : e) {
-            auto *ed = dynamic_cast<EdgeRef<StateLabelType, EdgeLabelType>>(i);
-            labels.insert(ed->getLabel());
-        }
-    };
-
-    // function only used by minimizeEdgeLabels
-    bool edgesEquivalent(EquivalenceMap &m,
-                         const State<StateLabelType, EdgeLabelType> *s1,
-                         const State<StateLabelType, EdgeLabelType> *s2) {
-        // s1 and s2 are equivalent if for every s1-a->C, s2-a->C
-        // and vice versa
-        std::set<EdgeLabelType> labels;
-        this->insertOutgoingLabels(s1, labels);
-        this->insertOutgoingLabels(s2, labels);
-
-        // for every label, compare outgoing edges
-        typename std::set<EdgeLabelType>::const_iterator k;
-        for (k = labels.begin(); k != labels.end(); k++) {
-            EdgeLabelType l = *k;
-            std::unique_ptr<Abstract::SetOfStateRefs> ns1 = s1->nextStatesOfEdgeLabel(l);
-            std::unique_ptr<Abstract::SetOfStateRefs> ns2 = s2->nextStatesOfEdgeLabel(l);
-            // collect classes of states in ns1 and ns2
-            std::set<Abstract::SetOfStateRefs *> cs1;
-            std::set<Abstract::SetOfStateRefs *> cs2;
-            for (const auto *j : *ns1) {
-                const auto *s = j;
-                cs1.insert(m[s]);
-            }
-            for (const auto *j : *ns2) {
-                const auto *s = j;
-                cs2.insert(m[s]);
-            }
-
-            // compare classes
-            if (cs1 != cs2) {
-                return false;
-            }
-        }
-        return true;
-    }
-
-    // function only used by minimizeEdgeLabels
-    void mapStates(EquivalenceMap &m, Abstract::SetOfStateRefs *sos) {
-        for (const auto *i : *sos) {
-            m[i] = sos;
-        }
-    }
 };
 } // namespace Labeled
 
@@ -1198,37 +1667,99 @@ namespace Product {
 
 class FiniteStateMachine;
 
+// A state of a product, a pair of states of the component FSMs. Its outgoing edges
+// are computed when they are first asked for.
 class State : public Abstract::State {
 public:
-    State(Abstract::State &s1, Abstract::State &s2, const FiniteStateMachine &ownerFsm) :
+    State(const Abstract::State &s1, const Abstract::State &s2, FiniteStateMachine &ownerFsm) :
         sa(&s1), sb(&s2), fsm(&ownerFsm) {}
 
-    virtual const Abstract::SetOfEdges &getOutgoingEdges();
+    [[nodiscard]] const Abstract::SetOfEdgeRefs &getOutgoingEdges() const override;
+
+    [[nodiscard]] const Abstract::State &getStateA() const { return *this->sa; }
+    [[nodiscard]] const Abstract::State &getStateB() const { return *this->sb; }
 
 private:
-    Abstract::State *sa;
-    Abstract::State *sb;
-    const FiniteStateMachine *fsm;
-    bool outgoingEdgesDone{};
+    const Abstract::State *sa;
+    const Abstract::State *sb;
+    FiniteStateMachine *fsm;
+    mutable bool outgoingEdgesDone{};
 };
 
+// An edge of a product, a pair of matching edges of the component FSMs.
+class Edge : public Abstract::Edge {
+public:
+    Edge(State &src, State &dst, const Abstract::Edge &e1, const Abstract::Edge &e2) :
+        Abstract::Edge(src, dst), ea(&e1), eb(&e2) {}
+
+    [[nodiscard]] const Abstract::Edge &getEdgeA() const { return *this->ea; }
+    [[nodiscard]] const Abstract::Edge &getEdgeB() const { return *this->eb; }
+
+private:
+    const Abstract::Edge *ea;
+    const Abstract::Edge *eb;
+};
+
+// The product of two FSMs, in which the pairs of edges for which matchEdges holds are
+// taken together. It is explored on the fly: the states are the pairs of initial states
+// and the pairs reached from them, created when the outgoing edges of a state are first
+// asked for. getStates and getEdges give the part explored so far. A pair is final if
+// both its states are final. The components must not change while the product is used.
 class FiniteStateMachine : public Abstract::FiniteStateMachine {
 public:
     FiniteStateMachine(const Abstract::FiniteStateMachine &fsm1,
-                       const Abstract::FiniteStateMachine &fsm2) :
-        fsm_a(&fsm1), fsm_b(&fsm2) {}
+                       const Abstract::FiniteStateMachine &fsm2);
+
+    ~FiniteStateMachine() override = default;
+
+    FiniteStateMachine(const FiniteStateMachine &) = delete;
+    FiniteStateMachine &operator=(const FiniteStateMachine &other) = delete;
+    FiniteStateMachine(FiniteStateMachine &&) = delete;
+    FiniteStateMachine &operator=(FiniteStateMachine &&) = delete;
+
+    std::unique_ptr<Abstract::FiniteStateMachine> newInstance() override {
+        throw MaxPlus::MPException("A product FSM cannot be created without its components.");
+    }
 
     [[nodiscard]] Abstract::StateRef getInitialState() const override;
 
+    [[nodiscard]] const Abstract::SetOfStateRefs &getInitialStates() const override {
+        return this->initialStates;
+    }
+
+    [[nodiscard]] const Abstract::SetOfStateRefs &getFinalStates() const override {
+        return this->finalStates;
+    }
+
+    [[nodiscard]] const Abstract::SetOfStates &getStates() const override { return this->states; }
+
+    [[nodiscard]] Abstract::SetOfStateRefs getStateRefs() const override;
+
+    [[nodiscard]] const Abstract::SetOfEdges &getEdges() const override { return this->edges; }
+
+    [[nodiscard]] bool exploresOnDemand() const override { return true; }
+
+    // test whether the edges of the components are taken together
     [[nodiscard]] virtual bool matchEdges(const Abstract::Edge &e1,
                                           const Abstract::Edge &e2) const = 0;
 
-    [[nodiscard]] virtual Abstract::Edge *ensureEdge(const Abstract::Edge &e1,
-                                                     const Abstract::Edge &e2) const = 0;
+    // the state of the pair (s1, s2), created if it does not exist yet
+    State &getPairState(const Abstract::State &s1, const Abstract::State &s2);
 
 private:
-    const Abstract::FiniteStateMachine* fsm_a;
-    const Abstract::FiniteStateMachine* fsm_b;
+    friend class State;
+
+    // add the outgoing edges of s and the states they lead to
+    void exploreState(State &s);
+
+    const Abstract::FiniteStateMachine *fsm_a;
+    const Abstract::FiniteStateMachine *fsm_b;
+    Abstract::SetOfStates states;
+    Abstract::SetOfEdges edges;
+    Abstract::SetOfStateRefs initialStates;
+    Abstract::SetOfStateRefs finalStates;
+    // the states by the ids of their pairs of states
+    std::unordered_map<std::uint64_t, State *> pairs;
 };
 
 } // namespace Product
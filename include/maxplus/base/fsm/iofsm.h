@@ -4,12 +4,20 @@
 #include "maxplus/base/basic_types.h"
 #include "maxplus/base/fsm/fsm.h"
 #include "maxplus/base/string/cstring.h"
+#include <functional>
 #include <utility>
 
 // Input/Output Automaton
 using InputAction = MaxPlus::MPString;
 using OutputAction = MaxPlus::MPString;
 using IOAEdgeLabel = std::pair<InputAction, OutputAction>;
+
+template <> struct std::hash<IOAEdgeLabel> {
+    std::size_t operator()(const IOAEdgeLabel &l) const noexcept {
+        return MaxPlus::hashCombine(std::hash<InputAction>()(l.first),
+                                    std::hash<OutputAction>()(l.second));
+    }
+};
 using IOAState = ::MaxPlus::FSM::Labeled::State<MaxPlus::CId, IOAEdgeLabel>;
 using IOAStateRef = const IOAState *;
 using IOAEdge = ::MaxPlus::FSM::Labeled::Edge<MaxPlus::CId, IOAEdgeLabel>;
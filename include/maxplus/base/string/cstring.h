@@ -169,4 +169,11 @@ void stringTok(MPStrings &l, const MPString &str, const char *tok = " \t\n");
 
 } // namespace MaxPlus
 
+// hash an MPString as the string it is
+template <> struct std::hash<MaxPlus::MPString> {
+    std::size_t operator()(const MaxPlus::MPString &s) const noexcept {
+        return std::hash<std::string>()(s);
+    }
+};
+
 #endif
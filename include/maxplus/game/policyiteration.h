@@ -127,6 +127,22 @@ private:
                                           CDouble epsilon) {
         const SetOfStates<SL, EL> &states = game.getStates();
 
+        // The distance computations look up the edge between a state and its
+        // successor many times; index the transitions for the duration of the run.
+        struct TransitionIndexScope {
+            RatioGame<SL, EL> &game;
+            bool wasIndexed;
+            explicit TransitionIndexScope(RatioGame<SL, EL> &g) :
+                game(g), wasIndexed(g.hasTransitionIndex()) {
+                this->game.indexTransitions();
+            }
+            ~TransitionIndexScope() { this->game.indexTransitions(this->wasIndexed); }
+            TransitionIndexScope(const TransitionIndexScope &) = delete;
+            TransitionIndexScope &operator=(const TransitionIndexScope &) = delete;
+            TransitionIndexScope(TransitionIndexScope &&) = delete;
+            TransitionIndexScope &operator=(TransitionIndexScope &&) = delete;
+        } indexScope(game);
+
         bool improvement = true;
 
         // Initialize distance vector.
@@ -145,11 +161,8 @@ private:
         // Initialize state ids.
         std::map<const State<SL, EL> *, CDouble> stateIds;
         int cid = 0;
-        for (auto &it : states) {
-            auto &si = *(it.second);
-            // Source vertex.
-            auto &state = dynamic_cast<State<SL, EL> &>(si);
-            stateIds[&state] = cid;
+        for (const auto *state : game.getTypedStates()) {
+            stateIds[state] = cid;
             cid++;
         }
 
@@ -167,15 +180,10 @@ private:
 
             // Improve the strategy of player 0, just one iteration.
             std::set<StateRef<SL, EL>> &states = game.getV0();
-            for (auto &si : states) {
-                // Source vertex.
-                auto v = dynamic_cast<StateRef<SL, EL>>(si);
+            for (const auto *v : states) {
                 // Outgoing edges.
-                auto es = dynamic_cast<const FSM::Abstract::SetOfEdgeRefs &>(v->getOutgoingEdges());
-                for (const auto &ei : es) {
-                    auto e = dynamic_cast<EdgeRef<SL, EL>>(ei);
-
-                    const auto &u = dynamic_cast<const StateRef<SL, EL>>(e->getDestination());
+                for (const auto *e : v->getTypedOutgoingEdges()) {
+                    const auto *u = e->getDestination();
 
                     CDouble mw = ratioVector[u];
                     auto w1 = static_cast<CDouble>(game.getWeight1(e));
@@ -258,17 +266,10 @@ private:
             dw2_i_t = evalResult.dw2_i_t;
 
             std::set<StateRef<SL, EL>> &states = game.getV1();
-            for (auto &si : states) {
-                // Source vertex.
-                auto v = dynamic_cast<StateRef<SL, EL>>(si);
-
+            for (const auto *v : states) {
                 // Outgoing edges.
-                const auto &es =
-                        dynamic_cast<const FSM::Abstract::SetOfEdgeRefs &>(v->getOutgoingEdges());
-                for (const auto &ei : es) {
-                    auto e = dynamic_cast<EdgeRef<SL, EL>>(ei);
-
-                    auto u = dynamic_cast<const StateRef<SL, EL>>(e->getDestination());
+                for (const auto *e : v->getTypedOutgoingEdges()) {
+                    const auto *u = e->getDestination();
 
                     CDouble cycleRatio = r_i_t[u];
                     auto w1 = static_cast<CDouble>(game.getWeight1(e));
@@ -384,10 +385,7 @@ private:
 
         std::map<const State<SL, EL> *, CDouble> r_i_t;
 
-        for (auto &it : states) {
-            // Source vertex.
-            auto &si = *(it.second);
-            auto v = dynamic_cast<const State<SL, EL> *>(&(si));
+        for (const auto *v : game.getTypedStates()) {
             if (visited[v] == BOTTOM_VERTEX) {
                 const State<SL, EL> *u = v;
                 while (visited[u] == BOTTOM_VERTEX) { // NOLINT(*pointer-arithmetic)
@@ -471,8 +469,7 @@ private:
         std::map<const State<SL, EL> *, CDouble> dw2;
 
         // For all selected states.
-        for (const auto &ssi : selectedStates) {
-            auto u = dynamic_cast<const State<SL, EL> *>(ssi);
+        for (const auto *u : StateRefRange<SL, EL>(selectedStates)) {
             if (equalTo(r_i_t[u], r_prev[u], epsilon)) {
                 d_i_t[u] = d_prev[u];
                 dw2[u] = dw2_prev[u];
@@ -484,9 +481,7 @@ private:
         }
 
         // For all states.
-        for (auto &it : states) {
-            auto &si = *(it.second);
-            auto state = dynamic_cast<const State<SL, EL> *>(&(si));
+        for (const auto *state : game.getTypedStates()) {
             if (!visited[state]) {
                 const State<SL, EL> *u = state;
                 while (!visited[u]) { // NOLINT(*pointer-arithmetic)
@@ -528,15 +523,9 @@ private:
      * @return true if and only if each state has at least one outgoing edge
      */
     bool checkEachStateHasSuccessor(RatioGame<SL, EL> &graph) {
-        for (auto &it : graph.getStates()) {
-            auto &si = it.second;
-            // For each state fetch its outgoing edges.
-            auto &src = dynamic_cast<State<SL, EL> &>(*si);
-            const auto &es =
-                    dynamic_cast<const FSM::Abstract::SetOfEdgeRefs &>(src.getOutgoingEdges());
-
+        for (const auto *src : graph.getTypedStates()) {
             // Check whether there are any outgoing edges.
-            if (es.empty()) {
+            if (src->getOutgoingEdges().empty()) {
                 return false;
             }
         }
@@ -557,11 +546,8 @@ private:
                                                         T value) {
         std::map<const State<SL, EL> *, T> vector;
 
-        for (auto &it : states) {
-            auto &si = *(it.second);
-            // Source vertex.
-            auto &state = dynamic_cast<State<SL, EL> &>(si);
-            vector[&state] = value;
+        for (const auto *state : StateRange<SL, EL>(states)) {
+            vector[state] = value;
         }
         return vector;
     }
@@ -76,18 +76,10 @@ public:
      * @param graph game graph on which a random strategy is initialized
      */
     void initializeRandomStrategy(RatioGame<SL, EL> &graph) {
-        for (auto &it : graph.getStates()) {
-            auto &si = *(it.second);
-            // Source vertex.
-            auto &src = dynamic_cast<State<SL, EL> &>(si);
-            const auto &es =
-                    dynamic_cast<const FSM::Abstract::SetOfEdgeRefs &>(src.getOutgoingEdges());
-
+        for (const auto *src : graph.getTypedStates()) {
             // Find the first outgoing edge, and get the target.
-            auto *e = dynamic_cast<EdgeRef<SL, EL>>(*es.begin());
-            auto dest = dynamic_cast<StateRef<SL, EL>>(e->getDestination());
-
-            strategyVector[&src] = dest;
+            const auto *e = *(src->getTypedOutgoingEdges().begin());
+            strategyVector[src] = e->getDestination();
         }
     }
 
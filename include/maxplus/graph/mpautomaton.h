@@ -143,6 +143,24 @@ inline MPAEdgeLabel makeMPAEdgeLabel(MPDelay delay, MPString &mode) {
     return el;
 }
 
+} // namespace MaxPlus
+
+// hashing of the MPA labels, for the hashed label index of the automaton
+template <> struct std::hash<MaxPlus::MPAStateLabel> {
+    std::size_t operator()(const MaxPlus::MPAStateLabel &l) const noexcept {
+        return MaxPlus::hashCombine(std::hash<MaxPlus::CId>()(l.id), std::hash<int>()(l.tokenNr));
+    }
+};
+
+template <> struct std::hash<MaxPlus::MPAEdgeLabel> {
+    std::size_t operator()(const MaxPlus::MPAEdgeLabel &l) const noexcept {
+        return MaxPlus::hashCombine(std::hash<MaxPlus::MPDelay>()(l.delay),
+                                    std::hash<MaxPlus::MPString>()(l.mode));
+    }
+};
+
+namespace MaxPlus {
+
 // Types for edges and states and sets.
 using MPAState = ::MaxPlus::FSM::Labeled::State<MPAStateLabel, MPAEdgeLabel>;
 using MPAStateRef = ::MaxPlus::FSM::Labeled::StateRef<MPAStateLabel, MPAEdgeLabel>;
@@ -223,6 +241,18 @@ inline MPString toString(const MPAREdgeLabel &l) {
            + ", reward: " + MPString(l.reward) + ")";
 };
 
+} // namespace MaxPlus
+
+template <> struct std::hash<MaxPlus::MPAREdgeLabel> {
+    std::size_t operator()(const MaxPlus::MPAREdgeLabel &l) const noexcept {
+        std::size_t h = MaxPlus::hashCombine(std::hash<MaxPlus::MPDelay>()(l.delay),
+                                             std::hash<MaxPlus::MPString>()(l.mode));
+        return MaxPlus::hashCombine(h, std::hash<MaxPlus::CDouble>()(l.reward));
+    }
+};
+
+namespace MaxPlus {
+
 // Types of states, edges, sets and cycle of an MPA with rewards.
 using MPARState = ::MaxPlus::FSM::Labeled::State<MPAStateLabel, MPAREdgeLabel>;
 using MPARStateRef = ::MaxPlus::FSM::Labeled::StateRef<MPAStateLabel, MPAREdgeLabel>;
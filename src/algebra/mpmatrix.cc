@@ -40,6 +40,7 @@
 
 #include "algebra/mpmatrix.h"
 #include "algebra/mptype.h"
+#include "base/analysis/mcm/mcm.h"
 #include "base/analysis/mcm/mcmgraph.h"
 #include "base/exception/exception.h"
 #include <cmath>
@@ -1044,16 +1045,18 @@ CDouble Matrix::mp_eigenvalue() const {
         nodes[i] = n;
     }
 
-    // Add edges to the MCM graph
-    // for all states of the fsm...
+    // Add edges to the MCM graph for all finite entries
     CId edgeId = 0;
     uint row = 0;
     uint col = 0;
     std::vector<MPTime>::const_iterator i;
     for (i = this->table.begin(); i != this->table.end(); i++) {
-        // Add the edge to the MCM graph and the src and dst node
-        mcmGraph->addEdge(edgeId, *nodes[col], *nodes[row], static_cast<CDouble>(*i), 1.0, true);
-        edgeId++;
+        if (!i->isMinusInfinity()) {
+            // Add the edge to the MCM graph and the src and dst node
+            mcmGraph->addEdge(
+                    edgeId, *nodes[col], *nodes[row], static_cast<CDouble>(*i), 1.0, true);
+            edgeId++;
+        }
 
         col++;
         if (col == sz) {
@@ -1062,11 +1065,12 @@ CDouble Matrix::mp_eigenvalue() const {
         }
     }
 
-    // prune the graph
-    std::unique_ptr<MCMgraph> pruned = mcmGraph->pruneEdges();
-
     // compute MCM
-    CDouble res = pruned->calculateMaximumCycleMeanKarpDouble();
+    CDouble res = maximumCycleMean(*mcmGraph);
+    if (std::isinf(res)) {
+        // the matrix has no cycles
+        return static_cast<CDouble>(MP_MINUS_INFINITY);
+    }
     return res;
 }
 
@@ -1226,25 +1230,24 @@ Matrix::mp_generalized_eigenvectors() const { // NOLINT(*cognitive-complexity)
                 }
             }
 
-            // compute normalization map replace MP_MINUS_INFINITY by -DBL_MAX
-            std::map<CId, CDouble> muMap;
-            for (unsigned int n = 0; n < trCycleMeans.size(); n++) {
-                muMap[n] = (MPTime(trCycleMeans[n]).isMinusInfinity())
-                                   ? -DBL_MAX
-                                   : static_cast<CDouble>(trCycleMeans[n]);
+            // compute normalization per node, replace MP_MINUS_INFINITY by -DBL_MAX
+            std::vector<CDouble> mu;
+            for (const auto &n : precGraph.getNodes()) {
+                mu.push_back((MPTime(trCycleMeans[n.id]).isMinusInfinity())
+                                     ? -DBL_MAX
+                                     : static_cast<CDouble>(trCycleMeans[n.id]));
             }
 
             // compute normalized longest paths
-            std::map<CId, CDouble> lengths =
-                    precGraph.normalizedLongestPaths(criticalNodes[k]->id, muMap);
+            std::vector<CDouble> lengths = precGraph.longestPathLengths(criticalNodes[k]->id, mu);
             // make an eigenvector
             Vector v(this->getCols());
-            for (auto length : lengths) {
-                CId n = length.first;
-                MPTime value =
-                        ((MPTime(length.second)) <= MP_MINUS_INFINITY ? MP_MINUS_INFINITY
-                                                                      : MPTime(length.second));
-                v.put(static_cast<unsigned int>(n), value);
+            auto length = lengths.begin();
+            for (const auto &n : precGraph.getNodes()) {
+                MPTime value = ((MPTime(*length)) <= MP_MINUS_INFINITY ? MP_MINUS_INFINITY
+                                                                       : MPTime(*length));
+                v.put(static_cast<unsigned int>(n.id), value);
+                length++;
             }
 
             // check if it is a generalized eigenvalue
@@ -39,6 +39,11 @@
  */
 
 #include "base/analysis/mcm/mcm.h"
+#include "base/analysis/mcm/mcmdg.h"
+#include "base/analysis/mcm/mcmhoward.h"
+#include "base/analysis/mcm/mcmyto.h"
+#include "base/exception/exception.h"
+#include <atomic>
 
 namespace MaxPlus::Graphs {
 // #define __CALC_MCM_PER_CYCLE__
@@ -71,4 +76,111 @@ v_uint mcmGetAdjacentActors(uint a,
 #else // __CALC_MCM_PER_CYCLE__
 
 #endif // __CALC_MCM_PER_CYCLE__
+
+namespace {
+
+/*
+ * The thresholds of the selection between Howard and Young-Tarjan-Orlin. The
+ * defaults in MCMSelectionThresholds are calibrated with maxplus_bench
+ * (Release build), for E = 1000 and 3000:
+ *
+ *   maxplus_bench --algorithms howard,yto,automatic --min-edges E --max-edges 100000 --seeds 3
+ *
+ * YTO is faster than Howard on every sdf graph, by a factor 1.3 to 1.8, and on
+ * dense-matrix graphs from about 30000 edges (a factor 2 at 100000). Howard is
+ * faster on grid graphs and slightly faster on random-sparse graphs. Neither
+ * the number of edges nor the number of strongly connected components
+ * separates these: grid and sdf graphs both have m/n = 2 and a single
+ * component, and YTO wins on small and large sdf graphs alike. Two features do:
+ *  - the share of edges without delay, which is 0.8 for the sdf graphs and 0
+ *    for the other families. Precedence graphs of dataflow iterations consist
+ *    of long chains of zero-delay edges closed by a few edges with tokens;
+ *    their critical cycles are long, and Howard needs many policy
+ *    improvements to find them.
+ *  - the density m/n. YTO wins on dense-matrix graphs from m/n of about 120,
+ *    which they reach at 30000 edges.
+ * With these thresholds automatic takes 1.16 s over all runs, against 1.34 s
+ * for always Howard, 1.43 s for always YTO and 1.13 s for the faster of the
+ * two in every run. The cycle ratio always uses Howard, as YTO requires all
+ * delays to be positive and was not faster on the graphs that satisfy that.
+ */
+std::atomic<CDouble> minZeroDelayShare{MCMSelectionThresholds().minZeroDelayShare};
+std::atomic<CDouble> minDensity{MCMSelectionThresholds().minDensity};
+
+} // namespace
+
+MCMSelectionThresholds mcmSelectionThresholds() {
+    MCMSelectionThresholds t;
+    t.minZeroDelayShare = minZeroDelayShare.load();
+    t.minDensity = minDensity.load();
+    return t;
+}
+
+void setMCMSelectionThresholds(const MCMSelectionThresholds &thresholds) {
+    minZeroDelayShare.store(thresholds.minZeroDelayShare);
+    minDensity.store(thresholds.minDensity);
+}
+
+MCMAlgorithm selectMaximumCycleMeanAlgorithm(MCMgraph &g, bool ratio) {
+    if (ratio || g.numberOfEdges() == 0) {
+        return MCMAlgorithm::Howard;
+    }
+    // Young-Tarjan-Orlin assumes that all nodes are visible with ids ranging
+    // from 0 up to the number of nodes, that the graph has a cycle and that all
+    // cycles have a positive weight.
+    CId expectedId = 0;
+    for (const auto &n : g.getNodes()) {
+        if (!n.visible || n.id != expectedId++ || n.out.empty()) {
+            return MCMAlgorithm::Howard;
+        }
+    }
+    size_t zeroDelay = 0;
+    for (const auto &e : g.getEdges()) {
+        if (!e.visible || e.w <= 0.0) {
+            return MCMAlgorithm::Howard;
+        }
+        if (e.d == 0.0) {
+            zeroDelay++;
+        }
+    }
+    auto m = static_cast<CDouble>(g.numberOfEdges());
+    auto n = static_cast<CDouble>(g.numberOfNodes());
+    MCMSelectionThresholds t = mcmSelectionThresholds();
+    if (static_cast<CDouble>(zeroDelay) >= t.minZeroDelayShare * m || m >= t.minDensity * n) {
+        return MCMAlgorithm::YoungTarjanOrlin;
+    }
+    return MCMAlgorithm::Howard;
+}
+
+CDouble maximumCycleMean(MCMgraph &g, MCMAlgorithm algorithm) {
+    if (algorithm == MCMAlgorithm::Automatic) {
+        algorithm = selectMaximumCycleMeanAlgorithm(g, false);
+    }
+    switch (algorithm) {
+    case MCMAlgorithm::Karp:
+        return maximumCycleMeanKarpGeneral(g);
+    case MCMAlgorithm::KarpDouble:
+        return maximumCycleMeanKarpDoubleGeneral(g);
+    case MCMAlgorithm::DasdanGupta:
+        return mcmDG(g);
+    case MCMAlgorithm::YoungTarjanOrlin:
+        return maxCycleMeanYoungTarjanOrlin(g);
+    default:
+        return maximumCycleMeanHowardGeneral(g, nullptr);
+    }
+}
+
+CDouble maximumCycleRatio(MCMgraph &g, std::vector<const MCMedge *> *cycle, MCMAlgorithm algorithm) {
+    if (algorithm == MCMAlgorithm::Automatic) {
+        algorithm = selectMaximumCycleMeanAlgorithm(g, true);
+    }
+    switch (algorithm) {
+    case MCMAlgorithm::Howard:
+        return maximumCycleRatioHoward(g, cycle);
+    case MCMAlgorithm::YoungTarjanOrlin:
+        return maxCycleRatioAndCriticalCycleYoungTarjanOrlin(g, cycle);
+    default:
+        throw MPException("The selected algorithm does not support cycle ratios.");
+    }
+}
 } // namespace MaxPlus::Graphs
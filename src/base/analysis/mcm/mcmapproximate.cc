@@ -0,0 +1,281 @@
+/*
+ *  Eindhoven University of Technology
+ *  Eindhoven, The Netherlands
+ *  Dept. of Electrical Engineering
+ *  Electronics Systems Group
+ *  Model Based Design Lab (https://computationalmodeling.info/)
+ *
+ *  Name            :   mcmapproximate.cc
+ *
+ *  Function        :   Approximate the maximum cycle mean or ratio of a
+ *                      graph with guaranteed bounds.
+ *
+ *  Copyright 2023 Eindhoven University of Technology
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the “Software”),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included
+ *  in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "base/analysis/mcm/mcmapproximate.h"
+#include "base/analysis/mcm/mcmhoward.h"
+#include <algorithm>
+#include <deque>
+
+namespace MaxPlus::Graphs {
+
+namespace {
+
+// the time and the cancel flag are checked once per this many nodes taken from the queue
+constexpr unsigned int INTERRUPT_INTERVAL = 1024;
+
+} // namespace
+
+ApproximateMCM::ApproximateMCM(MCMgraph &g, bool ratio) : ratio(ratio) {
+    std::vector<MCMnode *> nodes;
+    convertMCMgraphToTrimmedMatrix(g, &nodes, &this->arcs, &this->ij, &this->w, &this->d);
+    this->nrNodes = static_cast<int>(nodes.size());
+    if (this->nrNodes == 0) {
+        this->upper = -INFINITY;
+        return;
+    }
+    if (!ratio) {
+        this->d.assign(this->d.size(), 1.0);
+    }
+    std::vector<int> zeroCycle;
+    if (ratio && findZeroTransitCycle(this->ij, this->d, this->nrNodes, &zeroCycle)) {
+        this->setCycle(zeroCycle);
+        this->lower = INFINITY;
+        return;
+    }
+
+    const size_t m = this->w.size();
+    this->inStart.assign(this->nrNodes + 1, 0);
+    for (size_t a = 0; a < m; a++) {
+        this->inStart[this->ij[(2 * a) + 1] + 1]++;
+    }
+    for (int j = 0; j < this->nrNodes; j++) {
+        this->inStart[j + 1] += this->inStart[j];
+    }
+    this->inArcs.resize(m);
+    std::vector<int> fill(this->inStart.begin(), this->inStart.end() - 1);
+    for (size_t a = 0; a < m; a++) {
+        this->inArcs[fill[this->ij[(2 * a) + 1]]++] = static_cast<int>(a);
+    }
+    this->potential.assign(this->nrNodes, 0.0);
+
+    // the initial lower bound is the cycle reached from the first node when
+    // every node follows its heaviest outgoing arc
+    std::vector<int> heaviest(this->nrNodes, -1);
+    for (size_t a = 0; a < m; a++) {
+        int i = this->ij[2 * a];
+        if (heaviest[i] < 0 || this->w[a] > this->w[heaviest[i]]) {
+            heaviest[i] = static_cast<int>(a);
+        }
+    }
+    std::vector<bool> visited(this->nrNodes, false);
+    int x = 0;
+    while (!visited[x]) {
+        visited[x] = true;
+        x = this->ij[(2 * heaviest[x]) + 1];
+    }
+    std::vector<int> greedyCycle;
+    int y = x;
+    do { // NOLINT(*avoid-do-while)
+        greedyCycle.push_back(heaviest[y]);
+        y = this->ij[(2 * heaviest[y]) + 1];
+    } while (y != x);
+    this->setCycle(greedyCycle);
+    this->step = std::max(1.0, std::fabs(this->lower));
+}
+
+bool ApproximateMCM::converged(CDouble tolerance) const {
+    if (this->lower == this->upper) {
+        return true;
+    }
+    if (std::isinf(this->lower) || std::isinf(this->upper)) {
+        return false;
+    }
+    return this->upper - this->lower
+           <= tolerance * std::max(std::fabs(this->lower), std::fabs(this->upper));
+}
+
+bool ApproximateMCM::refine(CDouble tolerance,
+                            std::chrono::nanoseconds budget,
+                            const std::atomic<bool> *cancel) {
+    auto start = std::chrono::steady_clock::now();
+    while (!this->converged(tolerance)) {
+        if ((cancel != nullptr && cancel->load(std::memory_order_relaxed))
+            || std::chrono::steady_clock::now() - start >= budget) {
+            return false;
+        }
+
+        // without an upper bound, search above the lower bound with growing steps
+        CDouble lambda = std::isinf(this->upper) ? this->lower + this->step
+                                                 : this->lower + ((this->upper - this->lower) / 2);
+        CDouble oldLower = this->lower;
+        CDouble oldUpper = this->upper;
+        CheckResult result = this->check(lambda, start, budget, cancel);
+        if (result == CheckResult::Interrupted) {
+            return false;
+        }
+        if (result == CheckResult::PositiveCycle) {
+            this->step *= 2;
+        }
+        // the bounds are as close as the floating point precision allows
+        if (this->lower <= oldLower && this->upper >= oldUpper) {
+            break;
+        }
+    }
+    return this->converged(tolerance);
+}
+
+void ApproximateMCM::setCycle(const std::vector<int> &arcsOnCycle) {
+    CDouble weight = 0.0;
+    CDouble delay = 0.0;
+    for (int a : arcsOnCycle) {
+        weight += this->w[a];
+        delay += this->d[a];
+    }
+    CDouble value = delay > 0.0 ? weight / delay : INFINITY;
+    if (value > this->lower || this->cycle.empty()) {
+        this->lower = std::max(this->lower, value);
+        this->cycle.clear();
+        for (int a : arcsOnCycle) {
+            this->cycle.push_back(this->arcs[a]);
+        }
+    }
+}
+
+/**
+ * check ()
+ * Searches a cycle that is positive for the arc weights w - lambda * d with a
+ * queue-based Bellman-Ford on the incoming arcs, using Tarjan's subtree
+ * disassembly. The parent arcs form a tree, kept in preorder with the depth of
+ * every node, in which the parent of a node is the successor through which
+ * its potential was last increased. When a potential increases, the subtree
+ * below the node is out of date and is removed from the tree; its nodes are
+ * skipped in the queue until they are reached again. If the subtree contains
+ * the node that caused the increase, the tree path closes a positive cycle.
+ * If there is no positive cycle, the potentials are kept and give the upper
+ * bound.
+ */
+ApproximateMCM::CheckResult ApproximateMCM::check(CDouble lambda,
+                                                  std::chrono::steady_clock::time_point start,
+                                                  std::chrono::nanoseconds budget,
+                                                  const std::atomic<bool> *cancel) {
+    const int n = this->nrNodes;
+    std::vector<CDouble> pi = this->potential;
+    std::vector<int> parent(n, -1);
+
+    // preorder thread through the tree, with n as the root of which all
+    // nodes are initially a child
+    const int root = n;
+    std::vector<int> next(n + 1);
+    std::vector<int> prev(n + 1);
+    std::vector<int> depth(n + 1, 1);
+    std::vector<bool> inTree(n, true);
+    for (int x = 0; x <= n; x++) {
+        next[x] = x == n ? 0 : x + 1;
+        prev[x] = x == 0 ? n : x - 1;
+    }
+    depth[root] = 0;
+
+    std::deque<int> queue;
+    std::vector<bool> inQueue(n, true);
+    for (int j = 0; j < n; j++) {
+        queue.push_back(j);
+    }
+
+    unsigned int taken = 0;
+    while (!queue.empty()) {
+        if (++taken == INTERRUPT_INTERVAL) {
+            taken = 0;
+            if ((cancel != nullptr && cancel->load(std::memory_order_relaxed))
+                || std::chrono::steady_clock::now() - start >= budget) {
+                return CheckResult::Interrupted;
+            }
+        }
+        int j = queue.front();
+        queue.pop_front();
+        inQueue[j] = false;
+        if (!inTree[j]) {
+            continue;
+        }
+        for (int k = this->inStart[j]; k < this->inStart[j + 1]; k++) {
+            int a = this->inArcs[k];
+            int i = this->ij[2 * a];
+            CDouble value = this->w[a] - (lambda * this->d[a]) + pi[j];
+            if (value <= pi[i]) {
+                continue;
+            }
+            if (i == j) {
+                this->setCycle({a});
+                return CheckResult::PositiveCycle;
+            }
+
+            // remove the subtree below i, looking for j
+            if (inTree[i]) {
+                int last = i;
+                for (int x = next[i]; depth[x] > depth[i]; x = next[x]) {
+                    if (x == j) {
+                        std::vector<int> positiveCycle = {a};
+                        for (int y = j; y != i; y = this->ij[(2 * parent[y]) + 1]) {
+                            positiveCycle.push_back(parent[y]);
+                        }
+                        this->setCycle(positiveCycle);
+                        return CheckResult::PositiveCycle;
+                    }
+                    inTree[x] = false;
+                    last = x;
+                }
+                next[prev[i]] = next[last];
+                prev[next[last]] = prev[i];
+            }
+
+            // make i a child of j
+            pi[i] = value;
+            parent[i] = a;
+            inTree[i] = true;
+            depth[i] = depth[j] + 1;
+            next[i] = next[j];
+            prev[i] = j;
+            prev[next[j]] = i;
+            next[j] = i;
+            if (!inQueue[i]) {
+                inQueue[i] = true;
+                queue.push_back(i);
+            }
+        }
+    }
+
+    // the potentials hold for every lambda of at least the largest
+    // (w + pi[j] - pi[i]) / d over the arcs with a positive delay
+    CDouble bound = -INFINITY;
+    for (size_t a = 0; a < this->w.size(); a++) {
+        if (this->d[a] > 0.0) {
+            int i = this->ij[2 * a];
+            int j = this->ij[(2 * a) + 1];
+            bound = std::max(bound, (this->w[a] + pi[j] - pi[i]) / this->d[a]);
+        }
+    }
+    this->upper = std::max(this->lower, std::min({this->upper, lambda, bound}));
+    this->potential = std::move(pi);
+    return CheckResult::NoPositiveCycle;
+}
+
+} // namespace MaxPlus::Graphs
@@ -0,0 +1,306 @@
+/*
+ *  Eindhoven University of Technology
+ *  Eindhoven, The Netherlands
+ *  Dept. of Electrical Engineering
+ *  Electronics Systems Group
+ *  Model Based Design Lab (https://computationalmodeling.info/)
+ *
+ *  Name            :   mcmbatch.cc
+ *
+ *  Function        :   Compute the maximum cycle mean or ratio of a graph
+ *                      for many weight scenarios at once.
+ *
+ *  Copyright 2023 Eindhoven University of Technology
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the “Software”),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included
+ *  in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "base/analysis/mcm/mcmbatch.h"
+#include "base/analysis/mcm/mcmhoward.h"
+#include "base/exception/exception.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace MaxPlus::Graphs {
+
+namespace {
+
+// graphs with at most this many nodes are analysed with Karp's algorithm if
+// the algorithm is selected automatically
+constexpr size_t KARP_MAX_NODES = 64;
+
+// maximum number of scenarios that are handled together
+constexpr size_t BLOCK_SIZE = 16;
+
+// maximum number of distances that Karp's algorithm stores per block
+constexpr size_t KARP_MAX_DISTANCES = size_t(1) << 22;
+
+/**
+ * The trimmed topology of the graph, shared by all scenarios. The weight of
+ * arc a in scenario s is weights[s][edgeIndex[a]].
+ */
+struct BatchTopology {
+    int nrNodes = 0;
+    int nrArcs = 0;
+    std::vector<int> ij;
+    std::vector<CDouble> D;
+    std::vector<size_t> edgeIndex;
+};
+
+BatchTopology trimTopology(MCMgraph &g, const std::vector<std::vector<CDouble>> &weights) {
+    size_t nrEdges = g.getEdges().size();
+    for (const auto &row : weights) {
+        if (row.size() != nrEdges) {
+            throw MPException("The number of weights of a scenario does not match the number of "
+                              "edges of the graph.");
+        }
+    }
+
+    BatchTopology t;
+    std::vector<MCMnode *> nodes;
+    std::vector<const MCMedge *> arcs;
+    std::vector<CDouble> A;
+    convertMCMgraphToTrimmedMatrix(g, &nodes, &arcs, &t.ij, &A, &t.D);
+    t.nrNodes = static_cast<int>(nodes.size());
+    t.nrArcs = static_cast<int>(arcs.size());
+
+    std::unordered_map<const MCMedge *, size_t> position;
+    size_t k = 0;
+    for (const auto &e : g.getEdges()) {
+        position[&e] = k++;
+    }
+    t.edgeIndex.reserve(arcs.size());
+    for (const auto *e : arcs) {
+        t.edgeIndex.push_back(position[e]);
+    }
+    return t;
+}
+
+/**
+ * forEachBlock ()
+ * Calls f(first, last) for consecutive blocks of at most blockSize of the
+ * given number of scenarios. The blocks are claimed by nrThreads threads; an
+ * exception thrown by f stops the remaining blocks and is rethrown.
+ */
+void forEachBlock(size_t nrScenarios,
+                  size_t blockSize,
+                  unsigned int nrThreads,
+                  const std::function<void(size_t, size_t)> &f) {
+    size_t nrBlocks = (nrScenarios + blockSize - 1) / blockSize;
+    if (nrThreads == 0) {
+        nrThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    nrThreads = static_cast<unsigned int>(std::min<size_t>(nrThreads, nrBlocks));
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr error = nullptr;
+    std::mutex errorMutex;
+    auto worker = [&]() {
+        try {
+            for (size_t b = next++; b < nrBlocks; b = next++) {
+                f(b * blockSize, std::min(nrScenarios, (b + 1) * blockSize));
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (error == nullptr) {
+                error = std::current_exception();
+            }
+            next = nrBlocks;
+        }
+    };
+
+    if (nrThreads <= 1) {
+        worker();
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(nrThreads - 1);
+        for (unsigned int i = 1; i < nrThreads; i++) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+    if (error != nullptr) {
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * karpBlock ()
+ * Karp's algorithm for the scenarios first up to last. The distances are
+ * those of walks of exactly k arcs from an implicit source that reaches every
+ * node with a zero weight edge; they are stored with the scenario innermost,
+ * such that the relaxation of an arc is a loop over the scenarios.
+ */
+void karpBlock(const BatchTopology &t,
+               const std::vector<std::vector<CDouble>> &weights,
+               size_t first,
+               size_t last,
+               std::vector<CDouble> *result) {
+    const size_t S = last - first;
+    const auto n = static_cast<size_t>(t.nrNodes);
+    const auto m = static_cast<size_t>(t.nrArcs);
+
+    std::vector<CDouble> W(m * S);
+    for (size_t a = 0; a < m; a++) {
+        for (size_t s = 0; s < S; s++) {
+            W[a * S + s] = weights[first + s][t.edgeIndex[a]];
+        }
+    }
+
+    std::vector<CDouble> dist((n + 1) * n * S, -INFINITY);
+    std::fill(dist.begin(), dist.begin() + static_cast<std::ptrdiff_t>(n * S), 0.0);
+    for (size_t k = 1; k <= n; k++) {
+        const CDouble *prev = &dist[(k - 1) * n * S];
+        CDouble *cur = &dist[k * n * S];
+        for (size_t a = 0; a < m; a++) {
+            const CDouble *du = prev + static_cast<size_t>(t.ij[2 * a]) * S;
+            CDouble *dv = cur + static_cast<size_t>(t.ij[(2 * a) + 1]) * S;
+            const CDouble *w = &W[a * S];
+            for (size_t s = 0; s < S; s++) {
+                dv[s] = std::max(dv[s], du[s] + w[s]);
+            }
+        }
+    }
+
+    // minimum over k of (D_n(v) - D_k(v)) / (n - k), ignoring the k for which
+    // there is no walk of k arcs to v
+    const CDouble *dn = &dist[n * n * S];
+    std::vector<CDouble> minimum(n * S, INFINITY);
+    for (size_t k = 0; k < n; k++) {
+        const CDouble *dk = &dist[k * n * S];
+        const auto length = static_cast<CDouble>(n - k);
+        for (size_t i = 0; i < n * S; i++) {
+            CDouble mean = dk[i] == -INFINITY ? INFINITY : (dn[i] - dk[i]) / length;
+            minimum[i] = std::min(minimum[i], mean);
+        }
+    }
+    for (size_t s = 0; s < S; s++) {
+        CDouble mcm = -INFINITY;
+        for (size_t v = 0; v < n; v++) {
+            if (dn[v * S + s] != -INFINITY) {
+                mcm = std::max(mcm, minimum[v * S + s]);
+            }
+        }
+        (*result)[first + s] = mcm;
+    }
+}
+
+/**
+ * howardBlock ()
+ * Howard's algorithm for the scenarios first up to last, each run
+ * warm-started with the policy and bias of the previous scenario.
+ */
+void howardBlock(const BatchTopology &t,
+                 const std::vector<std::vector<CDouble>> &weights,
+                 size_t first,
+                 size_t last,
+                 bool ratio,
+                 std::vector<CDouble> *result) {
+    std::vector<CDouble> A(t.nrArcs);
+    std::unique_ptr<std::vector<CDouble>> chi = nullptr;
+    std::unique_ptr<std::vector<CDouble>> v = nullptr;
+    std::unique_ptr<std::vector<int>> pi = nullptr;
+    int nr_iterations = 0;
+    int nr_components = 0;
+    for (size_t s = first; s < last; s++) {
+        for (size_t a = 0; a < A.size(); a++) {
+            A[a] = weights[s][t.edgeIndex[a]];
+        }
+        const std::vector<int> *initialPolicy = pi.get();
+        const std::vector<CDouble> *initialBias = v.get();
+        std::unique_ptr<std::vector<int>> previousPolicy = std::move(pi);
+        std::unique_ptr<std::vector<CDouble>> previousBias = std::move(v);
+        if (ratio) {
+            HowardRatio(t.ij, A, t.D, t.nrNodes, t.nrArcs, &chi, &v, &pi, &nr_iterations,
+                        &nr_components, initialPolicy, initialBias);
+        } else {
+            Howard(t.ij, A, t.nrNodes, t.nrArcs, &chi, &v, &pi, &nr_iterations, &nr_components,
+                   initialPolicy, initialBias);
+        }
+        (*result)[s] = *std::max_element(chi->begin(), chi->end());
+    }
+}
+
+} // namespace
+
+std::vector<CDouble> maximumCycleMeans(MCMgraph &g,
+                                       const std::vector<std::vector<CDouble>> &weights,
+                                       MCMAlgorithm algorithm,
+                                       unsigned int nrThreads) {
+    BatchTopology t = trimTopology(g, weights);
+    std::vector<CDouble> result(weights.size(), -INFINITY);
+    if (t.nrNodes == 0) {
+        return result;
+    }
+
+    if (algorithm == MCMAlgorithm::Automatic) {
+        algorithm = static_cast<size_t>(t.nrNodes) <= KARP_MAX_NODES ? MCMAlgorithm::Karp
+                                                                     : MCMAlgorithm::Howard;
+    }
+    switch (algorithm) {
+    case MCMAlgorithm::Karp:
+    case MCMAlgorithm::KarpDouble: {
+        auto n = static_cast<size_t>(t.nrNodes);
+        size_t blockSize = std::clamp<size_t>(KARP_MAX_DISTANCES / ((n + 1) * n), 1, BLOCK_SIZE);
+        forEachBlock(weights.size(), blockSize, nrThreads, [&](size_t first, size_t last) {
+            karpBlock(t, weights, first, last, &result);
+        });
+        break;
+    }
+    case MCMAlgorithm::Howard:
+        forEachBlock(weights.size(), BLOCK_SIZE, nrThreads, [&](size_t first, size_t last) {
+            howardBlock(t, weights, first, last, false, &result);
+        });
+        break;
+    default:
+        throw MPException("The selected algorithm does not support batches of scenarios.");
+    }
+    return result;
+}
+
+std::vector<CDouble> maximumCycleRatios(MCMgraph &g,
+                                        const std::vector<std::vector<CDouble>> &weights,
+                                        unsigned int nrThreads) {
+    BatchTopology t = trimTopology(g, weights);
+    if (t.nrNodes == 0) {
+        return std::vector<CDouble>(weights.size(), -INFINITY);
+    }
+    std::vector<int> cycle;
+    if (findZeroTransitCycle(t.ij, t.D, t.nrNodes, &cycle)) {
+        return std::vector<CDouble>(weights.size(), INFINITY);
+    }
+
+    std::vector<CDouble> result(weights.size(), -INFINITY);
+    forEachBlock(weights.size(), BLOCK_SIZE, nrThreads, [&](size_t first, size_t last) {
+        howardBlock(t, weights, first, last, true, &result);
+    });
+    return result;
+}
+
+} // namespace MaxPlus::Graphs
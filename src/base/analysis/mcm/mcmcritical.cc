@@ -0,0 +1,192 @@
+/*
+ *  Eindhoven University of Technology
+ *  Eindhoven, The Netherlands
+ *  Dept. of Electrical Engineering
+ *  Electronics Systems Group
+ *  Model Based Design Lab (https://computationalmodeling.info/)
+ *
+ *  Name            :   mcmcritical.cc
+ *
+ *  Function        :   Compute the critical graph of the maximum cycle mean
+ *                      or ratio of a graph.
+ *
+ *  Copyright 2023 Eindhoven University of Technology
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the “Software”),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included
+ *  in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "base/analysis/mcm/mcmcritical.h"
+#include "base/analysis/mcm/mcmhoward.h"
+#include "base/exception/exception.h"
+#include <algorithm>
+#include <memory>
+
+namespace MaxPlus::Graphs {
+
+namespace {
+
+// relative tolerance of the tightness test, as in Howard's algorithm
+constexpr CDouble EPSILON_FACTOR = 0.000000001;
+
+/**
+ * stronglyConnectedComponents ()
+ * Iterative Tarjan's algorithm on the arcs with the given out-adjacency in
+ * index arrays. Returns the component of every node.
+ */
+std::vector<int> stronglyConnectedComponents(int nrNodes,
+                                             const std::vector<int> &outStart,
+                                             const std::vector<int> &outNode,
+                                             int *nrComponents) {
+    std::vector<int> component(nrNodes, -1);
+    std::vector<int> index(nrNodes, -1);
+    std::vector<int> low(nrNodes, 0);
+    std::vector<int> stack;
+    std::vector<std::pair<int, int>> callStack;
+    int counter = 0;
+    *nrComponents = 0;
+    for (int s = 0; s < nrNodes; s++) {
+        if (index[s] >= 0) {
+            continue;
+        }
+        callStack.emplace_back(s, outStart[s]);
+        index[s] = low[s] = counter++;
+        stack.push_back(s);
+        while (!callStack.empty()) {
+            auto &[u, k] = callStack.back();
+            if (k < outStart[u + 1]) {
+                int v = outNode[k++];
+                if (index[v] < 0) {
+                    index[v] = low[v] = counter++;
+                    stack.push_back(v);
+                    callStack.emplace_back(v, outStart[v]);
+                } else if (component[v] < 0) {
+                    low[u] = std::min(low[u], index[v]);
+                }
+                continue;
+            }
+            int done = u;
+            callStack.pop_back();
+            if (low[done] == index[done]) {
+                int x = 0;
+                do { // NOLINT(*avoid-do-while)
+                    x = stack.back();
+                    stack.pop_back();
+                    component[x] = *nrComponents;
+                } while (x != done);
+                (*nrComponents)++;
+            }
+            if (!callStack.empty()) {
+                int parent = callStack.back().first;
+                low[parent] = std::min(low[parent], low[done]);
+            }
+        }
+    }
+    return component;
+}
+
+} // namespace
+
+CriticalGraph criticalGraph(MCMgraph &g, bool ratio) {
+    CriticalGraph result;
+
+    std::vector<MCMnode *> nodes;
+    std::vector<const MCMedge *> arcs;
+    std::vector<int> ij;
+    std::vector<CDouble> A;
+    std::vector<CDouble> D;
+    convertMCMgraphToTrimmedMatrix(g, &nodes, &arcs, &ij, &A, &D);
+    auto n = static_cast<int>(nodes.size());
+    if (n == 0) {
+        return result;
+    }
+    if (!ratio) {
+        D.assign(D.size(), 1.0);
+    }
+    std::vector<int> zeroCycle;
+    if (ratio && findZeroTransitCycle(ij, D, n, &zeroCycle)) {
+        throw MPException("The graph has a cycle with zero delay.");
+    }
+
+    std::unique_ptr<std::vector<CDouble>> chi = nullptr;
+    std::unique_ptr<std::vector<CDouble>> v = nullptr;
+    std::unique_ptr<std::vector<int>> pi = nullptr;
+    int nr_iterations = 0;
+    int nr_components = 0;
+    auto nr_arcs = static_cast<int>(arcs.size());
+    HowardRatio(ij, A, D, n, nr_arcs, &chi, &v, &pi, &nr_iterations, &nr_components);
+    CDouble mean = *std::max_element(chi->begin(), chi->end());
+    result.cycleMean = mean;
+
+    auto [minA, maxA] = std::minmax_element(A.begin(), A.end());
+    CDouble epsilon = EPSILON_FACTOR * std::max(1.0, *maxA - *minA);
+
+    // the tight arcs between nodes with the maximal cycle time
+    auto critical = [&](int i) { return (*chi)[i] >= mean - epsilon; };
+    std::vector<int> outStart(n + 1, 0);
+    std::vector<int> tight;
+    for (int a = 0; a < nr_arcs; a++) {
+        int i = ij[2 * a];
+        int j = ij[(2 * a) + 1];
+        if (critical(i) && critical(j) && A[a] - (mean * D[a]) + (*v)[j] >= (*v)[i] - epsilon) {
+            tight.push_back(a);
+            outStart[i + 1]++;
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        outStart[i + 1] += outStart[i];
+    }
+    std::vector<int> outNode(tight.size());
+    std::vector<int> outArc(tight.size());
+    std::vector<int> fill(outStart.begin(), outStart.end() - 1);
+    for (int a : tight) {
+        int k = fill[ij[2 * a]]++;
+        outNode[k] = ij[(2 * a) + 1];
+        outArc[k] = a;
+    }
+
+    // the critical graph consists of the tight arcs inside a component
+    int nrComponents = 0;
+    std::vector<int> component = stronglyConnectedComponents(n, outStart, outNode, &nrComponents);
+    std::vector<int> criticalIndex(n, -1);
+    std::vector<int> classIndex(nrComponents, -1);
+    auto addNode = [&](int i) {
+        if (criticalIndex[i] < 0) {
+            criticalIndex[i] = static_cast<int>(result.nodes.size());
+            result.nodes.push_back(nodes[i]);
+            if (classIndex[component[i]] < 0) {
+                classIndex[component[i]] = result.nrClasses++;
+            }
+            result.nodeClass.push_back(classIndex[component[i]]);
+        }
+        return criticalIndex[i];
+    };
+    for (int i = 0; i < n; i++) {
+        for (int k = outStart[i]; k < outStart[i + 1]; k++) {
+            int j = outNode[k];
+            if (component[i] == component[j]) {
+                result.edges.push_back(arcs[outArc[k]]);
+                result.ij.push_back(addNode(i));
+                result.ij.push_back(addNode(j));
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace MaxPlus::Graphs
@@ -48,72 +48,78 @@
  *  SOFTWARE.
  */
 
+#include "base/analysis/mcm/mcmdg.h"
 #include "base/analysis/mcm/mcmgraph.h"
-#include "base/math/cmath.h"
-#include <climits>
+#include <algorithm>
 #include <cmath>
-#include <memory>
+#include <vector>
 
 namespace MaxPlus::Graphs {
 
+namespace {
+
+/**
+ * A node u reached after k steps in the breadth-first unfolding of the
+ * graph, with the longest distance d of a k-step walk to u. prev is the
+ * entry of u at the previous level on which u was reached, or -1.
+ */
+struct DGEntry {
+    int k;
+    int node;
+    CDouble d;
+    int prev;
+};
+
+} // namespace
+
 // assumes teh graph is strongly connected and assumes the node ids are 0...N-1,
 // where N is the number of nodes
+// Only the (level, node) pairs that are actually reached are stored. They are
+// appended in breadth-first order, so the list of entries is the queue as well.
 CDouble mcmDG_SCC(MCMgraph &mcmGraph) {
 
-    // Allocate memory
     const int n = static_cast<int>(mcmGraph.nrVisibleNodes());
-    std::vector<int> level(n);
-    std::vector<std::vector<int>> pi(n + 1, std::vector<int>(n));
-    std::vector<std::vector<int>> d(n + 1, std::vector<int>(n));
+    std::vector<int> level(n, -1);
+    std::vector<int> lastEntry(n, -1);
+    std::vector<DGEntry> entries;
+    entries.reserve(2 * static_cast<size_t>(n));
 
     // Initialize
-    for (int i = 0; i < n; i++) {
-        level[i] = -1;
+    std::vector<MCMnode *> nodes(n);
+    for (auto &u : mcmGraph.getNodes()) {
+        nodes[u.id] = &u;
     }
-    d[0][0] = 0;
-    pi[0][0] = -1;
-    level[0] = 0;
-    std::list<int> Q_k;
-    Q_k.push_back(0);
-    std::list<MCMnode *> Q_u;
-    Q_u.push_back(&(mcmGraph.getNodes().front()));
+    const int first = static_cast<int>(mcmGraph.getNodes().front().id);
+    entries.push_back({0, first, 0.0, -1});
+    level[first] = 0;
+    lastEntry[first] = 0;
 
     // Compute the distances
-    int k = Q_k.front();
-    Q_k.pop_front();
-    MCMnode *u = Q_u.front();
-    Q_u.pop_front();
-    do {
-        for (auto &e : u->out) {
-            MCMnode *v = e->dst;
-
-            if (level[v->id] < static_cast<int>(k + 1)) {
-                Q_k.push_back(k + 1);
-                Q_u.push_back(v);
-                pi[k + 1][v->id] = level[v->id];
-                level[v->id] = k + 1;
-                d[k + 1][v->id] = -INT_MAX;
+    for (size_t head = 0; head < entries.size() && entries[head].k < n; head++) {
+        const int k = entries[head].k;
+        const CDouble du = entries[head].d;
+        for (const auto *e : nodes[entries[head].node]->out) {
+            const auto v = static_cast<int>(e->dst->id);
+            if (level[v] < k + 1) {
+                entries.push_back({k + 1, v, -INFINITY, lastEntry[v]});
+                level[v] = k + 1;
+                lastEntry[v] = static_cast<int>(entries.size() - 1);
             }
-            d[k + 1][v->id] = MAX(d[k + 1][v->id], d[k][u->id] + ((int)e->w));
+            CDouble &dv = entries[lastEntry[v]].d;
+            dv = std::max(dv, du + e->w);
         }
-        k = Q_k.front();
-        Q_k.pop_front();
-        u = Q_u.front();
-        Q_u.pop_front();
-    } while (k < n);
+    }
 
     // Compute lambda using Karp's theorem
-    CDouble l = -INT_MAX;
-    for (const auto &u : mcmGraph.getNodes()) {
-
-        if (level[u.id] == n) {
-            CDouble ld = INT_MAX;
-            k = pi[n][u.id];
-            while (k > -1) {
-                ld = MIN(ld, (CDouble)(d[n][u.id] - d[k][u.id]) / (CDouble)(n - k));
-                k = pi[k][u.id];
+    auto l = static_cast<CDouble>(-INFINITY);
+    for (int u = 0; u < n; u++) {
+        if (level[u] == n) {
+            const DGEntry &en = entries[lastEntry[u]];
+            auto ld = static_cast<CDouble>(INFINITY);
+            for (int i = en.prev; i > -1; i = entries[i].prev) {
+                ld = std::min(ld, (en.d - entries[i].d) / static_cast<CDouble>(n - entries[i].k));
             }
-            l = MAX(l, ld);
+            l = std::max(l, ld);
         }
     }
 
@@ -124,9 +130,6 @@ CDouble mcmDG_SCC(MCMgraph &mcmGraph) {
  * mcmDG ()
  * The function computes the maximum cycle mean of an MCM graph using
  * Dasdan-Gupta's algorithm.
- * Note: this algorithm assumes that edge weights are integer valued !
- * @todo
- * check if algorithm can be generalized to float edge weights
  */
 CDouble mcmDG(MCMgraph &mcmGraph) {
 
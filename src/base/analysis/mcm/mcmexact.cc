@@ -0,0 +1,365 @@
+/*
+ *  Eindhoven University of Technology
+ *  Eindhoven, The Netherlands
+ *  Dept. of Electrical Engineering
+ *  Electronics Systems Group
+ *  Model Based Design Lab (https://computationalmodeling.info/)
+ *
+ *  Name            :   mcmexact.cc
+ *
+ *  Function        :   Compute the maximum cycle mean or ratio of a graph
+ *                      with integer weights exactly.
+ *
+ *  Copyright 2023 Eindhoven University of Technology
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the “Software”),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included
+ *  in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "base/analysis/mcm/mcmexact.h"
+#include "base/analysis/mcm/mcmhoward.h"
+#include "base/analysis/mcm/mcmyto.h"
+#include "base/exception/exception.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <unordered_map>
+
+namespace MaxPlus::Graphs {
+
+namespace {
+
+using Integer = std::int64_t;
+
+// largest magnitude of a double for which all integers are representable
+constexpr CDouble MAX_EXACT_DOUBLE = 9007199254740992.0;
+
+// largest magnitude of a scaled bias that is used as an initial potential
+constexpr CDouble MAX_INITIAL_POTENTIAL = 4611686018427387904.0;
+
+void overflow() {
+    throw MPException("Integer overflow in the exact cycle ratio computation.");
+}
+
+Integer checkedAdd(Integer a, Integer b) {
+    if ((b > 0 && a > std::numeric_limits<Integer>::max() - b)
+        || (b < 0 && a < std::numeric_limits<Integer>::min() - b)) {
+        overflow();
+    }
+    return a + b;
+}
+
+Integer checkedSubtract(Integer a, Integer b) {
+    if ((b < 0 && a > std::numeric_limits<Integer>::max() + b)
+        || (b > 0 && a < std::numeric_limits<Integer>::min() + b)) {
+        overflow();
+    }
+    return a - b;
+}
+
+Integer checkedMultiply(Integer a, Integer b) {
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+    const Integer max = std::numeric_limits<Integer>::max();
+    const Integer min = std::numeric_limits<Integer>::min();
+    if (a > 0 ? (b > 0 ? a > max / b : b < min / a) : (b > 0 ? a < min / b : b < max / a)) {
+        overflow();
+    }
+    return a * b;
+}
+
+Integer toInteger(CDouble x) {
+    if (!(std::fabs(x) <= MAX_EXACT_DOUBLE) || std::floor(x) != x) {
+        throw MPException("The exact cycle ratio requires integer edge weights and delays.");
+    }
+    return static_cast<Integer>(x);
+}
+
+/**
+ * The trimmed graph with integer weights w and delays d of its arcs.
+ */
+struct ExactGraph {
+    int nrNodes = 0;
+    std::vector<int> ij;
+    std::vector<Integer> w;
+    std::vector<Integer> d;
+};
+
+/**
+ * findParentCycle ()
+ * Returns the arcs of a cycle in the graph formed by the parent arcs, or an
+ * empty vector if there is none.
+ */
+std::vector<int> findParentCycle(const ExactGraph &t, const std::vector<int> &parent) {
+    std::vector<int> walk(t.nrNodes, -1);
+    for (int start = 0; start < t.nrNodes; start++) {
+        int x = start;
+        while (x >= 0 && walk[x] < 0) {
+            walk[x] = start;
+            x = parent[x] < 0 ? -1 : t.ij[(2 * parent[x]) + 1];
+        }
+        if (x >= 0 && walk[x] == start) {
+            std::vector<int> cycle;
+            int y = x;
+            do { // NOLINT(*avoid-do-while)
+                cycle.push_back(parent[y]);
+                y = t.ij[(2 * parent[y]) + 1];
+            } while (y != x);
+            return cycle;
+        }
+    }
+    return {};
+}
+
+/**
+ * findPositiveCycle ()
+ * Searches a cycle that is positive for the arc weights q*w - p*d, i.e., a
+ * cycle with a ratio larger than p/q. A queue-based Bellman-Ford computes
+ * potentials pi with pi[i] >= q*w - p*d + pi[j] for every arc from i to j,
+ * starting from q times the bias, if one is given. Since a potential is only
+ * updated if it strictly increases, every cycle of the parent arcs is
+ * positive; the parent arcs are checked for a cycle after every nrNodes
+ * updates. Returns the arcs of a positive cycle, or an empty vector if there
+ * is none.
+ */
+std::vector<int>
+findPositiveCycle(const ExactGraph &t, Integer p, Integer q, const std::vector<CDouble> &bias) {
+    const int n = t.nrNodes;
+    const size_t m = t.w.size();
+
+    std::vector<Integer> c(m);
+    std::vector<int> inStart(n + 1, 0);
+    for (size_t a = 0; a < m; a++) {
+        c[a] = checkedSubtract(checkedMultiply(q, t.w[a]), checkedMultiply(p, t.d[a]));
+        inStart[t.ij[(2 * a) + 1] + 1]++;
+    }
+    for (int j = 0; j < n; j++) {
+        inStart[j + 1] += inStart[j];
+    }
+    std::vector<int> inArcs(m);
+    std::vector<int> fill(inStart.begin(), inStart.end() - 1);
+    for (size_t a = 0; a < m; a++) {
+        inArcs[fill[t.ij[(2 * a) + 1]]++] = static_cast<int>(a);
+    }
+
+    std::vector<Integer> pi(n, 0);
+    if (bias.size() == static_cast<size_t>(n)) {
+        for (int i = 0; i < n; i++) {
+            CDouble x = static_cast<CDouble>(q) * bias[i];
+            if (std::fabs(x) < MAX_INITIAL_POTENTIAL) {
+                pi[i] = std::llround(x);
+            }
+        }
+    }
+
+    std::vector<int> parent(n, -1);
+    std::deque<int> queue;
+    std::vector<bool> inQueue(n, true);
+    for (int j = 0; j < n; j++) {
+        queue.push_back(j);
+    }
+    int updates = 0;
+    while (!queue.empty()) {
+        int j = queue.front();
+        queue.pop_front();
+        inQueue[j] = false;
+        for (int k = inStart[j]; k < inStart[j + 1]; k++) {
+            int a = inArcs[k];
+            int i = t.ij[2 * a];
+            Integer value = checkedAdd(c[a], pi[j]);
+            if (value > pi[i]) {
+                pi[i] = value;
+                parent[i] = a;
+                if (!inQueue[i]) {
+                    inQueue[i] = true;
+                    queue.push_back(i);
+                }
+                if (++updates == n) {
+                    updates = 0;
+                    std::vector<int> cycle = findParentCycle(t, parent);
+                    if (!cycle.empty()) {
+                        return cycle;
+                    }
+                }
+            }
+        }
+    }
+    return {};
+}
+
+/**
+ * howardCandidate ()
+ * Runs Howard's algorithm in floating point and returns the arcs of the policy
+ * cycle with the largest cycle time. The bias is returned in bias.
+ */
+std::vector<int> howardCandidate(const ExactGraph &t,
+                                 const std::vector<CDouble> &A,
+                                 const std::vector<CDouble> &D,
+                                 bool ratio,
+                                 std::vector<CDouble> *bias) {
+    std::unique_ptr<std::vector<CDouble>> chi = nullptr;
+    std::unique_ptr<std::vector<CDouble>> v = nullptr;
+    std::unique_ptr<std::vector<int>> pi = nullptr;
+    int nr_iterations = 0;
+    int nr_components = 0;
+    auto nr_arcs = static_cast<int>(A.size());
+    if (ratio) {
+        HowardRatio(t.ij, A, D, t.nrNodes, nr_arcs, &chi, &v, &pi, &nr_iterations, &nr_components);
+    } else {
+        Howard(t.ij, A, t.nrNodes, nr_arcs, &chi, &v, &pi, &nr_iterations, &nr_components);
+    }
+
+    // the best arc from every node to its successor in the policy
+    std::vector<int> policyArc(t.nrNodes, -1);
+    for (int a = 0; a < nr_arcs; a++) {
+        int i = t.ij[2 * a];
+        if (t.ij[(2 * a) + 1] == (*pi)[i]) {
+            int b = policyArc[i];
+            if (b < 0 || A[a] - (*chi)[i] * D[a] > A[b] - (*chi)[i] * D[b]) {
+                policyArc[i] = a;
+            }
+        }
+    }
+
+    // follow the policy from a node with maximal cycle time to its cycle
+    int x = static_cast<int>(std::max_element(chi->begin(), chi->end()) - chi->begin());
+    std::vector<bool> visited(t.nrNodes, false);
+    while (!visited[x]) {
+        visited[x] = true;
+        x = (*pi)[x];
+    }
+    std::vector<int> cycle;
+    int y = x;
+    do { // NOLINT(*avoid-do-while)
+        cycle.push_back(policyArc[y]);
+        y = (*pi)[y];
+    } while (y != x);
+
+    *bias = *v;
+    return cycle;
+}
+
+CFraction exactCycleRatio(MCMgraph &g,
+                          std::vector<const MCMedge *> *cycle,
+                          MCMAlgorithm algorithm,
+                          bool ratio) {
+    if (cycle != nullptr) {
+        cycle->clear();
+    }
+    if (algorithm == MCMAlgorithm::Automatic) {
+        algorithm = selectMaximumCycleMeanAlgorithm(g, ratio);
+    }
+    if (algorithm != MCMAlgorithm::Howard && algorithm != MCMAlgorithm::YoungTarjanOrlin) {
+        throw MPException("The selected algorithm does not support exact cycle ratios.");
+    }
+
+    std::vector<MCMnode *> nodes;
+    std::vector<const MCMedge *> arcs;
+    std::vector<CDouble> A;
+    std::vector<CDouble> D;
+    ExactGraph t;
+    convertMCMgraphToTrimmedMatrix(g, &nodes, &arcs, &t.ij, &A, &D);
+    t.nrNodes = static_cast<int>(nodes.size());
+    if (t.nrNodes == 0) {
+        throw MPException("The graph has no cycles.");
+    }
+    if (!ratio) {
+        D.assign(D.size(), 1.0);
+    }
+    std::vector<int> zeroCycle;
+    if (ratio && findZeroTransitCycle(t.ij, D, t.nrNodes, &zeroCycle)) {
+        throw MPException("The graph has a cycle with zero delay.");
+    }
+    for (size_t a = 0; a < arcs.size(); a++) {
+        t.w.push_back(toInteger(A[a]));
+        t.d.push_back(toInteger(D[a]));
+    }
+
+    // a candidate critical cycle from the floating point algorithm
+    std::vector<int> candidate;
+    std::vector<CDouble> bias;
+    if (algorithm == MCMAlgorithm::Howard) {
+        candidate = howardCandidate(t, A, D, ratio, &bias);
+    } else {
+        std::vector<const MCMedge *> edges;
+        if (ratio) {
+            maxCycleRatioAndCriticalCycleYoungTarjanOrlin(g, &edges);
+        } else {
+            maxCycleMeanAndCriticalCycleYoungTarjanOrlin(g, &edges);
+        }
+        std::unordered_map<const MCMedge *, int> arcIndex;
+        for (size_t a = 0; a < arcs.size(); a++) {
+            arcIndex[arcs[a]] = static_cast<int>(a);
+        }
+        for (const auto *e : edges) {
+            auto it = arcIndex.find(e);
+            if (it == arcIndex.end()) {
+                throw MPException("Young-Tarjan-Orlin returned an edge that is not on a cycle.");
+            }
+            candidate.push_back(it->second);
+        }
+    }
+
+    // improve the candidate until no cycle has a larger ratio
+    Integer p = 0;
+    Integer q = 0;
+    while (true) {
+        p = 0;
+        q = 0;
+        for (int a : candidate) {
+            p = checkedAdd(p, t.w[a]);
+            q = checkedAdd(q, t.d[a]);
+        }
+        Integer divisor = std::gcd(p, q);
+        p /= divisor;
+        q /= divisor;
+        std::vector<int> better = findPositiveCycle(t, p, q, bias);
+        if (better.empty()) {
+            break;
+        }
+        candidate = better;
+    }
+
+    if (cycle != nullptr) {
+        for (int a : candidate) {
+            cycle->push_back(arcs[a]);
+        }
+    }
+    return CFraction(p, q);
+}
+
+} // namespace
+
+CFraction maximumCycleRatioExact(MCMgraph &g,
+                                 std::vector<const MCMedge *> *cycle,
+                                 MCMAlgorithm algorithm) {
+    return exactCycleRatio(g, cycle, algorithm, true);
+}
+
+CFraction maximumCycleMeanExact(MCMgraph &g,
+                                std::vector<const MCMedge *> *cycle,
+                                MCMAlgorithm algorithm) {
+    return exactCycleRatio(g, cycle, algorithm, false);
+}
+
+} // namespace MaxPlus::Graphs
@@ -41,11 +41,21 @@
 
 #include "base/analysis/mcm/mcmgraph.h"
 #include "base/analysis/mcm/mcm.h"
+#include "base/analysis/mcm/mcmdg.h"
+#include "base/analysis/mcm/mcmhoward.h"
 #include "base/analysis/mcm/mcmyto.h"
+#include "base/exception/exception.h"
+#include "base/fsm/fsm.h"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <deque>
+#include <functional>
 #include <map>
 #include <memory>
+#include <queue>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 namespace MaxPlus::Graphs {
@@ -105,142 +115,187 @@ namespace {
 /**
  * splitMCMedgeToSequence ()
  * The function converts an MCM edge with more than one delay
- * into a sequence of edges with one delay (uses recursive call
- * to itself).
+ * into a sequence of edges with one delay. The delays are peeled off
+ * at the source side, every step adding a dummy node and an edge
+ * with weight zero.
  */
-void splitMCMedgeToSequence(MCMgraph &g, MCMedge &e) { // NOLINT(*no-recursion)
-    // Create dummy node n;
-    MCMnode *n = g.addNode(static_cast<CId>(g.getNodes().size()));
-
-    // Create a new edge between the src node of e and a new
-    // dummy node.
-    MCMedge *eN = g.addEdge(static_cast<CId>(g.getEdges().size()), *e.src, *n, 0, e.d - 1);
-
-    // Remove e from the set of edges its source node is connected to
-    // and add eN to this list
-    for (auto iter = e.src->out.begin(); iter != e.src->out.end(); iter++) {
-        if ((*iter)->id == e.id) {
-            e.src->out.erase(iter);
-            break;
-        }
-    }
-    e.src->out.push_back(eN);
-
-    // Connect e to node n
-    e.src = n;
-    n->out.push_back(&e);
-    n->in.push_back(eN);
-
-    // One delay left on e
-    e.d = 1;
-
-    // More than one delay on the new edge?
-    if (eN->d > 1) {
-        splitMCMedgeToSequence(g, *eN);
+void splitMCMedgeToSequence(MCMgraph &g, MCMedge &e) {
+    MCMedge *last = &e;
+    while (last->d > 1) {
+        MCMedge &cur = *last;
+
+        // Create dummy node n and a new edge between the src node of
+        // cur and n, carrying all but one delay.
+        MCMnode *n = g.addNode(static_cast<CId>(g.getNodes().size()));
+        MCMedge *eN =
+                g.addEdge(static_cast<CId>(g.getEdges().size()), *cur.src, *n, 0, cur.d - 1);
+
+        // Connect cur to node n
+        cur.src->out.remove(&cur);
+        cur.src = n;
+        n->out.push_back(&cur);
+
+        // One delay left on cur
+        cur.d = 1;
+        last = eN;
     }
 }
 
 /**
- * addLongestDelayEdgeForNode ()
- * The function add an additional edge between the node n and any node
- * reachable over e which only uses edges with no initial delays (except
- * for the initial edge e). The weight of the new edge is the longest
- * path from the node n to the destination node.
- * The function uses an adapted version of Dijkstra's shortest path
- * algorithm.
- * Note: algorithm assumes that edge weights are integer values !
+ * ZeroDelayLongestPaths
+ * Longest paths over the edges without delay. The paths from a node are
+ * computed once and shared by all delayed edges entering that node. When
+ * the edges without delay form an acyclic graph, the reachable nodes are
+ * visited in topological order, using a heap on the topological rank.
+ * Otherwise a label-correcting worklist is used, which fails on a cycle
+ * without delay and with a positive weight. Only the sources of delayed
+ * edges are kept as targets: once the edges without delay are hidden, an
+ * edge to any other node ends in a sink and cannot lie on a cycle.
  */
-void addLongestDelayEdgeForNode(MCMgraph &g, MCMnode &n, MCMedge &e) { // NOLINT(*cognitive-complexity)
-    std::vector<int> d(g.getNodes().size());
-    std::vector<const MCMnode *> pi(g.getNodes().size());
-    MCMnodeRefs S;
-    MCMnodeRefs Q = g.getNodeRefs();
-
-    // Initialize single source
-    for (uint v = 0; v < g.getNodes().size(); v++) {
-        d[v] = -1;
-        pi[v] = nullptr;
-    }
-    d[n.id] = 0;
-
-    // Initialize the node connected via the edge e to n
-    d[e.dst->id] = static_cast<int>(e.w);
-
-    // Remove node n from Q and add it to S (only when edge e is no
-    // self-edge)
-    if (e.dst->id != n.id) {
-        for (auto iter = Q.begin(); iter != Q.end(); iter++) {
-            if ((*iter)->id == n.id) {
-                // Is edge e
-                Q.erase(iter);
-                break;
+class ZeroDelayLongestPaths {
+public:
+    using Distances = std::vector<std::pair<MCMnode *, CDouble>>;
+
+    explicit ZeroDelayLongestPaths(MCMgraph &g) {
+        for (auto &n : g.getNodes()) {
+            this->index[&n] = static_cast<unsigned int>(this->nodes.size());
+            this->nodes.push_back(&n);
+        }
+        const size_t nrNodes = this->nodes.size();
+        this->target.assign(nrNodes, false);
+        for (auto &e : g.getEdges()) {
+            if (e.d != 0 && e.visible) {
+                this->target[this->index[e.src]] = true;
             }
         }
-        S.push_back(&n);
-    }
-
-    // Find all longest paths till Q is empty or all reachable paths seen
-    while (!Q.empty()) {
-        MCMnode *u = nullptr;
-
-        // Find node u in Q with largest distance
-        int dMax = -1;
-        for (auto &iter : Q) {
-            if (d[iter->id] > dMax) {
-                u = iter;
-                dMax = d[u->id];
+        this->dist.assign(nrNodes, -INFINITY);
+        this->cache.resize(nrNodes);
+        this->cached.assign(nrNodes, false);
+
+        // topological ranks of the nodes (Kahn's algorithm)
+        std::vector<unsigned int> inDegree(nrNodes, 0);
+        for (auto &e : g.getEdges()) {
+            if (e.d == 0) {
+                inDegree[this->index[e.dst]]++;
             }
         }
-
-        // Found no node with a non-negative distance ?
-        if (dMax < 0) {
-            break;
+        std::vector<unsigned int> order;
+        order.reserve(nrNodes);
+        for (unsigned int v = 0; v < nrNodes; v++) {
+            if (inDegree[v] == 0) {
+                order.push_back(v);
+            }
+        }
+        for (size_t i = 0; i < order.size(); i++) {
+            for (const auto *e : this->nodes[order[i]]->out) {
+                if (e->d == 0 && --inDegree[this->index[e->dst]] == 0) {
+                    order.push_back(this->index[e->dst]);
+                }
+            }
+        }
+        this->acyclic = order.size() == nrNodes;
+        if (this->acyclic) {
+            this->rank.resize(nrNodes);
+            for (unsigned int i = 0; i < nrNodes; i++) {
+                this->rank[order[i]] = i;
+            }
         }
+    }
 
-        // Remove node u from Q and add it to S
-        for (auto iter = Q.begin(); iter != Q.end(); iter++) {
-            if ((*iter)->id == u->id) {
-                Q.erase(iter);
-                break;
+    // The sources of delayed edges reachable from n over at least one edge
+    // without delay, with the length of the longest such path.
+    const Distances &from(MCMnode &n) {
+        unsigned int s = this->index[&n];
+        if (!this->cached[s]) {
+            if (this->acyclic) {
+                this->topologicalFrom(s);
+            } else {
+                this->labelCorrectingFrom(s);
+            }
+            Distances &result = this->cache[s];
+            for (auto v : this->touched) {
+                if (v != s && this->target[v]) {
+                    result.emplace_back(this->nodes[v], this->dist[v]);
+                }
+                this->dist[v] = -INFINITY;
             }
+            this->touched.clear();
+            this->cached[s] = true;
         }
-        S.push_back(u);
+        return this->cache[s];
+    }
 
-        // Relax all nodes v adjacent to u (connected via edges with no tokens)
-        for (auto iter = u->out.begin(); iter != u->out.end(); iter++) {
-            const MCMedge *e = *iter;
-            MCMnode *v = e->dst;
+private:
+    std::unordered_map<const MCMnode *, unsigned int> index;
+    std::vector<MCMnode *> nodes;
+    std::vector<unsigned int> rank;
+    bool acyclic = true;
+    // the sources of delayed edges
+    std::vector<bool> target;
 
-            if (e->d == 0 && d[v->id] < d[u->id] + e->w) {
-                if (d[v->id] != -1) {
-                    // Found a longer path to v, add it to list of
-                    // nodes to be checked (again).
-                    Q.push_back(v);
-                }
+    // scratch distances, -INFINITY for the nodes not reached
+    std::vector<CDouble> dist;
+    std::vector<unsigned int> touched;
+
+    std::vector<Distances> cache;
+    std::vector<bool> cached;
+
+    void reach(unsigned int v, CDouble d) {
+        if (this->dist[v] == -INFINITY) {
+            this->touched.push_back(v);
+        }
+        this->dist[v] = d;
+    }
 
-                d[v->id] = d[u->id] + static_cast<int>(e->w);
-                pi[v->id] = u;
+    void topologicalFrom(unsigned int s) {
+        // min-heap of (rank, node)
+        using Entry = std::pair<unsigned int, unsigned int>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<>> heap;
+        this->reach(s, 0.0);
+        heap.emplace(this->rank[s], s);
+        while (!heap.empty()) {
+            unsigned int u = heap.top().second;
+            heap.pop();
+            for (const auto *e : this->nodes[u]->out) {
+                if (e->d != 0) {
+                    continue;
+                }
+                unsigned int v = this->index[e->dst];
+                if (this->dist[v] == -INFINITY) {
+                    heap.emplace(this->rank[v], v);
+                    this->reach(v, this->dist[u] + e->w);
+                } else if (this->dist[v] < this->dist[u] + e->w) {
+                    this->dist[v] = this->dist[u] + e->w;
+                }
             }
         }
     }
 
-    // Add an edge between the node n and any node m reachable from n
-    // with a weight equal to the longest path from n to m
-    for (auto &m : S) {
-        // Node m reachable from n and not connected directly to n via e?
-        if (d[m->id] > 0 && e.dst->id != m->id) {
-            // Create an edge between n and m
-            MCMedge *eN = g.addEdge(static_cast<CId>(g.getEdges().size()),
-                                    n,
-                                    *m,
-                                    d[m->id],
-                                    e.d,
-                                    false); // e.d should always be 1
-            n.out.push_back(eN);
-            m->in.push_back(eN);
+    void labelCorrectingFrom(unsigned int s) {
+        std::deque<unsigned int> worklist;
+        std::vector<unsigned int> updates(this->nodes.size(), 0);
+        this->reach(s, 0.0);
+        worklist.push_back(s);
+        while (!worklist.empty()) {
+            unsigned int u = worklist.front();
+            worklist.pop_front();
+            for (const auto *e : this->nodes[u]->out) {
+                if (e->d != 0) {
+                    continue;
+                }
+                unsigned int v = this->index[e->dst];
+                if (this->dist[v] < this->dist[u] + e->w) {
+                    if (++updates[v] > this->nodes.size()) {
+                        throw MPException("Cycle without delay and with positive weight in "
+                                          "addLongestDelayEdgesToMCMgraph().");
+                    }
+                    this->reach(v, this->dist[u] + e->w);
+                    worklist.push_back(v);
+                }
+            }
         }
     }
-}
+};
 
 } // namespace
 
@@ -253,11 +308,8 @@ void addLongestDelayEdgeForNode(MCMgraph &g, MCMnode &n, MCMedge &e) { // NOLINT
  */
 void addLongestDelayEdgesToMCMgraph(MCMgraph &g) {
 
-    // Find longest path between a node n and a node m
-    // over all sequences of edges in which only the
-    // first edge may contain a delay
+    // Split edges with more than one delay
     for (auto &e : g.getEdgeRefs()) {
-        // More than one delay on the edge?
         if (e->d > 1) {
             splitMCMedgeToSequence(g, *e);
         }
@@ -266,15 +318,16 @@ void addLongestDelayEdgesToMCMgraph(MCMgraph &g) {
     // Find longest path between a node n and a node m
     // over all sequences of edges in which only the
     // first edge may contain a delay
+    ZeroDelayLongestPaths paths(g);
     for (auto &e : g.getEdgeRefs()) {
         // Initial tokens on edge?
         if (e->d != 0 && e->visible) {
-            // Find the longest path from n to any node m
-            // and add an edge with the path wait to the graph
-            addLongestDelayEdgeForNode(g, *e->src, *e);
-
-            // Seen this edge (set it to invisible)
-            e->visible = false;
+            // Add an edge from the source of e to any source m of a delayed
+            // edge reachable from the destination of e, weighted with the
+            // longest path
+            for (const auto &[m, w] : paths.from(*e->dst)) {
+                g.addEdge(static_cast<CId>(g.getEdges().size()), *e->src, *m, e->w + w, e->d);
+            }
         }
     }
 
@@ -660,73 +713,54 @@ void relabelMCMgraph(MCMgraph &g) {
 // Prune the edges in the MCMgraph to maintain only Pareto maximal combinations
 // Of the weight and number of tokens pair pair of nodes
 // Generates a new graph
+// The outgoing edges of every node are sorted on (dst, d, -w, id); in that order
+// an edge is Pareto maximal if and only if its weight exceeds the weight of
+// all edges before it to the same destination. Of equal edges, the one with
+// the smallest id is kept.
 // Note this algorithm does currently not distinguish visible and invisible edges!
 std::unique_ptr<MCMgraph> MCMgraph::pruneEdges() {
 
-    class _local {
-    public:
-        std::map<MCMnode *, MCMedgeRefs, MCMNodeLess> paretoEdges;
-        void insert(MCMedge *e) {
-            MCMedgeRefs &edges = paretoEdges[e->dst];
-            // Simple Cull
-            auto i = edges.begin();
-            bool cont = i != edges.end();
-            bool add_e = true;
-            while (cont) {
-                MCMedge *f = *i;
-                // if e is worse than f
-                if ((e->d <= f->d) && (e->w >= f->w)) {
-                    // remove f from edges;
-                    i = edges.erase(i);
-                } else {
-                    // if f is worse than e
-                    if ((f->d <= e->d) && (f->w >= e->w)) {
-                        // forget e and stop iterating;
-                        add_e = false;
-                        cont = false;
-                    } else {
-                        // incomparable, go on
-                        i++;
-                    }
-                }
-                cont = cont && (i != edges.end());
-            }
-            if (add_e) {
-                edges.push_back(e);
-            }
-        }
-    };
-
-    _local local;
-
     // create new graph
     std::unique_ptr<MCMgraph> result = std::make_unique<MCMgraph>();
 
     // create all nodes.
-    std::map<MCMnode *, MCMnode *> newNodeMap;
+    std::unordered_map<const MCMnode *, MCMnode *> newNodeMap;
+    newNodeMap.reserve(this->nodes.size());
     for (auto &u : this->nodes) {
-        auto *n = result->addNode(u.id, u.visible);
-        newNodeMap[&u] = n;
+        newNodeMap[&u] = result->addNode(u.id, u.visible);
     }
 
-    // for every node
+    std::vector<const MCMedge *> edges;
     for (auto &u : this->nodes) {
-
-        local.paretoEdges.clear();
-
-        // for every outgoing edges to a simple cull Pareto filtering
-        for (auto &i : u.out) {
-            local.insert(i);
-        }
+        edges.assign(u.out.begin(), u.out.end());
+        std::sort(edges.begin(), edges.end(), [](const MCMedge *e, const MCMedge *f) {
+            if (e->dst->id != f->dst->id) {
+                return e->dst->id < f->dst->id;
+            }
+            if (e->d != f->d) {
+                return e->d < f->d;
+            }
+            if (e->w != f->w) {
+                return e->w > f->w;
+            }
+            return e->id < f->id;
+        });
 
         // add Pareto Edges to new Graph.
-        // for every dst node
-        for (auto &j : local.paretoEdges) {
-            const MCMedgeRefs &edges = j.second;
-            // for every edge
-            for (const auto &e : edges) {
-                result->addEdge(e->id, *newNodeMap[&u], *newNodeMap[e->dst], e->w, e->d, true);
+        MCMnode &src = *newNodeMap[&u];
+        const MCMnode *dst = nullptr;
+        MCMnode *newDst = nullptr;
+        CDouble maxWeight = 0;
+        for (const auto *e : edges) {
+            if (e->dst != dst) {
+                dst = e->dst;
+                newDst = newNodeMap[dst];
+            } else if (e->w <= maxWeight) {
+                // dominated by an earlier edge with fewer tokens
+                continue;
             }
+            maxWeight = e->w;
+            result->addEdge(e->id, src, *newDst, e->w, e->d, true);
         }
     }
 
@@ -739,11 +773,24 @@ CDouble MCMgraph::calculateMaximumCycleMeanKarpDouble(const MCMnode **criticalNo
     return maximumCycleMeanKarpDouble(*this, criticalNode);
 }
 
+CDouble MCMgraph::calculateMaximumCycleMeanDasdanGupta() { return mcmDG(*this); }
+
+CDouble MCMgraph::calculateMaximumCycleMeanHoward(MCMnode **criticalNode,
+                                                 std::vector<int> *policy,
+                                                 std::vector<CDouble> *bias) {
+    return maximumCycleMeanHoward(*this, criticalNode, policy, bias);
+}
+
 CDouble MCMgraph::calculateMaximumCycleRatioAndCriticalCycleYoungTarjanOrlin(
         std::vector<const MCMedge *> *cycle) {
     return maxCycleRatioAndCriticalCycleYoungTarjanOrlin(*this, cycle);
 }
 
+CDouble
+MCMgraph::calculateMaximumCycleRatioAndCriticalCycleHoward(std::vector<const MCMedge *> *cycle) {
+    return maximumCycleRatioHoward(*this, cycle);
+}
+
 void MCMgraph::relabelNodeIds(std::map<CId, CId> *nodeIdMap) {
     int k = 0;
     for (auto &i : this->nodes) {
@@ -775,39 +822,250 @@ std::unique_ptr<MCMgraph> MCMgraph::normalize(const std::map<CId, CDouble> &mu)
     return result;
 }
 
-// longest path computation, may not be implemented optimally.
-std::map<CId, CDouble> MCMgraph::longestPaths(const CId rootNodeId) const {
-    std::map<CId, CDouble> result;
-    for (const auto &n : this->nodes) {
-        result[n.id] = (n.id == rootNodeId) ? 0.0 : -DBL_MAX;
-    }
-    bool changed = true;
-    while (changed) {
-        changed = false;
-        for (const auto &e : this->edges) {
-            if (result[e.src->id] != -DBL_MAX) {
-                if (result[e.src->id] + e.w > result[e.dst->id]) {
-                    changed = true;
-                    result[e.dst->id] = result[e.src->id] + e.w;
+namespace {
+
+// relative tolerance below which a cycle of normalized weights counts as zero
+constexpr CDouble CYCLE_EPSILON = 1e-9;
+
+} // namespace
+
+/**
+ * longestPathLengths ()
+ * The nodes and edges are put in index arrays, with the weight of every edge
+ * normalized on the fly. If the part of the graph reachable from the root is
+ * acyclic, the lengths are computed in one pass in topological order.
+ * Otherwise a queue-based Bellman-Ford with Tarjan's subtree disassembly is
+ * used: the tree of last improving edges is kept in preorder with the depth
+ * of every node; when the length of a node increases, its subtree is out of
+ * date and is removed from the tree, and if the subtree contains the node
+ * through which the length increased, a positive cycle has been closed.
+ * Cycles whose weight is zero up to rounding errors are ignored.
+ */
+std::vector<CDouble> MCMgraph::longestPathLengths(CId rootNodeId,
+                                                  CDouble mu,
+                                                  const std::vector<CDouble> *nodeMu) const {
+    const auto n = static_cast<int>(this->nodes.size());
+    std::unordered_map<CId, int> index;
+    int root = -1;
+    for (const auto &node : this->nodes) {
+        int k = static_cast<int>(index.size());
+        index[node.id] = k;
+        if (node.id == rootNodeId) {
+            root = k;
+        }
+    }
+    std::vector<CDouble> length(n, -DBL_MAX);
+    if (root < 0) {
+        return length;
+    }
+
+    // outgoing edges in index arrays, with normalized weights
+    std::vector<int> outStart(n + 1, 0);
+    for (const auto &e : this->edges) {
+        outStart[index[e.src->id] + 1]++;
+    }
+    for (int k = 0; k < n; k++) {
+        outStart[k + 1] += outStart[k];
+    }
+    std::vector<int> fill(outStart.begin(), outStart.end() - 1);
+    std::vector<int> arcSrc(this->edges.size());
+    std::vector<int> arcDst(this->edges.size());
+    std::vector<CDouble> arcWeight(this->edges.size());
+    for (const auto &e : this->edges) {
+        int u = index[e.src->id];
+        int a = fill[u]++;
+        arcSrc[a] = u;
+        arcDst[a] = index[e.dst->id];
+        CDouble normalization = nodeMu == nullptr ? mu : (*nodeMu)[u];
+        arcWeight[a] = normalization == -DBL_MAX ? e.w : e.w - normalization;
+    }
+
+    // topological order of the nodes reachable from the root
+    std::vector<int> inDegree(n, 0);
+    std::vector<bool> reached(n, false);
+    std::vector<int> order = {root};
+    reached[root] = true;
+    for (size_t k = 0; k < order.size(); k++) {
+        for (int a = outStart[order[k]]; a < outStart[order[k] + 1]; a++) {
+            inDegree[arcDst[a]]++;
+            if (!reached[arcDst[a]]) {
+                reached[arcDst[a]] = true;
+                order.push_back(arcDst[a]);
+            }
+        }
+    }
+    size_t nrReached = order.size();
+    order.clear();
+    if (inDegree[root] == 0) {
+        order.push_back(root);
+    }
+    for (size_t k = 0; k < order.size(); k++) {
+        for (int a = outStart[order[k]]; a < outStart[order[k] + 1]; a++) {
+            if (--inDegree[arcDst[a]] == 0) {
+                order.push_back(arcDst[a]);
+            }
+        }
+    }
+
+    length[root] = 0.0;
+    if (order.size() == nrReached) {
+        for (int u : order) {
+            for (int a = outStart[u]; a < outStart[u + 1]; a++) {
+                length[arcDst[a]] = std::max(length[arcDst[a]], length[u] + arcWeight[a]);
+            }
+        }
+        return length;
+    }
+
+    // preorder thread through the tree of improving edges, rooted at the root
+    std::vector<int> parent(n, -1);
+    std::vector<int> next(n, root);
+    std::vector<int> prev(n, root);
+    std::vector<int> depth(n, 0);
+    std::vector<bool> inTree(n, false);
+    inTree[root] = true;
+    std::deque<int> queue = {root};
+    std::vector<bool> inQueue(n, false);
+    inQueue[root] = true;
+    while (!queue.empty()) {
+        int u = queue.front();
+        queue.pop_front();
+        inQueue[u] = false;
+        if (!inTree[u]) {
+            continue;
+        }
+        for (int a = outStart[u]; a < outStart[u + 1]; a++) {
+            int v = arcDst[a];
+            CDouble value = length[u] + arcWeight[a];
+            if (value <= length[v]) {
+                continue;
+            }
+
+            // an improvement of v through its own subtree closes a cycle
+            bool closesCycle = (u == v);
+            int last = v;
+            if (inTree[v]) {
+                for (int x = next[v]; x != root && depth[x] > depth[v]; x = next[x]) {
+                    closesCycle = closesCycle || x == u;
+                    last = x;
                 }
             }
+            if (closesCycle) {
+                CDouble weight = arcWeight[a];
+                CDouble magnitude = std::fabs(arcWeight[a]);
+                for (int x = u; x != v; x = arcSrc[parent[x]]) {
+                    weight += arcWeight[parent[x]];
+                    magnitude += std::fabs(arcWeight[parent[x]]);
+                }
+                if (weight > CYCLE_EPSILON * std::max(1.0, magnitude)) {
+                    throw MPException("The graph has a positive cycle; longest paths are unbounded.");
+                }
+                continue;
+            }
+
+            // remove the subtree below v and make v a child of u
+            if (inTree[v]) {
+                for (int x = next[v]; x != next[last]; x = next[x]) {
+                    inTree[x] = false;
+                }
+                next[prev[v]] = next[last];
+                prev[next[last]] = prev[v];
+            }
+            length[v] = value;
+            parent[v] = a;
+            inTree[v] = true;
+            depth[v] = depth[u] + 1;
+            next[v] = next[u];
+            prev[v] = u;
+            prev[next[u]] = v;
+            next[u] = v;
+            if (!inQueue[v]) {
+                inQueue[v] = true;
+                queue.push_back(v);
+            }
         }
     }
-    return result;
+    return length;
+}
+
+std::vector<CDouble> MCMgraph::longestPathLengths(CId rootNodeId, CDouble mu) const {
+    return this->longestPathLengths(rootNodeId, mu, nullptr);
+}
+
+std::vector<CDouble> MCMgraph::longestPathLengths(CId rootNodeId,
+                                                  const std::vector<CDouble> &mu) const {
+    return this->longestPathLengths(rootNodeId, 0.0, &mu);
+}
+
+std::map<CId, CDouble> MCMgraph::longestPaths(const CId rootNodeId) const {
+    return this->normalizedLongestPaths(rootNodeId, 0.0);
 }
 
 std::map<CId, CDouble> MCMgraph::normalizedLongestPaths(const CId rootNodeId,
                                                         const CDouble mu) const {
-    std::unique_ptr<MCMgraph> normalizedGraph = this->normalize(mu);
-    std::map<CId, CDouble> result = normalizedGraph->longestPaths(rootNodeId);
+    std::vector<CDouble> lengths = this->longestPathLengths(rootNodeId, mu);
+    std::map<CId, CDouble> result;
+    auto length = lengths.begin();
+    for (const auto &n : this->nodes) {
+        result[n.id] = *length++;
+    }
     return result;
 }
 
 std::map<CId, CDouble> MCMgraph::normalizedLongestPaths(const CId rootNodeId,
                                                         const std::map<CId, CDouble> &mu) const {
-    std::unique_ptr<MCMgraph> normalizedGraph = this->normalize(mu);
-    std::map<CId, CDouble> result = normalizedGraph->longestPaths(rootNodeId);
+    std::vector<CDouble> nodeMu;
+    nodeMu.reserve(this->nodes.size());
+    for (const auto &n : this->nodes) {
+        nodeMu.push_back(mu.at(n.id));
+    }
+    std::vector<CDouble> lengths = this->longestPathLengths(rootNodeId, nodeMu);
+    std::map<CId, CDouble> result;
+    auto length = lengths.begin();
+    for (const auto &n : this->nodes) {
+        result[n.id] = *length++;
+    }
     return result;
 }
 
+/**
+ * reachableMCMgraph ()
+ * The function returns the MCM graph of the states of an FSM that are
+ * reachable from its initial states, with the given weight and delay of every
+ * edge.
+ */
+MCMgraph reachableMCMgraph(const FSM::Abstract::FiniteStateMachine &fsm,
+                           const std::function<CDouble(const FSM::Abstract::Edge &)> &weight,
+                           const std::function<CDouble(const FSM::Abstract::Edge &)> &delay,
+                           std::vector<const FSM::Abstract::State *> *states) {
+    // find the reachable states, which explores the FSM if it is computed on the fly
+    struct Visitor : FSM::Abstract::SearchVisitor {
+        std::vector<FSM::Abstract::StateRef> found;
+        void onEnterState(FSM::Abstract::StateRef s) { this->found.push_back(s); }
+    };
+    Visitor visitor;
+    FSM::Abstract::breadthFirstSearch(fsm, fsm.getInitialStates(), visitor);
+
+    MCMgraph g;
+    std::unordered_map<FSM::Abstract::StateRef, MCMnode *> nodeMap;
+    CId nId = 0;
+    for (const auto *s : visitor.found) {
+        nodeMap[s] = g.addNode(nId++);
+    }
+    CId eId = 0;
+    for (const auto *s : visitor.found) {
+        for (const auto *e : s->getOutgoingEdges()) {
+            g.addEdge(eId++,
+                      *nodeMap[s],
+                      *nodeMap[e->getDestination()],
+                      weight(*e),
+                      delay(*e));
+        }
+    }
+    if (states != nullptr) {
+        *states = std::move(visitor.found);
+    }
+    return g;
+}
+
 } // namespace MaxPlus::Graphs
@@ -56,6 +56,7 @@
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <unordered_map>
 
 using namespace MaxPlus;
 
@@ -73,22 +74,28 @@ class AlgHoward {
 public:
     AlgHoward(const std::vector<int> &ij,
               const std::vector<CDouble> &A,
+              const std::vector<CDouble> *D,
               int nr_nodes,
               int nr_arcs,
               std::unique_ptr<std::vector<CDouble>> *chi,
               std::unique_ptr<std::vector<CDouble>> *v,
               std::unique_ptr<std::vector<int>> *policy,
               int *nr_iterations,
-              int *nr_components) :
+              int *nr_components,
+              const std::vector<int> *initial_policy,
+              const std::vector<CDouble> *initial_bias) :
         ij(&ij),
         a(&A),
+        d(D),
         nr_nodes(nr_nodes),
         narcs(nr_arcs),
         chi(chi),
         v(v),
         pi(policy),
         NIterations(nr_iterations),
-        NComponents(nr_components) {}
+        NComponents(nr_components),
+        initial_policy(initial_policy),
+        initial_bias(initial_bias) {}
 
     void Run() {
 
@@ -103,6 +110,7 @@ public:
         Allocate_Memory();
         Epsilon(&epsilon);
         Initial_Policy();
+        Warm_Start();
         New_Build_Inverse();
 
         do { // NOLINT(*avoid-do-while)
@@ -119,6 +127,8 @@ public:
 private:
     const std::vector<int> *ij;
     const std::vector<CDouble> *a;
+    /* transit times of the arcs, or nullptr if all transit times are one */
+    const std::vector<CDouble> *d;
     int nr_nodes;
     int narcs;
     std::unique_ptr<std::vector<CDouble>> *chi;
@@ -126,6 +136,8 @@ private:
     std::unique_ptr<std::vector<int>> *pi;
     int *NIterations;
     int *NComponents;
+    const std::vector<int> *initial_policy;
+    const std::vector<CDouble> *initial_bias;
 
     std::unique_ptr<std::vector<int>> new_pi =
             std::make_unique<std::vector<int>>(); /*  new policy */
@@ -144,15 +156,25 @@ private:
     std::vector<int> pi_inv_last;
 
     std::vector<CDouble> c;
+    std::vector<CDouble> ct;
     std::vector<CDouble> v_aux;
     std::vector<CDouble> new_c;
+    std::vector<CDouble> new_ct;
     std::vector<CDouble> new_chi;
     std::vector<int> visited;
     std::vector<int> component;
+    std::vector<int> label_stack;
     CDouble lambda = 0;
     CDouble epsilon = 0;
     int color = 1;
 
+    /**
+     * Transit ()
+     * The transit time of arc k; one if no transit times are given, i.e., if
+     * the algorithm computes cycle means rather than cycle ratios.
+     */
+    [[nodiscard]] CDouble Transit(size_t k) const { return d == nullptr ? 1.0 : (*d)[k]; }
+
     /**
      * Epsilon ()
      * The termination tests are performed up to an epsilon constant, which is fixed
@@ -188,11 +210,53 @@ private:
             if (v_aux[(*ij)[i * 2]] <= (*a)[i]) {
                 (**pi)[(*ij)[i * 2]] = (*ij)[(i * 2) + 1];
                 c[(*ij)[i * 2]] = (*a)[i];
+                ct[(*ij)[i * 2]] = Transit(i);
                 v_aux[(*ij)[i * 2]] = (*a)[i];
             }
         }
     }
 
+    /**
+     * Warm_Start
+     * Replace the greedy policy by a policy provided by the caller, typically the
+     * optimal policy of an earlier run on a graph with the same structure. For
+     * every node the arc to the successor prescribed by the initial policy is
+     * taken (the one with maximal weight if there are parallel arcs). Nodes for
+     * which the prescribed arc does not exist keep their greedy choice. If an
+     * initial bias is provided, it is used as the value of the nodes on the
+     * cycles of the first policy, such that the bias vector stays aligned with
+     * the previous run.
+     */
+    void Warm_Start() {
+        if (initial_policy != nullptr && initial_policy->size() == static_cast<size_t>(nr_nodes)) {
+            /* we use the auxiliary variable visited to mark the nodes of which the
+               prescribed arc has been found */
+            for (int i = 0; i < nr_nodes; i++) {
+                visited[i] = 0;
+            }
+            for (size_t i = 0; i < static_cast<size_t>(narcs); i++) {
+                int src = (*ij)[i * 2];
+                int dst = (*ij)[(i * 2) + 1];
+                if ((*initial_policy)[src] == dst) {
+                    if (visited[src] == 0 || c[src] <= (*a)[i]) {
+                        (**pi)[src] = dst;
+                        c[src] = (*a)[i];
+                        ct[src] = Transit(i);
+                        visited[src] = 1;
+                    }
+                }
+            }
+            for (int i = 0; i < nr_nodes; i++) {
+                v_aux[i] = 0.0;
+            }
+        }
+        if (initial_bias != nullptr && initial_bias->size() == static_cast<size_t>(nr_nodes)) {
+            for (int i = 0; i < nr_nodes; i++) {
+                v_aux[i] = (*initial_bias)[i];
+            }
+        }
+    }
+
     void New_Build_Inverse() {
         int ptr = 0;
 
@@ -230,24 +294,31 @@ private:
     /**
      *
      * Given the value of v at initial point i, we compute v[j] for all predecessor
-     * j of i, according to the spectral equation, v[j]+ lambda = A(arc from j to i)
-     * v[i] the array visited is changed by side effect.
+     * j of i, according to the spectral equation, v[j]+ lambda*T(arc from j to i) =
+     * A(arc from j to i) + v[i] the array visited is changed by side effect.
+     * The search uses an explicit stack, since the policy trees may be deep.
      */
-    void New_Depth_First_Label(int i) { // NOLINT(*no-recursion)
-        int a = pi_inv_idx[i];
-        while (a != -1 && visited[pi_inv_elem[a]] == 0) {
-            int next_i = pi_inv_elem[a];
-            visited[next_i] = 1;
-            (**v)[next_i] = -lambda + c[next_i] + (**v)[i];
-            component[next_i] = color;
-            (**chi)[next_i] = lambda;
-            New_Depth_First_Label(next_i);
-            a = pi_inv_succ[a];
+    void New_Depth_First_Label(int i) {
+        label_stack.clear();
+        label_stack.push_back(i);
+        while (!label_stack.empty()) {
+            int j = label_stack.back();
+            label_stack.pop_back();
+            for (int a = pi_inv_idx[j]; a != -1; a = pi_inv_succ[a]) {
+                int next_i = pi_inv_elem[a];
+                if (visited[next_i] == 0) {
+                    visited[next_i] = 1;
+                    (**v)[next_i] = -lambda * ct[next_i] + c[next_i] + (**v)[j];
+                    component[next_i] = color;
+                    (**chi)[next_i] = lambda;
+                    label_stack.push_back(next_i);
+                }
+            }
         }
     }
 
     void Visit_From(const int initial_point, const int color) {
-        auto pir = **pi;
+        const auto &pir = **pi;
 
         int index = initial_point;
         component[index] = color;
@@ -261,14 +332,18 @@ private:
 
         /* a cycle has been detected, since newindex is already visited */
         CDouble weight = 0;
-        int length = 0;
+        CDouble length = 0;
         int i = index;
         do { // NOLINT(*avoid-do-while)
             weight += c[i];
-            length++;
+            length += ct[i];
             i = pir[i];
         } while (i != index);
 
+        if (length <= 0.0) {
+            throw MPException("Howard: cycle with non-positive transit time.");
+        }
+
         lambda = weight / length;
         (**v)[i] = v_aux[i]; /* keeping the previous value */
         (**chi)[i] = lambda;
@@ -302,6 +377,7 @@ private:
             v_aux[i] = (**v)[i];
             (*new_pi)[i] = (**pi)[i];
             new_c[i] = c[i];
+            new_ct[i] = ct[i];
         }
     }
 
@@ -312,23 +388,26 @@ private:
                 (*new_pi)[(*ij)[i * 2]] = (*ij)[(i * 2) + 1];
                 new_chi[(*ij)[i * 2]] = (**chi)[(*ij)[(i * 2) + 1]];
                 new_c[(*ij)[i * 2]] = (*a)[i];
+                new_ct[(*ij)[i * 2]] = Transit(i);
             }
         }
     }
 
     void Second_Order_Improvement(bool *improved) {
-        auto chir = **chi;
-        auto vr = **v;
+        const auto &chir = **chi;
+        const auto &vr = **v;
         if (*NComponents > 1) {
             for (size_t i = 0; i < narcs; i++) {
                 /* arc i is critical */
                 if (chir[(*ij)[(i * 2) + 1]] == new_chi[(*ij)[i * 2]]) {
-                    CDouble w = (*a)[i] + vr[(*ij)[(i * 2) + 1]] - chir[(*ij)[(i * 2) + 1]];
+                    CDouble w = (*a)[i] + vr[(*ij)[(i * 2) + 1]]
+                                - chir[(*ij)[(i * 2) + 1]] * Transit(i);
                     if (w > v_aux[(*ij)[i * 2]] + epsilon) {
                         *improved = true;
                         v_aux[(*ij)[i * 2]] = w;
                         (*new_pi)[(*ij)[i * 2]] = (*ij)[(i * 2) + 1];
                         new_c[(*ij)[i * 2]] = (*a)[i];
+                        new_ct[(*ij)[i * 2]] = Transit(i);
                     }
                 }
             }
@@ -336,12 +415,14 @@ private:
             /* we know that all the arcs realize the max in the
             first order improvement */
             for (size_t i = 0; i < narcs; i++) {
-                CDouble w = (*a)[i] + vr[(*ij)[(i * 2) + 1]] - chir[(*ij)[(i * 2) + 1]];
+                CDouble w = (*a)[i] + vr[(*ij)[(i * 2) + 1]]
+                            - chir[(*ij)[(i * 2) + 1]] * Transit(i);
                 if (w > v_aux[(*ij)[i * 2]] + epsilon) {
                     *improved = true;
                     v_aux[(*ij)[i * 2]] = w;
                     (*new_pi)[(*ij)[i * 2]] = (*ij)[(i * 2) + 1];
                     new_c[(*ij)[i * 2]] = (*a)[i];
+                    new_ct[(*ij)[i * 2]] = Transit(i);
                 }
             }
         }
@@ -370,7 +451,9 @@ private:
         visited.resize(nr_nodes);
         component.resize(nr_nodes);
         c.resize(nr_nodes);
+        ct.resize(nr_nodes);
         new_c.resize(nr_nodes);
+        new_ct.resize(nr_nodes);
         v_aux.resize(nr_nodes);
         new_chi.resize(nr_nodes);
     }
@@ -407,6 +490,7 @@ private:
         for (int i = 0; i < nr_nodes; i++) {
             (**pi)[i] = (*new_pi)[i];
             c[i] = new_c[i];
+            ct[i] = new_ct[i];
             v_aux[i] = (**v)[i]; /* Keep a copy of the current value function */
         }
     }
@@ -454,6 +538,12 @@ private:
  * int nr_iterations; the number of iterations of the algorithm
  * int nr_components; the number of connected components of the optimal
  *               policy which is returned.
+ *
+ * OPTIONAL INPUT VARIABLES
+ * int *initial_policy; array of integer of size nr_nodes (a policy to start
+ *               from, e.g., the policy of an earlier run)
+ * CDouble *initial_bias; array of CDouble of size nr_nodes (the bias vector
+ *               belonging to initial_policy)
  */
 
 
@@ -466,12 +556,67 @@ void Howard(const std::vector<int> &ij,
             std::unique_ptr<std::vector<CDouble>> *v,
             std::unique_ptr<std::vector<int>>(*policy),
             int *nr_iterations,
-            int *nr_components) {
+            int *nr_components,
+            const std::vector<int> *initial_policy,
+            const std::vector<CDouble> *initial_bias) {
+
+    *nr_iterations = 0;
+
+    AlgHoward AH(ij,
+                 A,
+                 nullptr,
+                 nr_nodes,
+                 nr_arcs,
+                 chi,
+                 v,
+                 policy,
+                 nr_iterations,
+                 nr_components,
+                 initial_policy,
+                 initial_bias);
+    AH.Run();
+}
+
+/**
+ * HowardRatio ()
+ * Howard Policy Iteration Algorithm for the maximum cycle ratio. It is
+ * identical to Howard (), except that the value of a policy is determined
+ * from the cycle ratios A/D instead of the cycle means, i.e., the policy
+ * iteration is performed on the arc weights A - chi * D.
+ *
+ * ADDITIONAL INPUT VARIABLES
+ * CDouble *D;     array of CDouble of size narcs
+ *                D[k]=transit time of the arc numbered k
+ *
+ * Every cycle in the graph must have a positive transit time.
+ */
+void HowardRatio(const std::vector<int> &ij,
+                 const std::vector<CDouble> &A,
+                 const std::vector<CDouble> &D,
+                 int nr_nodes,
+                 int nr_arcs,
+                 std::unique_ptr<std::vector<CDouble>> *chi,
+                 std::unique_ptr<std::vector<CDouble>> *v,
+                 std::unique_ptr<std::vector<int>> *policy,
+                 int *nr_iterations,
+                 int *nr_components,
+                 const std::vector<int> *initial_policy,
+                 const std::vector<CDouble> *initial_bias) {
 
-    bool improved = false;
     *nr_iterations = 0;
 
-    AlgHoward AH(ij, A, nr_nodes, nr_arcs, chi, v, policy, nr_iterations, nr_components);
+    AlgHoward AH(ij,
+                 A,
+                 &D,
+                 nr_nodes,
+                 nr_arcs,
+                 chi,
+                 v,
+                 policy,
+                 nr_iterations,
+                 nr_components,
+                 initial_policy,
+                 initial_bias);
     AH.Run();
 }
 
@@ -516,7 +661,28 @@ void convertMCMgraphToMatrix(MCMgraph &g,
     }
 }
 
-CDouble maximumCycleMeanHoward(MCMgraph &g, MCMnode **criticalNode) {
+namespace {
+
+/**
+ * findPolicyCycle ()
+ * Follows the policy pi from node i until it reaches the cycle of the policy
+ * and returns a node on that cycle.
+ */
+int findPolicyCycle(const std::vector<int> &pi, int i) {
+    std::vector<bool> onPath(pi.size(), false);
+    while (!onPath[i]) {
+        onPath[i] = true;
+        i = pi[i];
+    }
+    return i;
+}
+
+} // namespace
+
+CDouble maximumCycleMeanHoward(MCMgraph &g,
+                               MCMnode **criticalNode,
+                               std::vector<int> *policy,
+                               std::vector<CDouble> *bias) {
 
     if (g.numberOfNodes() == 0) {
         if (criticalNode != nullptr) {
@@ -529,65 +695,336 @@ CDouble maximumCycleMeanHoward(MCMgraph &g, MCMnode **criticalNode) {
     std::unique_ptr<std::vector<CDouble>> A = nullptr;
     std::unique_ptr<std::vector<CDouble>> chi = nullptr;
     std::unique_ptr<std::vector<CDouble>> v = nullptr;
-    std::unique_ptr<std::vector<int>> policy = nullptr;
+    std::unique_ptr<std::vector<int>> pi = nullptr;
     int nr_iterations = 0;
     int nr_components = 0;
 
     convertMCMgraphToMatrix(g, &ij, &A);
 
+    // use the policy and bias of an earlier run as a starting point, if available
+    const std::vector<int> *initialPolicy =
+            (policy != nullptr && !policy->empty()) ? policy : nullptr;
+    const std::vector<CDouble> *initialBias = (bias != nullptr && !bias->empty()) ? bias : nullptr;
+
     Howard(*ij,
            *A,
            static_cast<int>(g.numberOfNodes()),
            static_cast<int>(g.numberOfEdges()),
            &chi,
            &v,
-           &policy,
+           &pi,
            &nr_iterations,
-           &nr_components);
+           &nr_components,
+           initialPolicy,
+           initialBias);
 
     // find maximum cycle mean in chi vector
-    MCMnodes &nodes = g.getNodes();
-    auto n = nodes.begin();
-    CDouble mcm = chi->at(0);
-    MCMnode *critNode = &(*n);
-    for (auto &val : *chi) {
-        if (val > mcm) {
-            mcm = val;
-            critNode = &(*n);
-            n++;
+    int critNode = 0;
+    for (size_t i = 1; i < chi->size(); i++) {
+        if ((*chi)[i] > (*chi)[critNode]) {
+            critNode = static_cast<int>(i);
         }
     }
+    CDouble mcm = (*chi)[critNode];
 
+    if (policy != nullptr) {
+        *policy = *pi;
+    }
+    if (bias != nullptr) {
+        *bias = *v;
+    }
     if (criticalNode != nullptr) {
-        (*criticalNode) = &(*n);
+        // the node with the maximal chi may lie on a path into the critical
+        // cycle; follow the policy onto the cycle. The matrix numbers the
+        // visible nodes in order.
+        int k = findPolicyCycle(*pi, critNode);
+        for (auto &n : g.getNodes()) {
+            if (n.visible && k-- == 0) {
+                (*criticalNode) = &n;
+                break;
+            }
+        }
     }
     return mcm;
 }
 
-CDouble maximumCycleMeanHowardGeneral(MCMgraph &g, MCMnode **criticalNode) {
+/**
+ * convertMCMgraphToTrimmedMatrix ()
+ * The function converts the visible part of an arbitrary graph into a sparse
+ * matrix input for Howard's algorithm. Nodes that cannot reach a cycle are
+ * repeatedly removed, since they do not contribute to the maximum cycle mean
+ * or ratio and Howard's algorithm requires every node to have a successor.
+ * The remaining nodes and the edges corresponding to the arcs are returned
+ * in nodes and arcs respectively.
+ */
+void convertMCMgraphToTrimmedMatrix(MCMgraph &g,
+                                    std::vector<MCMnode *> *nodes,
+                                    std::vector<const MCMedge *> *arcs,
+                                    std::vector<int> *ij,
+                                    std::vector<CDouble> *A,
+                                    std::vector<CDouble> *D) {
+    // index the visible nodes
+    std::vector<MCMnode *> visibleNodes;
+    std::unordered_map<const MCMnode *, int> nodeIndex;
+    for (auto &n : g.getNodes()) {
+        if (n.visible) {
+            nodeIndex[&n] = static_cast<int>(visibleNodes.size());
+            visibleNodes.push_back(&n);
+        }
+    }
+
+    auto isArc = [&nodeIndex](const MCMedge *e) {
+        return e->visible && nodeIndex.count(e->src) > 0 && nodeIndex.count(e->dst) > 0;
+    };
+
+    // repeatedly remove the nodes without outgoing arcs
+    std::vector<int> outDegree(visibleNodes.size(), 0);
+    std::vector<int> deadEnds;
+    for (size_t i = 0; i < visibleNodes.size(); i++) {
+        for (const auto *e : visibleNodes[i]->out) {
+            if (isArc(e)) {
+                outDegree[i]++;
+            }
+        }
+        if (outDegree[i] == 0) {
+            deadEnds.push_back(static_cast<int>(i));
+        }
+    }
+    while (!deadEnds.empty()) {
+        int i = deadEnds.back();
+        deadEnds.pop_back();
+        for (const auto *e : visibleNodes[i]->in) {
+            if (isArc(e)) {
+                int src = nodeIndex[e->src];
+                if (outDegree[src] > 0 && --outDegree[src] == 0) {
+                    deadEnds.push_back(src);
+                }
+            }
+        }
+    }
+
+    // number the remaining nodes and collect the arcs between them
+    std::vector<int> index(visibleNodes.size(), -1);
+    nodes->clear();
+    for (size_t i = 0; i < visibleNodes.size(); i++) {
+        if (outDegree[i] > 0) {
+            index[i] = static_cast<int>(nodes->size());
+            nodes->push_back(visibleNodes[i]);
+        }
+    }
+
+    arcs->clear();
+    ij->clear();
+    A->clear();
+    D->clear();
+    for (const auto *n : *nodes) {
+        for (const auto *e : n->out) {
+            if (isArc(e) && index[nodeIndex[e->dst]] >= 0) {
+                ij->push_back(index[nodeIndex[e->src]]);
+                ij->push_back(index[nodeIndex[e->dst]]);
+                A->push_back(e->w);
+                D->push_back(e->d);
+                arcs->push_back(e);
+            }
+        }
+    }
+}
 
-    MCMgraphs sccs;
-    stronglyConnectedMCMgraph(g, sccs, false);
+/**
+ * findZeroTransitCycle ()
+ * Determines if the arcs with zero transit time contain a cycle, by
+ * attempting to sort them topologically. If so, the arcs of such a cycle are
+ * returned in cycle.
+ */
+bool findZeroTransitCycle(const std::vector<int> &ij,
+                          const std::vector<CDouble> &D,
+                          int nr_nodes,
+                          std::vector<int> *cycle) {
+    std::vector<int> inDegree(nr_nodes, 0);
+    std::vector<std::vector<int>> successors(nr_nodes);
+    std::vector<int> predecessorArc(nr_nodes, -1);
+    for (size_t k = 0; k < D.size(); k++) {
+        if (D[k] <= 0.0) {
+            successors[ij[2 * k]].push_back(ij[(2 * k) + 1]);
+            inDegree[ij[(2 * k) + 1]]++;
+        }
+    }
+
+    std::vector<int> queue;
+    for (int i = 0; i < nr_nodes; i++) {
+        if (inDegree[i] == 0) {
+            queue.push_back(i);
+        }
+    }
+    size_t head = 0;
+    while (head < queue.size()) {
+        int i = queue[head++];
+        for (int j : successors[i]) {
+            if (--inDegree[j] == 0) {
+                queue.push_back(j);
+            }
+        }
+    }
+    if (queue.size() == static_cast<size_t>(nr_nodes)) {
+        return false;
+    }
+
+    // Every node that was not sorted has a zero transit predecessor that was not
+    // sorted either. Walking backwards along those, we must end up in a cycle.
+    for (size_t k = 0; k < D.size(); k++) {
+        if (D[k] <= 0.0 && inDegree[ij[2 * k]] > 0) {
+            predecessorArc[ij[(2 * k) + 1]] = static_cast<int>(k);
+        }
+    }
+    int i = 0;
+    while (inDegree[i] == 0) {
+        i++;
+    }
+    std::vector<bool> seen(nr_nodes, false);
+    while (!seen[i]) {
+        seen[i] = true;
+        i = ij[2 * predecessorArc[i]];
+    }
+    cycle->clear();
+    int j = i;
+    do { // NOLINT(*avoid-do-while)
+        cycle->push_back(predecessorArc[j]);
+        j = ij[2 * predecessorArc[j]];
+    } while (j != i);
+    std::reverse(cycle->begin(), cycle->end());
+    return true;
+}
+
+CDouble maximumCycleMeanHowardGeneral(MCMgraph &g, MCMnode **criticalNode) {
 
-    CDouble mcm = static_cast<CDouble>(-INFINITY);
     if (criticalNode != nullptr) {
         *criticalNode = nullptr;
     }
-    for (auto &scc : sccs) {
-        std::map<CId, CId> nodeMap;
-        scc->relabelNodeIds(&nodeMap);
-        MCMnode *sccCriticalNode = nullptr;
-        
-        CDouble c_mcm = maximumCycleMeanHoward(*scc, &sccCriticalNode);
-        if (c_mcm > mcm) {
-            mcm = c_mcm;
-            if (criticalNode != nullptr) {
-                *criticalNode = g.getNode(nodeMap[sccCriticalNode->id]);
+
+    std::vector<MCMnode *> nodes;
+    std::vector<const MCMedge *> arcs;
+    std::vector<int> ij;
+    std::vector<CDouble> A;
+    std::vector<CDouble> D;
+    convertMCMgraphToTrimmedMatrix(g, &nodes, &arcs, &ij, &A, &D);
+    if (nodes.empty()) {
+        return -INFINITY;
+    }
+
+    std::unique_ptr<std::vector<CDouble>> chi = nullptr;
+    std::unique_ptr<std::vector<CDouble>> v = nullptr;
+    std::unique_ptr<std::vector<int>> pi = nullptr;
+    int nr_iterations = 0;
+    int nr_components = 0;
+
+    Howard(ij,
+           A,
+           static_cast<int>(nodes.size()),
+           static_cast<int>(arcs.size()),
+           &chi,
+           &v,
+           &pi,
+           &nr_iterations,
+           &nr_components);
+
+    // find maximum cycle mean in chi vector
+    int critNode = 0;
+    for (size_t i = 1; i < nodes.size(); i++) {
+        if ((*chi)[i] > (*chi)[critNode]) {
+            critNode = static_cast<int>(i);
+        }
+    }
+
+    if (criticalNode != nullptr) {
+        *criticalNode = nodes[findPolicyCycle(*pi, critNode)];
+    }
+    return (*chi)[critNode];
+}
+
+CDouble maximumCycleRatioHoward(MCMgraph &g, std::vector<const MCMedge *> *cycle) {
+
+    if (cycle != nullptr) {
+        cycle->clear();
+    }
+
+    std::vector<MCMnode *> nodes;
+    std::vector<const MCMedge *> arcs;
+    std::vector<int> ij;
+    std::vector<CDouble> A;
+    std::vector<CDouble> D;
+    convertMCMgraphToTrimmedMatrix(g, &nodes, &arcs, &ij, &A, &D);
+    auto nr_nodes = static_cast<int>(nodes.size());
+    if (nr_nodes == 0) {
+        return -INFINITY;
+    }
+
+    // The ratio of a cycle without delay is unbounded
+    std::vector<int> zeroCycle;
+    if (findZeroTransitCycle(ij, D, nr_nodes, &zeroCycle)) {
+        if (cycle != nullptr) {
+            for (int k : zeroCycle) {
+                cycle->push_back(arcs[k]);
             }
         }
+        return INFINITY;
     }
 
-    return mcm;
+    std::unique_ptr<std::vector<CDouble>> chi = nullptr;
+    std::unique_ptr<std::vector<CDouble>> v = nullptr;
+    std::unique_ptr<std::vector<int>> pi = nullptr;
+    int nr_iterations = 0;
+    int nr_components = 0;
+
+    HowardRatio(ij,
+                A,
+                D,
+                nr_nodes,
+                static_cast<int>(arcs.size()),
+                &chi,
+                &v,
+                &pi,
+                &nr_iterations,
+                &nr_components);
+
+    // find maximum cycle ratio in chi vector
+    int critNode = 0;
+    for (int i = 1; i < nr_nodes; i++) {
+        if ((*chi)[i] > (*chi)[critNode]) {
+            critNode = i;
+        }
+    }
+    CDouble mcr = (*chi)[critNode];
+
+    if (cycle != nullptr) {
+        int i = findPolicyCycle(*pi, critNode);
+
+        // for every node on the cycle select the arc that realizes the policy
+        std::vector<bool> onCycle(nr_nodes, false);
+        int j = i;
+        do { // NOLINT(*avoid-do-while)
+            onCycle[j] = true;
+            j = (*pi)[j];
+        } while (j != i);
+
+        std::vector<int> policyArc(nr_nodes, -1);
+        for (size_t k = 0; k < arcs.size(); k++) {
+            int src = ij[2 * k];
+            if (onCycle[src] && ij[(2 * k) + 1] == (*pi)[src]) {
+                int best = policyArc[src];
+                if (best < 0 || A[k] - mcr * D[k] > A[best] - mcr * D[best]) {
+                    policyArc[src] = static_cast<int>(k);
+                }
+            }
+        }
+
+        j = i;
+        do { // NOLINT(*avoid-do-while)
+            cycle->push_back(arcs[policyArc[j]]);
+            j = (*pi)[j];
+        } while (j != i);
+    }
+
+    return mcr;
 }
 
-} // namespace MaxPlus::Graphs
\ No newline at end of file
+} // namespace MaxPlus::Graphs
@@ -0,0 +1,421 @@
+/*
+ *  Eindhoven University of Technology
+ *  Eindhoven, The Netherlands
+ *  Dept. of Electrical Engineering
+ *  Electronics Systems Group
+ *  Model Based Design Lab (https://computationalmodeling.info/)
+ *
+ *  Name            :   mcmincremental.cc
+ *
+ *  Function        :   Maintain the maximum cycle mean or ratio of a graph
+ *                      under edge updates.
+ *
+ *  Copyright 2023 Eindhoven University of Technology
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the “Software”),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included
+ *  in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ */
+
+#include "base/analysis/mcm/mcmincremental.h"
+#include "base/analysis/mcm/mcmhoward.h"
+#include "base/exception/exception.h"
+#include <algorithm>
+#include <memory>
+
+namespace MaxPlus::Graphs {
+
+namespace {
+
+// relative tolerance of the optimality tests, as in Howard's algorithm
+constexpr CDouble EPSILON_FACTOR = 0.000000001;
+
+} // namespace
+
+IncrementalMCM::IncrementalMCM(MCMgraph &g, bool ratio) : ratio(ratio) {
+    for (const auto &n : g.getNodes()) {
+        if (n.visible) {
+            this->nodeIndex[n.id] = static_cast<int>(this->out.size());
+            this->out.emplace_back();
+            this->in.emplace_back();
+        }
+    }
+    for (const auto &e : g.getEdges()) {
+        auto s = this->nodeIndex.find(e.src->id);
+        auto t = this->nodeIndex.find(e.dst->id);
+        if (e.visible && s != this->nodeIndex.end() && t != this->nodeIndex.end()) {
+            this->newEdge(e.id, s->second, t->second, e.w, e.d);
+        }
+    }
+    if (this->out.empty()) {
+        return;
+    }
+    for (const auto &o : this->out) {
+        if (o.empty()) {
+            throw MPException("IncrementalMCM: every node must have an outgoing edge.");
+        }
+    }
+    this->recompute();
+}
+
+std::vector<CId> IncrementalMCM::criticalCycle() const {
+    std::vector<CId> cycle;
+    if (this->chi.empty()) {
+        return cycle;
+    }
+    // the policy path from a node with maximal cycle time ends in a critical cycle
+    int u = static_cast<int>(std::max_element(this->chi.begin(), this->chi.end())
+                             - this->chi.begin());
+    while (!this->onCycle[u]) {
+        u = this->dst[this->policy[u]];
+    }
+    int x = u;
+    do { // NOLINT(*avoid-do-while)
+        cycle.push_back(this->edgeId[this->policy[x]]);
+        x = this->dst[this->policy[x]];
+    } while (x != u);
+    return cycle;
+}
+
+CDouble IncrementalMCM::setWeight(CId id, CDouble weight) {
+    auto it = this->edgeIndex.find(id);
+    if (it == this->edgeIndex.end()) {
+        throw MPException("IncrementalMCM: unknown edge.");
+    }
+    const int e = it->second;
+    const int u = this->src[e];
+    const CDouble delta = weight - this->w[e];
+    this->w[e] = weight;
+    if (delta == 0.0) {
+        return this->mcm;
+    }
+
+    this->work = 0;
+    std::vector<int> violations;
+    if (this->policy[u] != e) {
+        // a cheaper edge that is not used cannot become better
+        if (delta < 0.0 || !this->violates(e)) {
+            return this->mcm;
+        }
+        violations.push_back(e);
+    } else if (this->onCycle[u] || !this->shiftPolicyTree(u, delta, -1, violations)) {
+        // the policy edge of u is on a cycle, so the cycle time changes
+        return this->recompute();
+    }
+    return this->repair(violations) ? this->mcm : this->recompute();
+}
+
+CDouble IncrementalMCM::insertEdge(CId id, CId srcId, CId dstId, CDouble weight, CDouble delay) {
+    auto s = this->nodeIndex.find(srcId);
+    auto t = this->nodeIndex.find(dstId);
+    if (s == this->nodeIndex.end() || t == this->nodeIndex.end()) {
+        throw MPException("IncrementalMCM: unknown node.");
+    }
+    const int e = this->newEdge(id, s->second, t->second, weight, delay);
+    if (!this->violates(e)) {
+        return this->mcm;
+    }
+    this->work = 0;
+    std::vector<int> violations = {e};
+    return this->repair(violations) ? this->mcm : this->recompute();
+}
+
+CDouble IncrementalMCM::removeEdge(CId id) {
+    auto it = this->edgeIndex.find(id);
+    if (it == this->edgeIndex.end()) {
+        throw MPException("IncrementalMCM: unknown edge.");
+    }
+    const int e = it->second;
+    const int u = this->src[e];
+    if (this->out[u].size() == 1) {
+        throw MPException("IncrementalMCM: cannot remove the last outgoing edge of a node.");
+    }
+
+    auto &o = this->out[u];
+    o.erase(std::find(o.begin(), o.end(), e));
+    auto &i = this->in[this->dst[e]];
+    i.erase(std::find(i.begin(), i.end(), e));
+    this->edgeIndex.erase(it);
+    this->alive[e] = false;
+    this->freeEdges.push_back(e);
+
+    if (this->policy[u] != e) {
+        return this->mcm;
+    }
+
+    // replace the policy edge of u by the best remaining edge
+    int best = -1;
+    CDouble bestChi = -INFINITY;
+    CDouble bestValue = -INFINITY;
+    for (int f : this->out[u]) {
+        const int t = this->dst[f];
+        const CDouble value = this->w[f] - (this->chi[t] * this->transit(f)) + this->v[t];
+        if (this->chi[t] > bestChi + this->epsilon
+            || (this->chi[t] >= bestChi - this->epsilon && value > bestValue)) {
+            best = f;
+            bestChi = this->chi[t];
+            bestValue = value;
+        }
+    }
+    this->setPolicy(u, best);
+
+    // the policy cycle through u is broken, or u ends up in a component with a
+    // different cycle time
+    const int z = this->dst[best];
+    this->work = 0;
+    std::vector<int> violations;
+    if (this->onCycle[u] || this->chi[z] < this->chi[u] - this->epsilon
+        || !this->shiftPolicyTree(u, bestValue - this->v[u], z, violations)) {
+        return this->recompute();
+    }
+    return this->repair(violations) ? this->mcm : this->recompute();
+}
+
+/**
+ * violates ()
+ * Checks if edge e violates the optimality conditions of the policy, i.e.,
+ * if it leads to a node with a larger cycle time, or to a node with the same
+ * cycle time with a larger value than the policy edge of its source.
+ */
+bool IncrementalMCM::violates(int e) const {
+    const int i = this->src[e];
+    const int j = this->dst[e];
+    if (this->chi[j] > this->chi[i] + this->epsilon) {
+        return true;
+    }
+    if (this->chi[j] < this->chi[i] - this->epsilon) {
+        return false;
+    }
+    return this->w[e] - (this->chi[j] * this->transit(e)) + this->v[j] > this->v[i] + this->epsilon;
+}
+
+/**
+ * policyTree ()
+ * The nodes of which the policy path passes through u, including u. Only u
+ * may be on a policy cycle, its policy edge may just have been changed.
+ */
+std::vector<int> IncrementalMCM::policyTree(int u) const {
+    std::vector<int> tree = {u};
+    for (size_t k = 0; k < tree.size(); k++) {
+        for (int x : this->policyIn[tree[k]]) {
+            if (x != u) {
+                tree.push_back(x);
+            }
+        }
+    }
+    return tree;
+}
+
+/**
+ * shiftPolicyTree ()
+ * Add delta to the bias of all nodes whose policy path passes through u and
+ * collect the edges between these nodes and the rest of the graph that
+ * violate the optimality conditions. Returns false if the node avoid, the new
+ * policy successor of u, is in the tree, i.e., if a new policy cycle is formed.
+ */
+bool IncrementalMCM::shiftPolicyTree(int u, CDouble delta, int avoid, std::vector<int> &violations) {
+    const std::vector<int> tree = this->policyTree(u);
+    this->work += tree.size();
+    this->mark.resize(this->out.size(), false);
+    for (int x : tree) {
+        this->mark[x] = true;
+        this->v[x] += delta;
+    }
+
+    const bool acyclic = avoid == -1 || !this->mark[avoid];
+    for (int x : tree) {
+        // a lower bias makes edges leaving the tree attractive, a higher
+        // bias makes edges entering the tree attractive
+        if (delta < 0.0) {
+            for (int e : this->out[x]) {
+                if (!this->mark[this->dst[e]] && this->violates(e)) {
+                    violations.push_back(e);
+                }
+            }
+        } else {
+            for (int e : this->in[x]) {
+                if (!this->mark[this->src[e]] && this->violates(e)) {
+                    violations.push_back(e);
+                }
+            }
+        }
+    }
+
+    for (int x : tree) {
+        this->mark[x] = false;
+    }
+    return acyclic;
+}
+
+/**
+ * repair ()
+ * Local policy improvement. Every violating edge between nodes with the same
+ * cycle time becomes the policy edge of its source, which raises the bias of
+ * the policy tree of that source. Returns false if the cycle times change, a
+ * new policy cycle is formed, or the repair touches more nodes than the graph
+ * has; Howard's algorithm then has to be rerun.
+ */
+bool IncrementalMCM::repair(std::vector<int> &violations) {
+    while (!violations.empty()) {
+        const int e = violations.back();
+        violations.pop_back();
+        if (!this->alive[e] || !this->violates(e)) {
+            continue;
+        }
+        const int i = this->src[e];
+        const int j = this->dst[e];
+        if (this->chi[j] > this->chi[i] + this->epsilon || this->onCycle[i]) {
+            return false;
+        }
+        const CDouble delta = this->w[e] - (this->chi[j] * this->transit(e)) + this->v[j] - this->v[i];
+        this->setPolicy(i, e);
+        if (!this->shiftPolicyTree(i, delta, j, violations) || this->work > this->out.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void IncrementalMCM::setPolicy(int u, int e) {
+    if (this->policy[u] != -1) {
+        auto &pin = this->policyIn[this->dst[this->policy[u]]];
+        pin.erase(std::find(pin.begin(), pin.end(), u));
+    }
+    this->policy[u] = e;
+    this->policyIn[this->dst[e]].push_back(u);
+}
+
+int IncrementalMCM::newEdge(CId id, int s, int t, CDouble weight, CDouble delay) {
+    if (this->edgeIndex.find(id) != this->edgeIndex.end()) {
+        throw MPException("IncrementalMCM: duplicate edge id.");
+    }
+    int e = 0;
+    if (this->freeEdges.empty()) {
+        e = static_cast<int>(this->edgeId.size());
+        this->edgeId.push_back(id);
+        this->src.push_back(s);
+        this->dst.push_back(t);
+        this->w.push_back(weight);
+        this->d.push_back(delay);
+        this->alive.push_back(true);
+    } else {
+        e = this->freeEdges.back();
+        this->freeEdges.pop_back();
+        this->edgeId[e] = id;
+        this->src[e] = s;
+        this->dst[e] = t;
+        this->w[e] = weight;
+        this->d[e] = delay;
+        this->alive[e] = true;
+    }
+    this->edgeIndex[id] = e;
+    this->out[s].push_back(e);
+    this->in[t].push_back(e);
+    return e;
+}
+
+/**
+ * recompute ()
+ * Run Howard's algorithm on the current graph, warm-started with the current
+ * policy and bias if there are any.
+ */
+CDouble IncrementalMCM::recompute() {
+    const auto n = static_cast<int>(this->out.size());
+    std::vector<int> ij;
+    std::vector<CDouble> A;
+    std::vector<CDouble> D;
+    CDouble maxW = -INFINITY;
+    CDouble minW = INFINITY;
+    for (size_t e = 0; e < this->alive.size(); e++) {
+        if (this->alive[e]) {
+            ij.push_back(this->src[e]);
+            ij.push_back(this->dst[e]);
+            A.push_back(this->w[e]);
+            D.push_back(this->d[e]);
+            maxW = std::max(maxW, this->w[e]);
+            minW = std::min(minW, this->w[e]);
+        }
+    }
+    const auto nrArcs = static_cast<int>(A.size());
+
+    const bool warm = !this->policy.empty();
+    std::vector<int> initialPolicy;
+    if (warm) {
+        initialPolicy.resize(n);
+        for (int u = 0; u < n; u++) {
+            initialPolicy[u] = this->dst[this->policy[u]];
+        }
+    }
+
+    std::unique_ptr<std::vector<CDouble>> chiOut;
+    std::unique_ptr<std::vector<CDouble>> vOut;
+    std::unique_ptr<std::vector<int>> piOut;
+    int nrIterations = 0;
+    int nrComponents = 0;
+    if (this->ratio) {
+        HowardRatio(ij, A, D, n, nrArcs, &chiOut, &vOut, &piOut, &nrIterations, &nrComponents,
+                    warm ? &initialPolicy : nullptr, warm ? &this->v : nullptr);
+    } else {
+        Howard(ij, A, n, nrArcs, &chiOut, &vOut, &piOut, &nrIterations, &nrComponents,
+               warm ? &initialPolicy : nullptr, warm ? &this->v : nullptr);
+    }
+    this->chi = std::move(*chiOut);
+    this->v = std::move(*vOut);
+    this->epsilon = (maxW - minW) * EPSILON_FACTOR;
+    this->recomputations++;
+
+    // Howard returns successor nodes; take the best of any parallel edges
+    this->policy.assign(n, -1);
+    this->policyIn.assign(n, std::vector<int>());
+    for (int u = 0; u < n; u++) {
+        const int t = (*piOut)[u];
+        int best = -1;
+        for (int e : this->out[u]) {
+            if (this->dst[e] == t
+                && (best == -1
+                    || this->w[e] - (this->chi[t] * this->transit(e))
+                               > this->w[best] - (this->chi[t] * this->transit(best)))) {
+                best = e;
+            }
+        }
+        this->setPolicy(u, best);
+    }
+
+    // mark the nodes on policy cycles
+    this->onCycle.assign(n, false);
+    std::vector<int> stamp(n, -1);
+    for (int s = 0; s < n; s++) {
+        int x = s;
+        while (stamp[x] == -1) {
+            stamp[x] = s;
+            x = this->dst[this->policy[x]];
+        }
+        if (stamp[x] == s) {
+            // x is on a new cycle
+            int y = x;
+            do { // NOLINT(*avoid-do-while)
+                this->onCycle[y] = true;
+                y = this->dst[this->policy[y]];
+            } while (y != x);
+        }
+    }
+
+    this->mcm = *std::max_element(this->chi.begin(), this->chi.end());
+    return this->mcm;
+}
+
+} // namespace MaxPlus::Graphs
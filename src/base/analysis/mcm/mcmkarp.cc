@@ -69,7 +69,7 @@ CDouble maximumCycleMeanKarp(MCMgraph &mcmGraph) {
 
     // Allocate memory d[n+1][n]
     unsigned int n = mcmGraph.nrVisibleNodes();
-    std::vector<std::vector<std::uint64_t>> d(n + 1, std::vector<std::uint64_t>(n));
+    std::vector<std::vector<std::int64_t>> d(n + 1, std::vector<std::int64_t>(n));
 
     // Initialize
     // d[k][u], 1<=k<n+1, 0<=u<n with value -inf
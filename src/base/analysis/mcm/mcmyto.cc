@@ -48,6 +48,7 @@
 
 #include "base/analysis/mcm/mcmyto.h"
 #include "base/analysis/mcm/mcmgraph.h"
+#include "base/exception/exception.h"
 #include <algorithm>
 #include <cassert>
 #include <cfloat>
@@ -908,7 +909,7 @@ public:
         }
 
         if (cycle != nullptr) {
-            *cycle = std::vector<const arc *>();
+            cycle->clear();
             if (min_a_ptr != NILA) {
                 cycle->push_back(min_a_ptr);
                 a_ptr = min_a_ptr->tail->parent_in;
@@ -1227,4 +1228,135 @@ CDouble minCycleRatioYoungTarjanOrlin(MCMgraph &mcmGraph) {
     return minCycleRatioAndCriticalCycleYoungTarjanOrlin(mcmGraph, nullptr);
 }
 
+CompiledYTOgraph::CompiledYTOgraph(MCMgraph &g) {
+    std::unordered_map<CId, std::int32_t> nodeIndex;
+    for (const auto &n : g.getNodes()) {
+        if (n.visible) {
+            auto k = static_cast<std::int32_t>(nodeIndex.size());
+            nodeIndex[n.id] = k;
+        }
+    }
+    std::vector<const MCMedge *> edges;
+    for (const auto &e : g.getEdges()) {
+        if (e.visible && nodeIndex.count(e.src->id) > 0 && nodeIndex.count(e.dst->id) > 0) {
+            edges.push_back(&e);
+        }
+    }
+
+    this->gr.n_nodes = static_cast<std::int32_t>(nodeIndex.size());
+    this->gr.n_arcs = static_cast<std::int32_t>(edges.size());
+    this->gr.nodes.resize(this->gr.n_nodes + 1);
+    this->gr.arcs.resize(this->gr.n_arcs + this->gr.n_nodes);
+    for (std::int32_t i = 0; i <= this->gr.n_nodes; i++) {
+        node &x = this->gr.nodes[i];
+        x.id = i == this->gr.n_nodes ? 0 : i + 1;
+        x.first_arc_out = nullptr;
+        x.first_arc_in = nullptr;
+    }
+
+    std::int32_t aidx = 0;
+    for (const auto *e : edges) {
+        arc &a = this->gr.arcs[aidx];
+        a.tail = &(this->gr.nodes[nodeIndex[e->src->id]]);
+        a.head = &(this->gr.nodes[nodeIndex[e->dst->id]]);
+        a.next_out = a.tail->first_arc_out;
+        a.tail->first_arc_out = &a;
+        a.next_in = a.head->first_arc_in;
+        a.head->first_arc_in = &a;
+        a.mcmEdge = nullptr;
+        this->w.push_back(e->w);
+        this->d.push_back(e->d);
+        this->edgeId.push_back(e->id);
+        this->arcIndex[e->id] = aidx;
+        aidx++;
+    }
+
+    // the source node has an edge to all nodes
+    this->gr.vs = &(this->gr.nodes[this->gr.n_nodes]);
+    for (std::int32_t i = 0; i < this->gr.n_nodes; i++) {
+        arc &a = this->gr.arcs[aidx];
+        a.cost = 0.0;
+        a.transit_time = 0.0;
+        a.tail = this->gr.vs;
+        a.head = &(this->gr.nodes[i]);
+        a.next_out = this->gr.vs->first_arc_out;
+        this->gr.vs->first_arc_out = &a;
+        a.next_in = a.head->first_arc_in;
+        a.head->first_arc_in = &a;
+        a.mcmEdge = nullptr;
+        aidx++;
+    }
+
+    this->alg = std::make_unique<AlgYTO>(this->gr);
+}
+
+CompiledYTOgraph::~CompiledYTOgraph() = default;
+
+std::int32_t CompiledYTOgraph::findArc(CId id) const {
+    auto it = this->arcIndex.find(id);
+    if (it == this->arcIndex.end()) {
+        throw MPException("The edge is not part of the compiled graph.");
+    }
+    return it->second;
+}
+
+void CompiledYTOgraph::setWeight(CId id, CDouble weight) { this->w[this->findArc(id)] = weight; }
+
+void CompiledYTOgraph::setDelay(CId id, CDouble delay) { this->d[this->findArc(id)] = delay; }
+
+CDouble CompiledYTOgraph::maximumCycleRatio(std::vector<CId> *cycle) {
+    return this->solve(Query::MaximumRatio, cycle);
+}
+
+CDouble CompiledYTOgraph::maximumCycleMean(std::vector<CId> *cycle) {
+    return this->solve(Query::MaximumMean, cycle);
+}
+
+CDouble CompiledYTOgraph::minimumCycleRatio(std::vector<CId> *cycle) {
+    return this->solve(Query::MinimumRatio, cycle);
+}
+
+/**
+ * solve ()
+ * Sets the cost and transit time of the arcs for the query and runs
+ * Young-Tarjan-Orlin's algorithm, which minimizes cost over transit time. The
+ * maxima are obtained as the inverse of the minimum of delay (or one) over
+ * weight.
+ */
+CDouble CompiledYTOgraph::solve(Query query, std::vector<CId> *cycle) {
+    if (cycle != nullptr) {
+        cycle->clear();
+    }
+    if (this->gr.n_arcs == 0) {
+        return 0.0;
+    }
+    for (std::int32_t k = 0; k < this->gr.n_arcs; k++) {
+        arc &a = this->gr.arcs[k];
+        switch (query) {
+        case Query::MaximumRatio:
+            a.cost = this->d[k];
+            a.transit_time = this->w[k];
+            break;
+        case Query::MaximumMean:
+            a.cost = 1.0;
+            a.transit_time = this->w[k];
+            break;
+        default:
+            a.cost = this->w[k];
+            a.transit_time = this->d[k];
+        }
+    }
+
+    CDouble min_cr = 0;
+    this->ytoCycle.clear();
+    this->alg->mmcycle_robust(this->gr, &min_cr, cycle != nullptr ? &this->ytoCycle : nullptr);
+    if (cycle != nullptr) {
+        // the algorithm returns the cycle following the edges backwards
+        for (auto a = this->ytoCycle.rbegin(); a != this->ytoCycle.rend(); a++) {
+            cycle->push_back(this->edgeId[*a - this->gr.arcs.data()]);
+        }
+    }
+    return query == Query::MinimumRatio ? min_cr : 1.0 / min_cr;
+}
+
 } // namespace MaxPlus::Graphs
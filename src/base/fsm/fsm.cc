@@ -39,13 +39,455 @@
  */
 
 #include "base/fsm/fsm.h"
+#include <algorithm>
 #include <memory>
+#include <numeric>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 using namespace MaxPlus;
 
 namespace MaxPlus::FSM {
 
-CId FSM::Abstract::WithUniqueID::nextID = 0;
+std::atomic<std::uint64_t> FSM::Abstract::WithUniqueID::nextID{0};
+
+namespace {
+
+// Partition of the elements 0..n-1 into blocks, which can be split on marked
+// elements (Valmari and Lehtinen). The elements of a block are consecutive in
+// elements, the marked ones in front.
+class RefinablePartition {
+public:
+    RefinablePartition(std::uint32_t n, const std::vector<std::uint32_t> &initialBlocks) :
+        elements(n), location(n), blockOf(initialBlocks) {
+        std::uint32_t nrBlocks = 0;
+        for (std::uint32_t b : initialBlocks) {
+            nrBlocks = std::max(nrBlocks, b + 1);
+        }
+        first.assign(nrBlocks + 1, 0);
+        for (std::uint32_t b : initialBlocks) {
+            first[b + 1]++;
+        }
+        std::partial_sum(first.begin(), first.end(), first.begin());
+        end.assign(first.begin() + 1, first.end());
+        first.pop_back();
+        std::vector<std::uint32_t> next = first;
+        for (std::uint32_t x = 0; x < n; x++) {
+            location[x] = next[blockOf[x]]++;
+            elements[location[x]] = x;
+        }
+        marked = first;
+    }
+
+    [[nodiscard]] std::uint32_t block(std::uint32_t x) const { return blockOf[x]; }
+
+    [[nodiscard]] std::uint32_t size(std::uint32_t b) const { return end[b] - first[b]; }
+
+    [[nodiscard]] std::uint32_t numberOfBlocks() const {
+        return static_cast<std::uint32_t>(first.size());
+    }
+
+    [[nodiscard]] const std::uint32_t *begin(std::uint32_t b) const {
+        return elements.data() + first[b];
+    }
+
+    [[nodiscard]] const std::uint32_t *finish(std::uint32_t b) const {
+        return elements.data() + end[b];
+    }
+
+    void mark(std::uint32_t x) {
+        std::uint32_t b = blockOf[x];
+        std::uint32_t i = location[x];
+        std::uint32_t j = marked[b];
+        if (i < j) {
+            return;
+        }
+        if (j == first[b]) {
+            touched.push_back(b);
+        }
+        elements[i] = elements[j];
+        location[elements[i]] = i;
+        elements[j] = x;
+        location[x] = j;
+        marked[b]++;
+    }
+
+    // split every block with marked and unmarked elements; the marked elements
+    // form the new block. onSplit is called with the old and the new block.
+    template <typename F> void split(F onSplit) {
+        for (std::uint32_t b : touched) {
+            std::uint32_t m = marked[b];
+            marked[b] = first[b];
+            if (m == end[b]) {
+                continue;
+            }
+            auto nb = static_cast<std::uint32_t>(first.size());
+            first.push_back(first[b]);
+            end.push_back(m);
+            marked.push_back(first[b]);
+            first[b] = m;
+            marked[b] = m;
+            for (std::uint32_t i = first[nb]; i < end[nb]; i++) {
+                blockOf[elements[i]] = nb;
+            }
+            onSplit(b, nb);
+        }
+        touched.clear();
+    }
+
+private:
+    std::vector<std::uint32_t> elements;
+    std::vector<std::uint32_t> location;
+    std::vector<std::uint32_t> blockOf;
+    std::vector<std::uint32_t> first;
+    std::vector<std::uint32_t> end;
+    std::vector<std::uint32_t> marked;
+    std::vector<std::uint32_t> touched;
+};
+
+// Compound blocks: a partition of the blocks, each compound a doubly linked list of blocks.
+class Compounds {
+public:
+    std::uint32_t newCompound() {
+        head.push_back(NONE);
+        count.push_back(0);
+        return static_cast<std::uint32_t>(head.size() - 1);
+    }
+
+    void add(std::uint32_t b, std::uint32_t c) {
+        if (b >= compoundOf.size()) {
+            compoundOf.resize(b + 1);
+            next.resize(b + 1);
+            previous.resize(b + 1);
+        }
+        compoundOf[b] = c;
+        previous[b] = NONE;
+        next[b] = head[c];
+        if (head[c] != NONE) {
+            previous[head[c]] = b;
+        }
+        head[c] = b;
+        count[c]++;
+    }
+
+    void remove(std::uint32_t b) {
+        std::uint32_t c = compoundOf[b];
+        if (previous[b] != NONE) {
+            next[previous[b]] = next[b];
+        } else {
+            head[c] = next[b];
+        }
+        if (next[b] != NONE) {
+            previous[next[b]] = previous[b];
+        }
+        count[c]--;
+    }
+
+    [[nodiscard]] std::uint32_t compound(std::uint32_t b) const { return compoundOf[b]; }
+    [[nodiscard]] std::uint32_t firstBlock(std::uint32_t c) const { return head[c]; }
+    [[nodiscard]] std::uint32_t nextBlock(std::uint32_t b) const { return next[b]; }
+    [[nodiscard]] std::uint32_t numberOfBlocks(std::uint32_t c) const { return count[c]; }
+
+private:
+    static constexpr std::uint32_t NONE = UINT32_MAX;
+    std::vector<std::uint32_t> head;
+    std::vector<std::uint32_t> count;
+    std::vector<std::uint32_t> compoundOf;
+    std::vector<std::uint32_t> next;
+    std::vector<std::uint32_t> previous;
+};
+
+} // namespace
+
+std::vector<std::uint32_t>
+coarsestStablePartition(std::uint32_t numberOfStates,
+                        const std::vector<std::uint32_t> &initialBlocks,
+                        const std::vector<IndexedTransition> &transitions) {
+    if (numberOfStates == 0) {
+        return {};
+    }
+    RefinablePartition partition(numberOfStates, initialBlocks);
+    const auto m = static_cast<std::uint32_t>(transitions.size());
+    std::uint32_t nrLabels = 0;
+    for (const auto &t : transitions) {
+        nrLabels = std::max(nrLabels, t.label + 1);
+    }
+
+    // the incoming transitions of every state
+    std::vector<std::uint32_t> firstIn(numberOfStates + 1, 0);
+    for (const auto &t : transitions) {
+        firstIn[t.destination + 1]++;
+    }
+    std::partial_sum(firstIn.begin(), firstIn.end(), firstIn.begin());
+    std::vector<std::uint32_t> incoming(m);
+    {
+        std::vector<std::uint32_t> next(firstIn.begin(), firstIn.end() - 1);
+        for (std::uint32_t t = 0; t < m; t++) {
+            incoming[next[transitions[t].destination]++] = t;
+        }
+    }
+
+    // every transition s -a-> t refers to the counter of the a-transitions from s
+    // into the compound block containing t
+    std::vector<std::uint32_t> counters;
+    std::vector<std::uint32_t> freeCounters;
+    std::vector<std::uint32_t> counterOf(m);
+    {
+        std::vector<std::uint32_t> order(m);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+            return std::tie(transitions[a].source, transitions[a].label)
+                   < std::tie(transitions[b].source, transitions[b].label);
+        });
+        for (std::uint32_t k = 0; k < m; k++) {
+            const auto &t = transitions[order[k]];
+            if (k == 0 || t.source != transitions[order[k - 1]].source
+                || t.label != transitions[order[k - 1]].label) {
+                counters.push_back(0);
+            }
+            counters.back()++;
+            counterOf[order[k]] = static_cast<std::uint32_t>(counters.size() - 1);
+        }
+    }
+
+    // all blocks start in a single compound block; compounds of more than one
+    // block are queued as splitters
+    Compounds compounds;
+    std::uint32_t all = compounds.newCompound();
+    for (std::uint32_t b = 0; b < partition.numberOfBlocks(); b++) {
+        compounds.add(b, all);
+    }
+    std::vector<std::uint32_t> splitters;
+    std::vector<bool> queued(1, false);
+    auto enqueue = [&](std::uint32_t c) {
+        if (c >= queued.size()) {
+            queued.resize(c + 1, false);
+        }
+        if (!queued[c] && compounds.numberOfBlocks(c) > 1) {
+            queued[c] = true;
+            splitters.push_back(c);
+        }
+    };
+    auto split = [&]() {
+        partition.split([&](std::uint32_t b, std::uint32_t nb) {
+            std::uint32_t c = compounds.compound(b);
+            compounds.add(nb, c);
+            enqueue(c);
+        });
+    };
+
+    // the transitions grouped per label
+    std::vector<std::vector<std::uint32_t>> byLabel(nrLabels);
+    std::vector<std::uint32_t> labels;
+
+    // make the partition stable with respect to the set of all states
+    for (std::uint32_t t = 0; t < m; t++) {
+        byLabel[transitions[t].label].push_back(t);
+    }
+    for (auto &ts : byLabel) {
+        for (std::uint32_t t : ts) {
+            partition.mark(transitions[t].source);
+        }
+        split();
+        ts.clear();
+    }
+    enqueue(all);
+
+    std::vector<std::uint32_t> countInB(numberOfStates, 0);
+    std::vector<std::uint32_t> counterOfSource(numberOfStates);
+    std::vector<std::uint32_t> sources;
+    while (!splitters.empty()) {
+        // take the smaller of the first two blocks B of compound S as the new splitter
+        std::uint32_t c = splitters.back();
+        std::uint32_t b = compounds.firstBlock(c);
+        std::uint32_t b2 = compounds.nextBlock(b);
+        if (partition.size(b2) < partition.size(b)) {
+            b = b2;
+        }
+        compounds.remove(b);
+        if (compounds.numberOfBlocks(c) < 2) {
+            splitters.pop_back();
+            queued[c] = false;
+        }
+        compounds.add(b, compounds.newCompound());
+
+        // collect the transitions into B per label, before B may be split itself
+        for (const std::uint32_t *y = partition.begin(b); y != partition.finish(b); y++) {
+            for (std::uint32_t k = firstIn[*y]; k < firstIn[*y + 1]; k++) {
+                std::uint32_t t = incoming[k];
+                if (byLabel[transitions[t].label].empty()) {
+                    labels.push_back(transitions[t].label);
+                }
+                byLabel[transitions[t].label].push_back(t);
+            }
+        }
+
+        for (std::uint32_t a : labels) {
+            auto &ts = byLabel[a];
+            for (std::uint32_t t : ts) {
+                std::uint32_t x = transitions[t].source;
+                if (countInB[x]++ == 0) {
+                    sources.push_back(x);
+                    counterOfSource[x] = counterOf[t];
+                }
+            }
+
+            // split on having an a-transition into B
+            for (std::uint32_t x : sources) {
+                partition.mark(x);
+            }
+            split();
+
+            // split on having no a-transition into S \ B
+            for (std::uint32_t x : sources) {
+                if (counters[counterOfSource[x]] == countInB[x]) {
+                    partition.mark(x);
+                }
+            }
+            split();
+
+            // the transitions into B now count towards their own compound
+            for (std::uint32_t x : sources) {
+                std::uint32_t &counter = counters[counterOfSource[x]];
+                counter -= countInB[x];
+                if (counter == 0) {
+                    freeCounters.push_back(counterOfSource[x]);
+                }
+                if (freeCounters.empty()) {
+                    counterOfSource[x] = static_cast<std::uint32_t>(counters.size());
+                    counters.push_back(countInB[x]);
+                } else {
+                    counterOfSource[x] = freeCounters.back();
+                    freeCounters.pop_back();
+                    counters[counterOfSource[x]] = countInB[x];
+                }
+                countInB[x] = 0;
+            }
+            for (std::uint32_t t : ts) {
+                counterOf[t] = counterOfSource[transitions[t].source];
+            }
+            sources.clear();
+            ts.clear();
+        }
+        labels.clear();
+    }
+
+    // number the blocks in order of their smallest state
+    std::vector<std::uint32_t> result(numberOfStates);
+    std::vector<std::uint32_t> number(partition.numberOfBlocks(), UINT32_MAX);
+    std::uint32_t nrBlocks = 0;
+    for (std::uint32_t x = 0; x < numberOfStates; x++) {
+        std::uint32_t &n = number[partition.block(x)];
+        if (n == UINT32_MAX) {
+            n = nrBlocks++;
+        }
+        result[x] = n;
+    }
+    return result;
+}
+
+namespace Abstract {
+
+namespace {
+
+// levels of fewer states are not worth starting threads for
+constexpr std::size_t PARALLEL_BFS_THRESHOLD = 4096;
+
+} // namespace
+
+BFSFrontier::BFSFrontier(const FiniteStateMachine &fsm,
+                         const SetOfStateRefs &startingStates,
+                         unsigned int nrThreads) :
+    reached(fsm),
+    nrThreads(fsm.exploresOnDemand() ? 1
+              : nrThreads == 0     ? std::max(1U, std::thread::hardware_concurrency())
+                                   : nrThreads) {
+    // concurrent threads claim states in a bitmap of fixed size
+    const SetOfStates &states = fsm.getStates();
+    if (this->nrThreads > 1 && !states.empty()) {
+        this->base = states.begin()->first;
+        this->nrBits = std::min<std::size_t>(states.rbegin()->first - this->base + 1,
+                                             64 * (states.size() + 1024));
+        std::size_t nrWords = (this->nrBits + 63) / 64;
+        this->bits = std::make_unique<std::atomic<std::uint64_t>[]>(nrWords);
+        for (std::size_t w = 0; w < nrWords; w++) {
+            this->bits[w].store(0, std::memory_order_relaxed);
+        }
+    }
+    for (StateRef s : startingStates) {
+        if (this->claim(s)) {
+            this->current.push_back(s);
+        }
+    }
+}
+
+bool BFSFrontier::claim(StateRef s) {
+    if (this->nrThreads > 1) {
+        return this->claimConcurrently(s);
+    }
+    if (this->reached.contains(s)) {
+        return false;
+    }
+    this->reached.insert(s);
+    return true;
+}
+
+bool BFSFrontier::claimConcurrently(StateRef s) {
+    std::size_t i = s->getId() - static_cast<std::size_t>(this->base);
+    if (s->getId() >= this->base && i < this->nrBits) {
+        std::uint64_t mask = std::uint64_t{1} << (i % 64);
+        return (this->bits[i / 64].fetch_or(mask, std::memory_order_relaxed) & mask) == 0;
+    }
+    std::lock_guard<std::mutex> lock(this->othersMutex);
+    return this->others.insert(s).second;
+}
+
+void BFSFrontier::followEdges(std::size_t first, std::size_t last, std::vector<StateRef> &found) {
+    for (std::size_t k = first; k < last; k++) {
+        for (const auto *e : this->current[k]->getOutgoingEdges()) {
+            StateRef d = e->getDestination();
+            if (this->claim(d)) {
+                found.push_back(d);
+            }
+        }
+    }
+}
+
+void BFSFrontier::advance() {
+    std::size_t size = this->current.size();
+    if (this->nrThreads <= 1 || size < PARALLEL_BFS_THRESHOLD) {
+        std::vector<StateRef> next;
+        this->followEdges(0, size, next);
+        this->current = std::move(next);
+        return;
+    }
+
+    // every thread follows the edges of a slice of the level
+    std::vector<std::vector<StateRef>> found(this->nrThreads);
+    std::vector<std::thread> threads;
+    threads.reserve(this->nrThreads - 1);
+    for (unsigned int t = 1; t < this->nrThreads; t++) {
+        threads.emplace_back([this, &found, t, size]() {
+            this->followEdges(size * t / this->nrThreads,
+                              size * (t + 1) / this->nrThreads,
+                              found[t]);
+        });
+    }
+    this->followEdges(0, size / this->nrThreads, found[0]);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    std::vector<StateRef> next;
+    for (const auto &f : found) {
+        next.insert(next.end(), f.begin(), f.end());
+    }
+    std::sort(next.begin(), next.end(), StateRefCompareLessThan());
+    this->current = std::move(next);
+}
+
+} // namespace Abstract
 
 namespace StateStringLabeled {
 
@@ -68,27 +510,72 @@ void FiniteStateMachine::setInitialStateLabeled(const MPString &sl) { this->setI
 
 namespace Product {
 
-const Abstract::SetOfEdges &State::getOutgoingEdges() { // NOLINT(*no-recursion)
-    if (!outgoingEdgesDone) {
-        // compute outgoing edges
-        const Abstract::SetOfEdgeRefs &oea = this->sa->getOutgoingEdges();
-        const Abstract::SetOfEdgeRefs &oeb = this->sb->getOutgoingEdges();
-        auto i = oea.begin();
-        auto j = oeb.begin();
-        while (i != oea.end()) {
-            while (j != oeb.end()) {
-                if (this->fsm->matchEdges(*(*i), *(*j))) {
-                    Abstract::Edge* e = this->fsm->ensureEdge(*(*i), *(*j));
-                    this->insertOutgoingEdge(*e);
-                }
-                j++;
+const Abstract::SetOfEdgeRefs &State::getOutgoingEdges() const { // NOLINT(*no-recursion)
+    if (!this->outgoingEdgesDone) {
+        this->outgoingEdgesDone = true;
+        // the product owns its states, which are therefore never const objects
+        this->fsm->exploreState(const_cast<State &>(*this)); // NOLINT(*const-cast)
+    }
+    return Abstract::State::getOutgoingEdges();
+}
+
+FiniteStateMachine::FiniteStateMachine(const Abstract::FiniteStateMachine &fsm1,
+                                       const Abstract::FiniteStateMachine &fsm2) :
+    fsm_a(&fsm1), fsm_b(&fsm2) {
+    for (const auto *s1 : fsm1.getInitialStates()) {
+        for (const auto *s2 : fsm2.getInitialStates()) {
+            this->initialStates.insert(&this->getPairState(*s1, *s2));
+        }
+    }
+}
+
+Abstract::StateRef FiniteStateMachine::getInitialState() const {
+    if (this->initialStates.empty()) {
+        throw MaxPlus::MPException("FSM has no initial state.");
+    }
+    return *this->initialStates.begin();
+}
+
+Abstract::SetOfStateRefs FiniteStateMachine::getStateRefs() const {
+    Abstract::SetOfStateRefs result;
+    for (const auto &i : this->states) {
+        result.insert(result.end(), i.second.get());
+    }
+    return result;
+}
+
+State &FiniteStateMachine::getPairState(const Abstract::State &s1, const Abstract::State &s2) {
+    std::uint64_t key = (static_cast<std::uint64_t>(s1.getId()) << 32U) | s2.getId();
+    auto i = this->pairs.find(key);
+    if (i != this->pairs.end()) {
+        return *i->second;
+    }
+    auto s = std::make_unique<State>(s1, s2, *this);
+    State *sp = s.get();
+    this->pairs.emplace(key, sp);
+    this->states.addState(std::move(s));
+    const auto &fa = this->fsm_a->getFinalStates();
+    const auto &fb = this->fsm_b->getFinalStates();
+    if (fa.find(&s1) != fa.end() && fb.find(&s2) != fb.end()) {
+        this->finalStates.insert(sp);
+    }
+    return *sp;
+}
+
+void FiniteStateMachine::exploreState(State &s) { // NOLINT(*no-recursion)
+    for (const auto *e1 : s.getStateA().getOutgoingEdges()) {
+        for (const auto *e2 : s.getStateB().getOutgoingEdges()) {
+            if (this->matchEdges(*e1, *e2)) {
+                State &d = this->getPairState(*e1->getDestination(), *e2->getDestination());
+                auto e = std::make_unique<Edge>(s, d, *e1, *e2);
+                s.insertOutgoingEdge(*e);
+                CId id = e->getId();
+                this->edges.emplace(id, std::move(e));
             }
-            i++;
         }
-        outgoingEdgesDone = true;
     }
-    return this->getOutgoingEdges();
 }
+
 } // namespace Product
 
 } // namespace MaxPlus::FSM
\ No newline at end of file
@@ -0,0 +1,354 @@
+#include "base/analysis/mcm/mcm.h"
+#include "base/analysis/mcm/mcmdg.h"
+#include "base/analysis/mcm/mcmhoward.h"
+#include "base/analysis/mcm/mcmyto.h"
+#include "base/exception/exception.h"
+#include "generators.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAXPLUS_BENCH_FORK
+#include <csignal>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace MaxPlus;
+using namespace MaxPlus::Graphs;
+using namespace MaxPlus::Generators;
+
+namespace {
+
+struct Algorithm {
+    std::string name;
+    std::function<CDouble(MCMgraph &)> run;
+};
+
+const std::vector<Algorithm> &allAlgorithms() {
+    static const std::vector<Algorithm> algorithms = {
+            {"karp", [](MCMgraph &g) { return maximumCycleMeanKarpGeneral(g); }},
+            {"karp-double", [](MCMgraph &g) { return maximumCycleMeanKarpDoubleGeneral(g); }},
+            {"howard", [](MCMgraph &g) { return maximumCycleMeanHowardGeneral(g, nullptr); }},
+            {"dasdan-gupta", [](MCMgraph &g) { return mcmDG(g); }},
+            {"yto", [](MCMgraph &g) { return maxCycleMeanYoungTarjanOrlin(g); }},
+            {"automatic", [](MCMgraph &g) { return maximumCycleMean(g); }},
+            {"howard-ratio", [](MCMgraph &g) { return maximumCycleRatioHoward(g); }},
+            {"yto-ratio", [](MCMgraph &g) { return maxCycleRatioYoungTarjanOrlin(g); }},
+            {"automatic-ratio", [](MCMgraph &g) { return maximumCycleRatio(g); }}};
+    return algorithms;
+}
+
+struct Options {
+    std::vector<GraphFamily> families = allGraphFamilies();
+    std::vector<Algorithm> algorithms = allAlgorithms();
+    unsigned int minEdges = 100;
+    unsigned int maxEdges = 1000000;
+    unsigned int seeds = 1;
+    unsigned int timeout = 60;
+    unsigned int memoryLimitMB = 4096;
+    std::string output;
+};
+
+struct Measurement {
+    std::string status = "ok";
+    unsigned int nodes = 0;
+    unsigned int edges = 0;
+    CDouble result = 0.0;
+    double seconds = 0.0;
+    long graphPeakKB = 0;
+    long peakKB = 0;
+    // the signal that ended a crashed run
+    int signal = 0;
+};
+
+std::vector<std::string> split(const std::string &s) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        parts.push_back(part);
+    }
+    return parts;
+}
+
+void usage() {
+    std::cerr << "Usage: maxplus_bench [options]\n"
+              << "  --families f1,f2,...    random-sparse, grid, sdf, dense-matrix (default all)\n"
+              << "  --algorithms a1,a2,...  karp, karp-double, howard, dasdan-gupta, yto, automatic,\n"
+              << "                          howard-ratio, yto-ratio, automatic-ratio (default all)\n"
+              << "  --min-edges n           smallest graph size in edges (default 100)\n"
+              << "  --max-edges n           largest graph size in edges (default 1000000)\n"
+              << "  --seeds n               number of graphs per family and size (default 1)\n"
+              << "  --timeout s             time limit per run in seconds (default 60)\n"
+              << "  --memory-limit-mb m     memory limit per run (default 4096)\n"
+              << "  --output file           write the JSON results to file instead of stdout\n";
+}
+
+/**
+ * Parse the value of a numeric option. Throws an MPException if the value is
+ * not a positive number that fits in an unsigned int; a zero would make the
+ * size loop run forever or disable the limits.
+ */
+unsigned int parseUnsigned(const std::string &option, const std::string &value) {
+    unsigned long result = 0;
+    size_t end = 0;
+    try {
+        result = std::stoul(value, &end);
+    } catch (std::logic_error &) {
+        end = 0;
+    }
+    if (end == 0 || end != value.size() || value[0] == '-' || result == 0
+        || result > std::numeric_limits<unsigned int>::max()) {
+        throw MPException(MPString("Invalid value for option " + option + ": " + value));
+    }
+    return static_cast<unsigned int>(result);
+}
+
+Options parseOptions(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i]; // NOLINT(*pointer-arithmetic)
+        if (arg == "--help") {
+            usage();
+            std::exit(0);
+        }
+        if (i + 1 == argc) {
+            throw MPException(MPString("Missing value for option " + arg));
+        }
+        std::string value = argv[++i]; // NOLINT(*pointer-arithmetic)
+        if (arg == "--families") {
+            options.families.clear();
+            for (const auto &name : split(value)) {
+                options.families.push_back(graphFamilyFromName(name));
+            }
+        } else if (arg == "--algorithms") {
+            options.algorithms.clear();
+            for (const auto &name : split(value)) {
+                bool found = false;
+                for (const auto &algorithm : allAlgorithms()) {
+                    if (algorithm.name == name) {
+                        options.algorithms.push_back(algorithm);
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    throw MPException(MPString("Unknown algorithm: " + name));
+                }
+            }
+        } else if (arg == "--min-edges") {
+            options.minEdges = parseUnsigned(arg, value);
+        } else if (arg == "--max-edges") {
+            options.maxEdges = parseUnsigned(arg, value);
+        } else if (arg == "--seeds") {
+            options.seeds = parseUnsigned(arg, value);
+        } else if (arg == "--timeout") {
+            options.timeout = parseUnsigned(arg, value);
+        } else if (arg == "--memory-limit-mb") {
+            options.memoryLimitMB = parseUnsigned(arg, value);
+        } else if (arg == "--output") {
+            options.output = value;
+        } else {
+            usage();
+            throw MPException(MPString("Unknown option " + arg));
+        }
+    }
+    return options;
+}
+
+/**
+ * Generate the graph and run the algorithm on it. Peak memory is the peak
+ * resident set size of the process, which is only meaningful if the
+ * measurement runs in a process of its own.
+ */
+Measurement measure(GraphFamily family,
+                    unsigned int numberOfEdges,
+                    unsigned int seed,
+                    const Algorithm &algorithm) {
+    Measurement m;
+#ifdef MAXPLUS_BENCH_FORK
+    rusage usage{};
+#endif
+    try {
+        MCMgraph g = generateGraph(family, numberOfEdges, seed);
+        m.nodes = g.numberOfNodes();
+        m.edges = g.numberOfEdges();
+#ifdef MAXPLUS_BENCH_FORK
+        getrusage(RUSAGE_SELF, &usage);
+        m.graphPeakKB = usage.ru_maxrss;
+#endif
+        auto start = std::chrono::steady_clock::now();
+        m.result = algorithm.run(g);
+        auto end = std::chrono::steady_clock::now();
+        m.seconds = std::chrono::duration<double>(end - start).count();
+    } catch (MPException &) {
+        m.status = "error";
+    } catch (std::bad_alloc &) {
+        m.status = "out-of-memory";
+    }
+#ifdef MAXPLUS_BENCH_FORK
+    getrusage(RUSAGE_SELF, &usage);
+    m.peakKB = usage.ru_maxrss;
+#endif
+    return m;
+}
+
+#ifdef MAXPLUS_BENCH_FORK
+/**
+ * Parse a double as written with std::hexfloat. Unlike reading with >>, strtod
+ * accepts inf and nan as well, so that every value survives the pipe exactly.
+ */
+bool parseDouble(const std::string &s, double &value) {
+    char *end = nullptr;
+    value = std::strtod(s.c_str(), &end);
+    return !s.empty() && end == s.c_str() + s.size(); // NOLINT(*pointer-arithmetic)
+}
+
+/**
+ * Run the measurement in a child process, with a time and memory limit, such
+ * that the peak memory usage of every measurement is reported separately and
+ * that a run that exceeds its limits does not end the benchmark.
+ */
+Measurement measureInChild(const Options &options,
+                           GraphFamily family,
+                           unsigned int numberOfEdges,
+                           unsigned int seed,
+                           const Algorithm &algorithm) {
+    std::array<int, 2> fds{};
+    if (pipe(fds.data()) != 0) {
+        throw MPException("Failed to create a pipe.");
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        throw MPException("Failed to fork a measurement process.");
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        rlimit limit{};
+        limit.rlim_cur = limit.rlim_max = static_cast<rlim_t>(options.memoryLimitMB) << 20U;
+        setrlimit(RLIMIT_AS, &limit);
+        alarm(options.timeout);
+        Measurement m = measure(family, numberOfEdges, seed, algorithm);
+        std::ostringstream out;
+        out << m.status << ' ' << m.nodes << ' ' << m.edges << ' ' << std::hexfloat << m.result
+            << ' ' << m.seconds << std::defaultfloat << ' ' << m.graphPeakKB << ' ' << m.peakKB;
+        std::string s = out.str();
+        ssize_t written = write(fds[1], s.data(), s.size());
+        close(fds[1]);
+        _exit(written == static_cast<ssize_t>(s.size()) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    std::string data;
+    std::array<char, 256> buffer{};
+    ssize_t n = 0;
+    while ((n = read(fds[0], buffer.data(), buffer.size())) > 0) {
+        data.append(buffer.data(), n);
+    }
+    close(fds[0]);
+
+    int status = 0;
+    rusage usage{};
+    wait4(pid, &status, 0, &usage);
+
+    Measurement m;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        std::istringstream in(data);
+        std::string result;
+        std::string seconds;
+        in >> m.status >> m.nodes >> m.edges >> result >> seconds >> m.graphPeakKB >> m.peakKB;
+        if (in.fail() || !parseDouble(result, m.result) || !parseDouble(seconds, m.seconds)) {
+            m.status = "error";
+        }
+    } else if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) {
+        m.status = "timeout";
+    } else if (WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL) {
+        // the memory limit makes allocations fail, which the child reports itself; a
+        // run that is killed outright has been ended by the kernel when memory ran out
+        m.status = "out-of-memory";
+    } else if (WIFSIGNALED(status)) {
+        m.status = "crash";
+        m.signal = WTERMSIG(status);
+    } else {
+        m.status = "error";
+    }
+    m.peakKB = usage.ru_maxrss;
+    return m;
+}
+#endif
+
+std::string jsonNumber(CDouble value) {
+    if (std::isinf(value)) {
+        return value > 0 ? "\"inf\"" : "\"-inf\"";
+    }
+    if (std::isnan(value)) {
+        return "null";
+    }
+    std::ostringstream out;
+    out.precision(17);
+    out << value;
+    return out.str();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    try {
+        Options options = parseOptions(argc, argv);
+
+        std::ofstream file;
+        if (!options.output.empty()) {
+            file.open(options.output);
+        }
+        std::ostream &out = options.output.empty() ? std::cout : file;
+
+        out << "{\n  \"benchmark\": \"maxplus_bench\",\n  \"results\": [";
+        bool first = true;
+        for (auto family : options.families) {
+            for (unsigned long edges = options.minEdges; edges <= options.maxEdges; edges *= 10) {
+                for (unsigned int seed = 0; seed < options.seeds; seed++) {
+                    for (const auto &algorithm : options.algorithms) {
+                        std::cerr << graphFamilyName(family) << " " << edges << " " << seed
+                                  << " " << algorithm.name << std::endl;
+#ifdef MAXPLUS_BENCH_FORK
+                        Measurement m = measureInChild(
+                                options, family, static_cast<unsigned int>(edges), seed, algorithm);
+#else
+                        Measurement m = measure(
+                                family, static_cast<unsigned int>(edges), seed, algorithm);
+#endif
+                        out << (first ? "\n" : ",\n");
+                        first = false;
+                        out << "    {\"family\": \"" << graphFamilyName(family)
+                            << "\", \"seed\": " << seed << ", \"nodes\": " << m.nodes
+                            << ", \"edges\": " << m.edges << ", \"algorithm\": \""
+                            << algorithm.name << "\", \"status\": \"" << m.status
+                            << "\", \"result\": " << jsonNumber(m.result)
+                            << ", \"seconds\": " << jsonNumber(m.seconds)
+                            << ", \"graph_peak_kb\": " << m.graphPeakKB
+                            << ", \"peak_kb\": " << m.peakKB << ", \"signal\": " << m.signal
+                            << "}";
+                        out.flush();
+                    }
+                }
+            }
+        }
+        out << "\n  ]\n}\n";
+    } catch (MPException &e) {
+        e.report(std::cerr);
+        return 1;
+    }
+    return 0;
+}
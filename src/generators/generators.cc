@@ -0,0 +1,367 @@
+#include "generators.h"
+#include "maxplus/base/exception/exception.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace MaxPlus::Graphs;
+
+namespace MaxPlus::Generators {
+
+namespace {
+
+constexpr unsigned int MAX_REWARD = 10;
+
+CDouble randomWeight(std::mt19937 &rng) { return static_cast<CDouble>(1 + (rng() % MAX_WEIGHT)); }
+
+bool coinFlip(std::mt19937 &rng, CDouble probability) {
+    return std::uniform_real_distribution<CDouble>(0.0, 1.0)(rng) < probability;
+}
+
+/**
+ * Boundaries of n items split into the given number of (almost) equal bands.
+ */
+std::vector<unsigned int> bands(unsigned int n, unsigned int blocks) {
+    blocks = (std::max)(1U, (std::min)(blocks, (std::max)(n, 1U)));
+    std::vector<unsigned int> b(blocks + 1);
+    for (unsigned int i = 0; i <= blocks; i++) {
+        b[i] = static_cast<unsigned int>((static_cast<uint64_t>(n) * i) / blocks);
+    }
+    return b;
+}
+
+std::vector<MPString> modeNames(unsigned int numberOfModes) {
+    std::vector<MPString> modes;
+    for (unsigned int m = 0; m < (std::max)(numberOfModes, 1U); m++) {
+        modes.emplace_back("m" + std::to_string(m));
+    }
+    return modes;
+}
+
+/**
+ * Add a ring through all states plus random edges up to the average
+ * out-degree to an automaton with MPA state labels. The edge labels are
+ * created by makeLabel(rng, mode).
+ */
+template <typename EL, typename LabelFactory>
+std::vector<const State<MPAStateLabel, EL> *>
+fillAutomaton(FiniteStateMachine<MPAStateLabel, EL> &a,
+              unsigned int numberOfStates,
+              unsigned int outDegree,
+              unsigned int numberOfModes,
+              std::mt19937 &rng,
+              LabelFactory makeLabel) {
+    const std::vector<MPString> modes = modeNames(numberOfModes);
+    unsigned int n = (std::max)(numberOfStates, 1U);
+    std::vector<const State<MPAStateLabel, EL> *> states(n);
+    for (unsigned int i = 0; i < n; i++) {
+        states[i] = a.addState(makeMPAStateLabel(i, 0));
+    }
+    for (unsigned int i = 0; i < n; i++) {
+        a.addEdge(*states[i], makeLabel(rng, modes[rng() % modes.size()]), *states[(i + 1) % n]);
+    }
+    uint64_t numberOfEdges = static_cast<uint64_t>(n) * (std::max)(outDegree, 1U);
+    for (uint64_t e = n; e < numberOfEdges; e++) {
+        const auto &src = *states[rng() % n];
+        const auto &dst = *states[rng() % n];
+        a.addEdge(src, makeLabel(rng, modes[rng() % modes.size()]), dst);
+    }
+    a.setInitialState(*states[0]);
+    return states;
+}
+
+std::vector<MCMnode *> addNodes(MCMgraph &g, unsigned int numberOfNodes) {
+    std::vector<MCMnode *> nodes(numberOfNodes);
+    for (unsigned int i = 0; i < numberOfNodes; i++) {
+        nodes[i] = g.addNode(i);
+    }
+    return nodes;
+}
+
+/**
+ * Random graph with an average out-degree of four. The first edge of every
+ * node goes to a random node, such that every node has a successor.
+ */
+MCMgraph generateRandomSparse(unsigned int numberOfEdges, std::mt19937 &rng) {
+    constexpr unsigned int DEGREE = 4;
+    MCMgraph g;
+    unsigned int n = (std::max)(2U, numberOfEdges / DEGREE);
+    std::vector<MCMnode *> nodes = addNodes(g, n);
+    CId eId = 0;
+    for (unsigned int i = 0; i < n; i++) {
+        g.addEdge(eId++, *nodes[i], *nodes[rng() % n], randomWeight(rng), 1.0);
+    }
+    while (eId < numberOfEdges) {
+        g.addEdge(eId++, *nodes[rng() % n], *nodes[rng() % n], randomWeight(rng), 1.0);
+    }
+    return g;
+}
+
+/**
+ * Two-dimensional torus in which every node has an edge to its right and to
+ * its lower neighbour.
+ */
+MCMgraph generateGrid(unsigned int numberOfEdges, std::mt19937 &rng) {
+    auto side = static_cast<unsigned int>(std::sqrt(numberOfEdges / 2.0));
+    side = (std::max)(side, 2U);
+    MCMgraph g;
+    std::vector<MCMnode *> nodes = addNodes(g, side * side);
+    CId eId = 0;
+    for (unsigned int r = 0; r < side; r++) {
+        for (unsigned int c = 0; c < side; c++) {
+            MCMnode &n = *nodes[(r * side) + c];
+            g.addEdge(eId++, n, *nodes[(r * side) + ((c + 1) % side)], randomWeight(rng), 1.0);
+            g.addEdge(eId++, n, *nodes[(((r + 1) % side) * side) + c], randomWeight(rng), 1.0);
+        }
+    }
+    return g;
+}
+
+/**
+ * Homogeneous expansion of a ring of multi-rate actors. Every actor a has a
+ * repetition count q[a] in [1, 4]; firing i of actor a enables firing
+ * i * q[b] / q[a] of the next actor b. Consecutive firings of an actor are
+ * ordered and the ring and the firing sequences are closed by edges with one
+ * token (delay one). Edge weights are the execution times of the source firings.
+ */
+MCMgraph generateSDF(unsigned int numberOfEdges, std::mt19937 &rng) {
+    constexpr unsigned int MAX_RATE = 4;
+    constexpr unsigned int EDGES_PER_FIRING = 2;
+    MCMgraph g;
+
+    // choose repetition counts until the expansion is large enough
+    std::vector<unsigned int> q;
+    unsigned int nrFirings = 0;
+    while (q.size() < 2 || nrFirings * EDGES_PER_FIRING < numberOfEdges) {
+        q.push_back(1 + (rng() % MAX_RATE));
+        nrFirings += q.back();
+    }
+
+    std::vector<std::vector<MCMnode *>> firings(q.size());
+    std::vector<std::vector<CDouble>> executionTimes(q.size());
+    CId nId = 0;
+    for (size_t a = 0; a < q.size(); a++) {
+        CDouble executionTime = randomWeight(rng);
+        for (unsigned int i = 0; i < q[a]; i++) {
+            firings[a].push_back(g.addNode(nId++));
+            executionTimes[a].push_back(executionTime);
+        }
+    }
+
+    CId eId = 0;
+    for (size_t a = 0; a < q.size(); a++) {
+        size_t b = (a + 1) % q.size();
+        CDouble ringDelay = (b == 0) ? 1.0 : 0.0;
+        for (unsigned int i = 0; i < q[a]; i++) {
+            unsigned int j = (i * q[b]) / q[a];
+            g.addEdge(eId++, *firings[a][i], *firings[b][j], executionTimes[a][i], ringDelay);
+            unsigned int next = (i + 1) % q[a];
+            g.addEdge(eId++,
+                      *firings[a][i],
+                      *firings[a][next],
+                      executionTimes[a][i],
+                      next == 0 ? 1.0 : 0.0);
+        }
+    }
+    return g;
+}
+
+/**
+ * Precedence graph of a random square max-plus matrix in which half of the
+ * entries are finite. Every row has at least its diagonal entry, so that
+ * every node has a successor.
+ */
+MCMgraph generateDenseMatrix(unsigned int numberOfEdges, std::mt19937 &rng) {
+    auto n = static_cast<unsigned int>(std::sqrt(2.0 * numberOfEdges));
+    n = (std::max)(n, 2U);
+    Matrix m(n, n, MatrixFill::MinusInfinity);
+    for (unsigned int r = 0; r < n; r++) {
+        for (unsigned int c = 0; c < n; c++) {
+            if (r == c || rng() % 2 == 0) {
+                m.put(r, c, MPTime(randomWeight(rng)));
+            }
+        }
+    }
+    return m.mpMatrixToPrecedenceGraph();
+}
+
+} // namespace
+
+Matrix generateMatrix(unsigned int rows,
+                      unsigned int cols,
+                      CDouble density,
+                      unsigned int seed,
+                      unsigned int blocks) {
+    std::mt19937 rng(seed);
+    Matrix m(rows, cols, MatrixFill::MinusInfinity);
+    std::vector<unsigned int> rowBands = bands(rows, blocks);
+    std::vector<unsigned int> colBands = bands(cols, blocks);
+    size_t nrBlocks = (std::min)(rowBands.size(), colBands.size()) - 1;
+    for (size_t b = 0; b < nrBlocks; b++) {
+        for (unsigned int r = rowBands[b]; r < rowBands[b + 1]; r++) {
+            for (unsigned int c = colBands[b]; c < colBands[b + 1]; c++) {
+                if (coinFlip(rng, density)) {
+                    m.put(r, c, MPTime(randomWeight(rng)));
+                }
+            }
+        }
+    }
+    return m;
+}
+
+SparseMatrix generateSparseMatrix(unsigned int rows,
+                                  unsigned int cols,
+                                  CDouble density,
+                                  unsigned int seed,
+                                  unsigned int blocks) {
+    std::mt19937 rng(seed);
+    SparseMatrix m(rows, cols);
+    std::vector<unsigned int> rowBands = bands(rows, blocks);
+    std::vector<unsigned int> colBands = bands(cols, blocks);
+    for (size_t br = 0; br + 1 < rowBands.size(); br++) {
+        for (size_t bc = 0; bc + 1 < colBands.size(); bc++) {
+            if (coinFlip(rng, density)) {
+                m.putAll(rowBands[br],
+                         rowBands[br + 1],
+                         colBands[bc],
+                         colBands[bc + 1],
+                         MPTime(randomWeight(rng)));
+            }
+        }
+    }
+    return m;
+}
+
+const std::vector<GraphFamily> &allGraphFamilies() {
+    static const std::vector<GraphFamily> families = {
+            GraphFamily::RandomSparse, GraphFamily::Grid, GraphFamily::SDF, GraphFamily::DenseMatrix};
+    return families;
+}
+
+std::string graphFamilyName(GraphFamily family) {
+    switch (family) {
+    case GraphFamily::RandomSparse:
+        return "random-sparse";
+    case GraphFamily::Grid:
+        return "grid";
+    case GraphFamily::SDF:
+        return "sdf";
+    default:
+        return "dense-matrix";
+    }
+}
+
+GraphFamily graphFamilyFromName(const std::string &name) {
+    for (auto family : allGraphFamilies()) {
+        if (graphFamilyName(family) == name) {
+            return family;
+        }
+    }
+    throw MPException(MPString("Unknown graph family: " + name));
+}
+
+MCMgraph generateGraph(GraphFamily family, unsigned int numberOfEdges, unsigned int seed) {
+    std::mt19937 rng(seed);
+    switch (family) {
+    case GraphFamily::RandomSparse:
+        return generateRandomSparse(numberOfEdges, rng);
+    case GraphFamily::Grid:
+        return generateGrid(numberOfEdges, rng);
+    case GraphFamily::SDF:
+        return generateSDF(numberOfEdges, rng);
+    default:
+        return generateDenseMatrix(numberOfEdges, rng);
+    }
+}
+
+std::unique_ptr<MaxPlusAutomaton> generateMaxPlusAutomaton(unsigned int numberOfStates,
+                                                           unsigned int outDegree,
+                                                           unsigned int numberOfModes,
+                                                           unsigned int seed) {
+    std::mt19937 rng(seed);
+    auto mpa = std::make_unique<MaxPlusAutomaton>();
+    fillAutomaton<MPAEdgeLabel>(
+            *mpa, numberOfStates, outDegree, numberOfModes, rng,
+            [](std::mt19937 &r, const MPString &mode) {
+                return makeMPAEdgeLabel(MPDelay(randomWeight(r)), mode);
+            });
+    return mpa;
+}
+
+std::unique_ptr<MaxPlusAutomatonWithRewards>
+generateMaxPlusAutomatonWithRewards(unsigned int numberOfStates,
+                                    unsigned int outDegree,
+                                    unsigned int numberOfModes,
+                                    unsigned int seed) {
+    std::mt19937 rng(seed);
+    auto mpa = std::make_unique<MaxPlusAutomatonWithRewards>();
+    fillAutomaton<MPAREdgeLabel>(
+            *mpa, numberOfStates, outDegree, numberOfModes, rng,
+            [](std::mt19937 &r, const MPString &mode) {
+                CDouble delay = randomWeight(r);
+                return makeRewardEdgeLabel(
+                        MPDelay(delay), mode, static_cast<CDouble>(1 + (r() % MAX_REWARD)));
+            });
+    return mpa;
+}
+
+std::unique_ptr<MaxPlusGameAutomatonWithRewards>
+generateGame(unsigned int numberOfStates, unsigned int outDegree, unsigned int seed) {
+    std::mt19937 rng(seed);
+    auto game = std::make_unique<MaxPlusGameAutomatonWithRewards>();
+    auto states = fillAutomaton<MPAREdgeLabel>(
+            *game, numberOfStates, outDegree, 1, rng, [](std::mt19937 &r, const MPString &mode) {
+                CDouble delay = randomWeight(r);
+                return makeRewardEdgeLabel(
+                        MPDelay(delay), mode, static_cast<CDouble>(1 + (r() % MAX_REWARD)));
+            });
+    for (const auto *s : states) {
+        if (rng() % 2 == 0) {
+            game->addV0(s);
+        } else {
+            game->addV1(s);
+        }
+    }
+    return game;
+}
+
+std::unique_ptr<SMPLS::SMPLS> generateSMPLS(unsigned int numberOfModes,
+                                            unsigned int matrixSize,
+                                            CDouble density,
+                                            unsigned int numberOfFSMStates,
+                                            unsigned int outDegree,
+                                            unsigned int seed) {
+    std::mt19937 rng(seed);
+    auto smpls = std::make_unique<SMPLS::SMPLS>();
+    const std::vector<MPString> modes = modeNames(numberOfModes);
+    for (const auto &mode : modes) {
+        auto m = std::make_unique<Matrix>(generateMatrix(matrixSize, matrixSize, density, rng()));
+        for (unsigned int k = 0; k < matrixSize; k++) {
+            if (m->get(k, k).isMinusInfinity()) {
+                m->put(k, k, MPTime(randomWeight(rng)));
+            }
+        }
+        smpls->addModeMatrix(mode, std::move(m));
+    }
+
+    auto &fsm = smpls->elsFSM;
+    unsigned int n = (std::max)(numberOfFSMStates, 1U);
+    std::vector<const State<CId, MPString> *> states(n);
+    for (unsigned int i = 0; i < n; i++) {
+        states[i] = fsm.addState(i);
+    }
+    for (unsigned int i = 0; i < n; i++) {
+        fsm.addEdge(*states[i], modes[rng() % modes.size()], *states[(i + 1) % n]);
+    }
+    uint64_t numberOfEdges = static_cast<uint64_t>(n) * (std::max)(outDegree, 1U);
+    for (uint64_t e = n; e < numberOfEdges; e++) {
+        const auto &src = *states[rng() % n];
+        const auto &dst = *states[rng() % n];
+        fsm.addEdge(src, modes[rng() % modes.size()], dst);
+    }
+    fsm.setInitialState(*states[0]);
+    return smpls;
+}
+
+} // namespace MaxPlus::Generators
@@ -0,0 +1,127 @@
+#ifndef MAXPLUS_GENERATORS_GENERATORS_H
+#define MAXPLUS_GENERATORS_GENERATORS_H
+
+#include "maxplus/algebra/mpmatrix.h"
+#include "maxplus/algebra/mpsparsematrix.h"
+#include "maxplus/base/analysis/mcm/mcmgraph.h"
+#include "maxplus/game/mpgameautomaton.h"
+#include "maxplus/graph/mpautomaton.h"
+#include "maxplus/graph/smpls.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Seeded generators of synthetic workloads shared by the testbench and the
+ * benchmarks. All generators are deterministic for a given seed and draw
+ * integer weights in [1, MAX_WEIGHT], such that the integer algorithms apply
+ * as well. Every node or state of a generated graph or automaton has a
+ * successor. The automata (max-plus automata, games and the mode automata of
+ * SMPLS) get a ring through all states first and random edges after that,
+ * so they are strongly connected. Whether an MCM graph is strongly connected
+ * depends on its family; see GraphFamily.
+ */
+namespace MaxPlus::Generators {
+
+constexpr unsigned int MAX_WEIGHT = 1000;
+
+/**
+ * Dense max-plus matrix of the given size in which a fraction density of the
+ * entries is finite. With more than one block, rows and columns are split
+ * into that many bands and only the blocks on the diagonal get finite
+ * entries, giving a reducible matrix with independent components.
+ */
+Matrix generateMatrix(unsigned int rows,
+                      unsigned int cols,
+                      CDouble density,
+                      unsigned int seed,
+                      unsigned int blocks = 1);
+
+/**
+ * Sparse max-plus matrix of the given size. Rows and columns are split into
+ * the given number of bands and every block of the resulting grid is, with
+ * probability density, filled with one random constant; the other blocks are
+ * minus infinity. Constant blocks are what SparseMatrix stores compactly, so
+ * the size can go up to millions of rows.
+ */
+SparseMatrix generateSparseMatrix(unsigned int rows,
+                                  unsigned int cols,
+                                  CDouble density,
+                                  unsigned int seed,
+                                  unsigned int blocks);
+
+/**
+ * The families of MCM graphs. Node ids run from 0 up to the number of
+ * nodes and every node has an outgoing edge.
+ *  - RandomSparse: average out-degree four; the first edge of every node goes
+ *    to a random node. There is no ring, so the graph is in general not
+ *    strongly connected and may have several components.
+ *  - Grid: two-dimensional torus with edges to the right and lower
+ *    neighbours; strongly connected.
+ *  - SDF: homogeneous expansion of a ring of multi-rate actors, with edges
+ *    without delay inside an iteration; strongly connected.
+ *  - DenseMatrix: precedence graph of a random matrix with a finite diagonal,
+ *    so every node has a self-loop. The other entries are random, so the
+ *    graph is not guaranteed to be strongly connected.
+ */
+enum class GraphFamily { RandomSparse, Grid, SDF, DenseMatrix };
+
+const std::vector<GraphFamily> &allGraphFamilies();
+
+std::string graphFamilyName(GraphFamily family);
+
+/**
+ * Parse a family name as produced by graphFamilyName. Throws an MPException
+ * if the name is unknown.
+ */
+GraphFamily graphFamilyFromName(const std::string &name);
+
+/**
+ * Generate a graph of the given family with approximately the given number
+ * of edges.
+ */
+Graphs::MCMgraph
+generateGraph(GraphFamily family, unsigned int numberOfEdges, unsigned int seed);
+
+/**
+ * Max-plus automaton with the given number of states and average out-degree.
+ * States are labeled (i, 0), the initial state is (0, 0) and the edges are
+ * labeled with one of numberOfModes modes named m0, m1, ...
+ */
+std::unique_ptr<MaxPlusAutomaton> generateMaxPlusAutomaton(unsigned int numberOfStates,
+                                                           unsigned int outDegree,
+                                                           unsigned int numberOfModes,
+                                                           unsigned int seed);
+
+/**
+ * Max-plus automaton with rewards as generateMaxPlusAutomaton; rewards are
+ * integers in [1, 10].
+ */
+std::unique_ptr<MaxPlusAutomatonWithRewards>
+generateMaxPlusAutomatonWithRewards(unsigned int numberOfStates,
+                                    unsigned int outDegree,
+                                    unsigned int numberOfModes,
+                                    unsigned int seed);
+
+/**
+ * Ratio game with the given number of states and average out-degree. Every
+ * state is assigned to player 0 or player 1 with equal probability.
+ */
+std::unique_ptr<MaxPlusGameAutomatonWithRewards>
+generateGame(unsigned int numberOfStates, unsigned int outDegree, unsigned int seed);
+
+/**
+ * SMPLS with numberOfModes square mode matrices of size matrixSize (each with
+ * a finite diagonal and the given density) and a mode automaton with the
+ * given number of states and average out-degree, with initial state 0.
+ */
+std::unique_ptr<SMPLS::SMPLS> generateSMPLS(unsigned int numberOfModes,
+                                            unsigned int matrixSize,
+                                            CDouble density,
+                                            unsigned int numberOfFSMStates,
+                                            unsigned int outDegree,
+                                            unsigned int seed);
+
+} // namespace MaxPlus::Generators
+
+#endif
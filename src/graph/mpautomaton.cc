@@ -1,6 +1,6 @@
 #include "graph/mpautomaton.h"
 #include "base/analysis/mcm/mcm.h"
-#include "base/analysis/mcm/mcmyto.h"
+#include "base/analysis/mcm/mcmgraph.h"
 #include "base/basic_types.h"
 #include <memory>
 
@@ -15,15 +15,14 @@ CDouble MaxPlusAutomatonWithRewards::calculateMCR() {
 
     std::map<const ::MaxPlus::FSM::Abstract::State *, MCMnode *> nodeMap;
 
-    for (const auto &s : this->getStates()) {
+    for (const auto *s : this->getTypedStates()) {
         auto *n = g.addNode(nId++);
-        nodeMap[&(*(s.second))] = n;
+        nodeMap[s] = n;
     }
 
     CId eId = 0;
-    for (const auto &s : this->getStates()) {
-        for (const auto *e : (s.second)->getOutgoingEdges()) {
-            const auto *mpae = dynamic_cast<MPAREdgeRef>(e);
+    for (const auto *s : this->getTypedStates()) {
+        for (const auto *mpae : s->getTypedOutgoingEdges()) {
             g.addEdge(eId++,
                       *nodeMap[(mpae->getSource())],
                       *nodeMap[(mpae->getDestination())],
@@ -32,10 +31,7 @@ CDouble MaxPlusAutomatonWithRewards::calculateMCR() {
         }
     }
 
-    std::vector<const MCMedge *> cycle;
-    CDouble mcr = maxCycleRatioAndCriticalCycleYoungTarjanOrlin(g, &cycle);
-
-    return mcr;
+    return maximumCycleRatio(g);
 }
 
 CDouble MaxPlusAutomatonWithRewards::calculateMCRAndCycle(
@@ -46,27 +42,27 @@ CDouble MaxPlusAutomatonWithRewards::calculateMCRAndCycle(
     CId nId = 0;
     std::map<const ::MaxPlus::FSM::Abstract::State *, MCMnode *> nodeMap;
 
-    for (const auto &s : this->getStates()) {
+    for (const auto *s : this->getTypedStates()) {
         auto *n = g.addNode(nId++);
-        nodeMap[&(*(s.second))] = n;
+        nodeMap[s] = n;
     }
 
     CId eId = 0;
     std::map<const MCMedge *, MPAREdgeRef> edgeMap;
 
-    for (const auto &s : this->getStates()) {
-        for (const auto *e : (s.second)->getOutgoingEdges()) {
-            const auto *mpae = dynamic_cast<MPAREdgeRef>(e);
-            g.addEdge(eId++,
-                      *nodeMap[mpae->getSource()],
-                      *nodeMap[mpae->getDestination()],
-                      static_cast<CDouble>(mpae->getLabel().delay),
-                      mpae->getLabel().reward);
+    for (const auto *s : this->getTypedStates()) {
+        for (const auto *mpae : s->getTypedOutgoingEdges()) {
+            const auto *mcmEdge = g.addEdge(eId++,
+                                            *nodeMap[mpae->getSource()],
+                                            *nodeMap[mpae->getDestination()],
+                                            static_cast<CDouble>(mpae->getLabel().delay),
+                                            mpae->getLabel().reward);
+            edgeMap[mcmEdge] = mpae;
         }
     }
 
     std::vector<const MCMedge *> mcmCycle;
-    CDouble mcr = maxCycleRatioAndCriticalCycleYoungTarjanOrlin(g, &mcmCycle);
+    CDouble mcr = maximumCycleRatio(g, &mcmCycle);
     if (cycle != nullptr) {
         for (const auto *e : mcmCycle) {
             (*cycle).push_back(edgeMap[e]);
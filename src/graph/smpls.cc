@@ -8,15 +8,6 @@
 using namespace ::MaxPlus::FSM;
 using namespace MaxPlus;
 
-using ELSEdge = ::MaxPlus::FSM::Labeled::Edge<CId, MPString>;
-using ELSEdgeRef = ::MaxPlus::FSM::Labeled::EdgeRef<CId, MPString>;
-using ELSState = ::MaxPlus::FSM::Labeled::State<CId, MPString>;
-using ELSStateRef = ::MaxPlus::FSM::Labeled::StateRef<CId, MPString>;
-using ELSSetOfStates = ::MaxPlus::FSM::Labeled::SetOfStates<CId, MPString>;
-using ELSSetOfEdges = ::MaxPlus::FSM::Abstract::SetOfEdges;
-using ELSSetOfEdgeRefs = ::MaxPlus::FSM::Abstract::SetOfEdgeRefs;
-using ELSSetOfStateRefs = ::MaxPlus::FSM::Abstract::SetOfStateRefs;
-
 namespace MaxPlus::SMPLS {
 
 // destructor is put deliberately into the cc source to ensure the class vtable is accessible
@@ -24,69 +15,9 @@ namespace MaxPlus::SMPLS {
 
 EdgeLabeledModeFSM::~EdgeLabeledModeFSM() = default;
 
-/*removes states of the fsm with no outgoing edges.*/
-// TODO (Marc Geilen) carefully check and test and move to fsm
-void EdgeLabeledModeFSM::removeDanglingStates() {
-
-    // temporary sets of states and edges
-    ELSSetOfEdgeRefs edgesToBeRemoved;
-    ELSSetOfStateRefs statesToBeRemoved;
-
-    // const ELSSetOfStates& elsStates = this->getStates();
-    const auto &elsEdges = dynamic_cast<const ELSSetOfEdges &>(this->getEdges());
-
-    /*go through all edges and find all edges that end in
-    dangling states. Also store dangling states.*/
-    for (const auto &it : elsEdges) {
-
-        const auto *e = dynamic_cast<ELSEdgeRef>(&(*it.second));
-        const auto &s = dynamic_cast<ELSStateRef>(e->getDestination());
-        const auto &oEdges = dynamic_cast<const ELSSetOfEdges &>(s->getOutgoingEdges());
-        if (oEdges.empty()) {
-            edgesToBeRemoved.insert(e);
-            statesToBeRemoved.insert(s);
-        }
-    }
-
-    while (!edgesToBeRemoved.empty()) {
-
-        // remove dangling states
-        for (const auto *srIt : statesToBeRemoved) {
-            this->removeState(dynamic_cast<const ELSState &>(*srIt));
-        }
-
-        // remove edges ending in dangling states
-        // remove edges ending in dangling states from the outgoing edges of their source states
-        for (const auto *erIt : edgesToBeRemoved) {
-            const auto &e = dynamic_cast<const ELSEdge &>(*erIt);
-            this->removeEdge(e);
-            const auto *const s = dynamic_cast<ELSStateRef>(e.getSource());
-
-            const auto *ms = dynamic_cast<ELSStateRef>(s);
-            this->removeEdge(e);
-        }
-
-        // empty the temporary sets
-        edgesToBeRemoved.clear();
-        statesToBeRemoved.clear();
-
-        // elsStates = this->getStates();
-        const ELSSetOfEdges &elsEdges2 = this->getEdges();
-
-        /*go through all edges and find all edges that end in
-        dangling states. Also store dangling states.*/
-        for (const auto &it : elsEdges2) {
-
-            const auto *e = dynamic_cast<ELSEdgeRef>(&(*(it.second)));
-            const auto *const s = dynamic_cast<ELSStateRef>(e->getDestination());
-            const auto &oEdges = dynamic_cast<const ELSSetOfEdges &>(s->getOutgoingEdges());
-            if (oEdges.empty()) {
-                edgesToBeRemoved.insert(e);
-                statesToBeRemoved.insert(s);
-            }
-        }
-    }
-}
+/*removes the states of the fsm from which every path ends in a state
+without outgoing edges.*/
+void EdgeLabeledModeFSM::removeDanglingStates() { this->trim(false, true); }
 
 namespace {
 
@@ -133,16 +64,11 @@ std::unique_ptr<MaxPlusAutomaton> SMPLS::convertToMaxPlusAutomaton() const { //
     //  create the FSM states for every pair of a states of the FSM
     //  and an initial token
 
-    const auto &I = dynamic_cast<const ELSSetOfStateRefs &>(this->elsFSM.getInitialStates());
-    const auto &F = dynamic_cast<const ELSSetOfStateRefs &>(this->elsFSM.getFinalStates());
-    const auto &Q = dynamic_cast<const ELSSetOfStates &>(this->elsFSM.getStates());
-
-    for (const auto &q : Q) {
-        auto &qq = *(q.second);
-        const auto &e = qq.getOutgoingEdges();
+    for (const auto *qq : this->elsFSM.getTypedStates()) {
+        const auto e = qq->getTypedOutgoingEdges();
         unsigned int nrTokens = 0;
         if (!e.empty()) {
-            MPString label = (dynamic_cast<ELSEdgeRef>(*e.begin()))->getLabel();
+            MPString label = (*e.begin())->getLabel();
             auto it = this->mm.find(MPString(label));
             assert(it != this->mm.end());
             nrTokens = it->second->getCols();
@@ -150,21 +76,19 @@ std::unique_ptr<MaxPlusAutomaton> SMPLS::convertToMaxPlusAutomaton() const { //
             nrTokens = (*this->mm.begin()).second->getCols();
         }
         // create a state for (q, k)
-        const CId qId = (dynamic_cast<ELSState &>(qq)).getLabel();
+        const CId qId = qq->getLabel();
         bool isInitial = false;
         bool isFinal = false;
         // if els state is initial
-        for (const auto &i : I) {
-            CId iId = (dynamic_cast<const ELSState &>(*i)).getLabel();
-            if (iId == qId) {
+        for (const auto *i : this->elsFSM.getTypedInitialStates()) {
+            if (i->getLabel() == qId) {
                 isInitial = true;
                 break;
             }
         }
         // if els state is final
-        for (const auto &f : F) {
-            CId fId = (dynamic_cast<const ELSState &>(*f)).getLabel();
-            if (fId == qId) {
+        for (const auto *f : this->elsFSM.getTypedFinalStates()) {
+            if (f->getLabel() == qId) {
                 isFinal = true;
                 break;
             }
@@ -189,17 +113,14 @@ std::unique_ptr<MaxPlusAutomaton> SMPLS::convertToMaxPlusAutomaton() const { //
     // to (q2,m) labelled with d.
 
     // for every state of the fsm...
-    for (const auto &q : Q) {
-        auto &q1 = dynamic_cast<ELSState &>(*(q.second));
-        CId q1Id = q1.getLabel();
+    for (const auto *q1 : this->elsFSM.getTypedStates()) {
+        CId q1Id = q1->getLabel();
 
         std::map<size_t, MPAStateRef> q1StateMap;
 
         // for every outgoing edge of the state
-        const auto &t = dynamic_cast<const ELSSetOfEdgeRefs &>(q1.getOutgoingEdges());
-        for (const auto *e : t) {
-            const auto *tr = dynamic_cast<ELSEdgeRef>(e);
-            CId q2Id = dynamic_cast<ELSStateRef>(tr->getDestination())->getLabel();
+        for (const auto *tr : q1->getTypedOutgoingEdges()) {
+            CId q2Id = tr->getDestination()->getLabel();
             MPString sc = tr->getLabel();
             const Matrix& Ms = *(this->mm.at(sc));
             size_t r = Ms.getRows();
@@ -278,14 +199,12 @@ bool SMPLSwithEvents::isConsistent() {
     }
     EventList eventList;
 
-    const auto &I = this->ioa->getInitialStates();
-
     const auto &finalStates = this->ioa->getFinalStates();
 
     std::map<IOAStateRef, EventList> visited;
     MPString errMsg = "";
-    for (const auto &i : I) {
-        isConsistentUtil(*dynamic_cast<IOAStateRef>(i), eventList, finalStates, errMsg, visited);
+    for (const auto *i : this->ioa->getTypedInitialStates()) {
+        isConsistentUtil(*i, eventList, finalStates, errMsg, visited);
     }
 
     if (!errMsg.empty()) {
@@ -308,21 +227,16 @@ std::unique_ptr<MaxPlusAutomaton> SMPLSwithEvents::convertToMaxPlusAutomaton() {
 
     // create the elsFsm with the same state structure but we change the matrices in a depth-first
     // search
-    const auto &I = dynamic_cast<const IOASetOfStates &>(this->ioa->getStates());
-    for (const auto &i : I) {
-        this->elsFSM.addState(dynamic_cast<IOAState &>(*(i.second)).getLabel());
+    for (const auto *s : this->ioa->getTypedStates()) {
+        this->elsFSM.addState(s->getLabel());
     }
 
-    const auto &I2 = this->ioa->getInitialStates();
-    for (const auto &i : I2) {
-        const auto *s = dynamic_cast<IOAStateRef>(i);
+    for (const auto *s : this->ioa->getTypedInitialStates()) {
         prepareMatrices(*s, eventList, visitedEdges);
         const auto *sr = this->elsFSM.getStateLabeled(s->getLabel());
         this->elsFSM.addInitialState(*sr);
     }
-    const auto &I3 = this->ioa->getFinalStates();
-    for (const auto &i : I3) {
-        const auto *s = dynamic_cast<IOAStateRef>(i);
+    for (const auto *s : this->ioa->getTypedFinalStates()) {
         this->elsFSM.addFinalState(*this->elsFSM.getStateLabeled(s->getLabel()));
     }
     return SMPLS::convertToMaxPlusAutomaton();
@@ -380,9 +294,7 @@ Event SMPLSwithEvents::findEventByMode(const Mode &mode) const {
 void SMPLSwithEvents::prepareMatrices(const IOAState &s, // NOLINT(*no-recursion,*cognitive-complexity)
                                       std::multiset<Event> &eventList,
                                       IOASetOfEdgeRefs &visitedEdges) {
-    const auto &adj = s.getOutgoingEdges();
-    for (const auto *i : adj) {
-        const auto *e = dynamic_cast<IOAEdgeRef>(i);
+    for (const auto *e : s.getTypedOutgoingEdges()) {
         if (visitedEdges.count(e) > 0) {
             continue;
         }
@@ -395,8 +307,7 @@ void SMPLSwithEvents::prepareMatrices(const IOAState &s, // NOLINT(*no-recursion
         // add the edge with unique name between the corresponding states
         this->elsFSM.addEdge(*this->elsFSM.getStateLabeled(s.getLabel()),
                              modeName,
-                             *this->elsFSM.getStateLabeled(
-                                     (dynamic_cast<IOAStateRef>(e->getDestination()))->getLabel()));
+                             *this->elsFSM.getStateLabeled(e->getDestination()->getLabel()));
 
         // make a copy so that child node can not modify the parent nodes list of events
         // only adds and removes and passes it to it's children
@@ -542,7 +453,7 @@ void SMPLSwithEvents::prepareMatrices(const IOAState &s, // NOLINT(*no-recursion
         biggestMatrixSize =
                 std::max(biggestMatrixSize, std::max(sMatrix->getCols(), sMatrix->getRows()));
 
-        prepareMatrices(*dynamic_cast<IOAStateRef>(e->getDestination()), eList, visitedEdges);
+        prepareMatrices(*e->getDestination(), eList, visitedEdges);
     }
 }
 
@@ -587,13 +498,11 @@ void SMPLSwithEvents::isConsistentUtil(const IOAState &s, // NOLINT(*no-recursio
         }
     } else // If current state is not final
     {
-        const auto &adj = s.getOutgoingEdges();
-        for (const auto *i : adj) {
+        for (const auto *e : s.getTypedOutgoingEdges()) {
             // make a copy so that child node can not modify the parent nodes list
             // only adds and removes and passes it to its children
             EventList eList(eventList);
 
-            const auto *e = dynamic_cast<IOAEdgeRef>(i);
             const OutputAction output = e->getLabel().second;
             const InputAction input = e->getLabel().first;
             if (!input.empty()) {
@@ -637,9 +546,7 @@ void SMPLSwithEvents::isConsistentUtil(const IOAState &s, // NOLINT(*no-recursio
                     }
                 }
             }
-            const auto *const s2 = dynamic_cast<IOAStateRef>(e->getDestination());
-
-            isConsistentUtil(*s2, eList, finalStates, errMsg, visited);
+            isConsistentUtil(*e->getDestination(), eList, finalStates, errMsg, visited);
         }
     }
 }
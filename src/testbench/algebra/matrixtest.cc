@@ -12,6 +12,7 @@ void MatrixTest::Run() {
     this->test_SubMatrix();
     this->test_Equality();
     this->test_Addition();
+    this->test_Eigenvalue();
 };
 
 int MatrixTest::test_SetMPTimeInMatrix() {
@@ -114,3 +115,17 @@ int MatrixTest::test_Addition() {
 
     return 0;
 }
+
+int MatrixTest::test_Eigenvalue() {
+    std::cout << "Running test: Eigenvalue" << std::endl;
+    Matrix m(3, 3, MatrixFill::MinusInfinity);
+    ASSERT_EQUAL(static_cast<CDouble>(MP_MINUS_INFINITY), m.mp_eigenvalue());
+
+    m.put(0, 1, MPTime(2.0));
+    m.put(1, 0, MPTime(4.0));
+    m.put(1, 2, MPTime(1.0));
+    m.put(2, 2, MPTime(2.5));
+    ASSERT_APPROX_EQUAL(3.0, m.mp_eigenvalue(), 1e-6);
+
+    return 0;
+}
@@ -19,5 +19,6 @@ public:
     int test_SubMatrix();
     int test_Equality();
     int test_Addition();
+    int test_Eigenvalue();
     virtual void Run();
 };
@@ -1,6 +1,7 @@
 #include <algorithm>
 
 #include "algebra/mpsparsematrix.h"
+#include "generators.h"
 #include "sparsematrixtest.h"
 #include "testing.h"
 
@@ -14,6 +15,7 @@ void SparseMatrixTest::Run() {
     this->test_GetPutMatrix();
     this->test_Addition();
     this->test_Multiplication();
+    this->test_Generated();
 };
 
 int SparseMatrixTest::test_Vectors() {
@@ -149,3 +151,28 @@ int SparseMatrixTest::test_Multiplication() {
 
     return 0;
 }
+
+int SparseMatrixTest::test_Generated() {
+    std::cout << "Running test: SparseGenerated" << std::endl;
+
+    // a large block-structured matrix with constant blocks
+    SparseMatrix M = Generators::generateSparseMatrix(100000, 100000, 0.5, 5, 10);
+    ASSERT_THROW(M.getRowSize() == 100000);
+    ASSERT_THROW(M.getColumnSize() == 100000);
+    for (unsigned int br = 0; br < 10; br++) {
+        for (unsigned int bc = 0; bc < 10; bc++) {
+            MPTime v = M.get(br * 10000, bc * 10000);
+            ASSERT_THROW(M.get((br * 10000) + 9999, (bc * 10000) + 9999) == v);
+        }
+    }
+
+    // dense block-diagonal matrix: nothing outside the diagonal blocks
+    Matrix D = Generators::generateMatrix(40, 40, 1.0, 5, 4);
+    for (unsigned int r = 0; r < 40; r++) {
+        for (unsigned int c = 0; c < 40; c++) {
+            ASSERT_THROW((r / 10 == c / 10) != D.get(r, c).isMinusInfinity());
+        }
+    }
+
+    return 0;
+}
@@ -20,4 +20,5 @@ public:
     int test_GetPutMatrix();
     int test_Addition();
     int test_Multiplication();
+    int test_Generated();
 };
@@ -1,24 +1,47 @@
 #include <algorithm>
 
 #include "base/analysis/mcm/mcm.h"
+#include "base/analysis/mcm/mcmapproximate.h"
+#include "base/analysis/mcm/mcmbatch.h"
+#include "base/analysis/mcm/mcmcritical.h"
 #include "base/analysis/mcm/mcmdg.h"
+#include "base/analysis/mcm/mcmexact.h"
 #include "base/analysis/mcm/mcmgraph.h"
+#include "base/analysis/mcm/mcmincremental.h"
+#include "base/exception/exception.h"
+#include "generators.h"
 #include "mcmtest.h"
 #include "testing.h"
 #include <array>
+#include <cfloat>
 #include <base/analysis/mcm/mcmhoward.h>
 #include <base/analysis/mcm/mcmyto.h>
+#include <numeric>
 #include <random>
+#include <set>
 
 using namespace MaxPlus;
 using namespace Graphs;
+using namespace MaxPlus::Generators;
 
 void MCMTest::Run() {
     this->test_dg();
     this->test_howard();
+    this->test_howard_warm_start();
+    this->test_howard_ratio();
+    this->test_automatic();
     this->test_karp();
     this->test_yto();
     this->test_prune();
+    this->test_generated_graphs();
+    this->test_longest_delay_edges();
+    this->test_incremental();
+    this->test_batch();
+    this->test_exact();
+    this->test_approximate();
+    this->test_longest_paths();
+    this->test_compiled_yto();
+    this->test_critical_graph();
 };
 
 // NOLINTBEGIN(*magic-numbers,*simplify-boolean-expr)
@@ -116,6 +139,14 @@ void MCMTest::test_dg() { // NOLINT(*to-static)
     MCMgraph g2 = makeGraph2();
     result = mcmDG(g2);
     ASSERT_EQUAL(-INFINITY, result);
+
+    // fractional weights
+    for (unsigned int seed = 1; seed <= 5; seed++) {
+        MCMgraph g = makeRandomGraph(200, 1000, seed);
+        MCMgraph h = makeRandomGraph(200, 1000, seed);
+        CDouble expected = maximumCycleMeanHowardGeneral(h, nullptr);
+        ASSERT_APPROX_EQUAL(expected, g.calculateMaximumCycleMeanDasdanGupta(), 1e-9);
+    }
 }
 
 /// Test MCM Howard.
@@ -165,6 +196,243 @@ void MCMTest::test_howard() { // NOLINT(*to-static)
     ASSERT_EQUAL(-INFINITY, result);
 }
 
+/// Test warm-starting Howard with the policy and bias of an earlier run.
+void MCMTest::test_howard_warm_start() { // NOLINT(*to-static)
+    std::cout << "Running test: MCM-Howard-warm-start\n";
+
+    MCMgraph g = makeRandomGraph(200, 2000, 7);
+    auto nrNodes = static_cast<int>(g.numberOfNodes());
+    auto nrEdges = static_cast<int>(g.numberOfEdges());
+
+    std::unique_ptr<std::vector<int>> ij = nullptr;
+    std::unique_ptr<std::vector<CDouble>> A = nullptr;
+    std::unique_ptr<std::vector<CDouble>> chi = nullptr;
+    std::unique_ptr<std::vector<CDouble>> v = nullptr;
+    std::unique_ptr<std::vector<int>> policy = nullptr;
+    int nr_iterations = 0;
+    int nr_components = 0;
+
+    convertMCMgraphToMatrix(g, &ij, &A);
+    Howard(*ij, *A, nrNodes, nrEdges, &chi, &v, &policy, &nr_iterations, &nr_components);
+
+    // lower the weight of the policy arcs on the critical cycle, such that the
+    // old policy is no longer optimal and the warm start has to improve it
+    int critical = 0;
+    for (int i = 1; i < nrNodes; i++) {
+        if ((*chi)[i] > (*chi)[critical]) {
+            critical = i;
+        }
+    }
+    std::vector<bool> seen(nrNodes, false);
+    while (!seen[critical]) {
+        seen[critical] = true;
+        critical = (*policy)[critical];
+    }
+    int changed = 0;
+    int i = critical;
+    do {
+        for (int k = 0; k < nrEdges; k++) {
+            if ((*ij)[2 * k] == i && (*ij)[(2 * k) + 1] == (*policy)[i]) {
+                (*A)[k] -= 1.0;
+                changed++;
+            }
+        }
+        i = (*policy)[i];
+    } while (i != critical);
+    ASSERT_THROW(changed > 0);
+
+    std::unique_ptr<std::vector<CDouble>> coldChi = nullptr;
+    std::unique_ptr<std::vector<CDouble>> coldV = nullptr;
+    std::unique_ptr<std::vector<int>> coldPolicy = nullptr;
+    Howard(*ij,
+           *A,
+           nrNodes,
+           nrEdges,
+           &coldChi,
+           &coldV,
+           &coldPolicy,
+           &nr_iterations,
+           &nr_components);
+    int coldRerun = nr_iterations;
+
+    std::unique_ptr<std::vector<CDouble>> warmChi = nullptr;
+    std::unique_ptr<std::vector<CDouble>> warmV = nullptr;
+    std::unique_ptr<std::vector<int>> warmPolicy = nullptr;
+    Howard(*ij,
+           *A,
+           nrNodes,
+           nrEdges,
+           &warmChi,
+           &warmV,
+           &warmPolicy,
+           &nr_iterations,
+           &nr_components,
+           policy.get(),
+           v.get());
+
+    ASSERT_THROW(*warmPolicy != *policy);
+    ASSERT_THROW(nr_iterations < coldRerun);
+    ASSERT_THROW(warmChi->at(critical) < chi->at(critical));
+    for (int i = 0; i < nrNodes; i++) {
+        ASSERT_APPROX_EQUAL(coldChi->at(i), warmChi->at(i), 1e-5);
+    }
+
+    // the same through the MCMgraph interface
+    MCMgraph g1 = makeGraph1();
+    std::vector<int> pi;
+    std::vector<CDouble> bias;
+    MCMnode *criticalNode = nullptr;
+    // the critical node lies on the cycle of the policy
+    auto onPolicyCycle = [&pi](CId id) {
+        auto j = static_cast<int>(id);
+        for (size_t step = 0; step < pi.size(); step++) {
+            j = pi[j];
+            if (j == static_cast<int>(id)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    CDouble result = g1.calculateMaximumCycleMeanHoward(&criticalNode, &pi, &bias);
+    ASSERT_APPROX_EQUAL(2.5, result, 1e-5);
+    ASSERT_THROW(onPolicyCycle(criticalNode->id));
+    ASSERT_THROW(pi.size() == 5);
+    ASSERT_THROW(bias.size() == 5);
+
+    g1.getEdge(1)->w = 3.0;
+    result = g1.calculateMaximumCycleMeanHoward(&criticalNode, &pi, &bias);
+    ASSERT_APPROX_EQUAL(2.75, result, 1e-5);
+    ASSERT_THROW(onPolicyCycle(criticalNode->id));
+
+    // node 0 has the maximal cycle mean, but only leads into the critical cycle
+    MCMgraph tail;
+    MCMnode &t0 = *tail.addNode(0);
+    MCMnode &t1 = *tail.addNode(1);
+    MCMnode &t2 = *tail.addNode(2);
+    tail.addEdge(0, t0, t1, 1.0, 1.0);
+    tail.addEdge(1, t1, t2, 5.0, 1.0);
+    tail.addEdge(2, t2, t1, 5.0, 1.0);
+    result = maximumCycleMeanHoward(tail, &criticalNode);
+    ASSERT_APPROX_EQUAL(5.0, result, 1e-5);
+    ASSERT_THROW(criticalNode->id == 1 || criticalNode->id == 2);
+}
+
+/// Test maximum cycle ratio with Howard.
+void MCMTest::test_howard_ratio() { // NOLINT(*to-static)
+    std::cout << "Running test: MCR-Howard\n";
+
+    MCMgraph g1 = makeGraph1();
+    std::vector<const MCMedge *> cycle;
+    CDouble result = maximumCycleRatioHoward(g1, &cycle);
+    ASSERT_APPROX_EQUAL(10.0 / 3.0, result, 1e-5);
+    ASSERT_THROW(cycle.size() == 1);
+    ASSERT_THROW(cycle.at(0)->id == 4);
+
+    result = g1.calculateMaximumCycleRatioAndCriticalCycleHoward(&cycle);
+    ASSERT_APPROX_EQUAL(10.0 / 3.0, result, 1e-5);
+
+    MCMgraph g2 = makeGraph2();
+    result = maximumCycleRatioHoward(g2, &cycle);
+    ASSERT_EQUAL(-INFINITY, result);
+    ASSERT_THROW(cycle.empty());
+
+    // a cycle without delay has an unbounded ratio
+    MCMgraph g3;
+    MCMnode &n0 = *g3.addNode(0);
+    MCMnode &n1 = *g3.addNode(1);
+    g3.addEdge(0, n0, n1, 1.0, 0.0);
+    g3.addEdge(1, n1, n0, 1.0, 0.0);
+    result = maximumCycleRatioHoward(g3, &cycle);
+    ASSERT_EQUAL(INFINITY, result);
+    ASSERT_THROW(cycle.size() == 2);
+
+    // compare with Young-Tarjan-Orlin on (deterministic) pseudo-random graphs
+    for (unsigned int k = 0; k < 10; k++) {
+        MCMgraph gr = makeRandomGraph(1000, 20000, k);
+        CDouble expected = maxCycleRatioYoungTarjanOrlin(gr);
+        result = maximumCycleRatioHoward(gr, &cycle);
+        ASSERT_APPROX_EQUAL(expected, result, 1e-6 * expected);
+
+        // the critical cycle must be a cycle with the reported ratio
+        CDouble w = 0.0;
+        CDouble d = 0.0;
+        for (size_t i = 0; i < cycle.size(); i++) {
+            ASSERT_THROW(cycle[i]->dst == cycle[(i + 1) % cycle.size()]->src);
+            w += cycle[i]->w;
+            d += cycle[i]->d;
+        }
+        ASSERT_APPROX_EQUAL(result, w / d, 1e-6 * result);
+    }
+}
+
+/// Test the algorithm selecting front-end.
+void MCMTest::test_automatic() { // NOLINT(*to-static)
+    std::cout << "Running test: MCM-automatic\n";
+
+    const std::array<MCMAlgorithm, 6> algorithms = {MCMAlgorithm::Automatic,
+                                                    MCMAlgorithm::Karp,
+                                                    MCMAlgorithm::KarpDouble,
+                                                    MCMAlgorithm::Howard,
+                                                    MCMAlgorithm::DasdanGupta,
+                                                    MCMAlgorithm::YoungTarjanOrlin};
+    for (auto algorithm : algorithms) {
+        MCMgraph g1 = makeGraph1();
+        ASSERT_APPROX_EQUAL(2.5, maximumCycleMean(g1, algorithm), 1e-5);
+    }
+
+    // graph 1 has few edges without delay
+    MCMgraph g1 = makeGraph1();
+    ASSERT_THROW(selectMaximumCycleMeanAlgorithm(g1) == MCMAlgorithm::Howard);
+    ASSERT_THROW(selectMaximumCycleMeanAlgorithm(g1, true) == MCMAlgorithm::Howard);
+
+    // dataflow precedence graphs mostly have edges without delay
+    MCMgraph sdf = generateGraph(GraphFamily::SDF, 1000, 1);
+    ASSERT_THROW(selectMaximumCycleMeanAlgorithm(sdf) == MCMAlgorithm::YoungTarjanOrlin);
+    ASSERT_THROW(selectMaximumCycleMeanAlgorithm(sdf, true) == MCMAlgorithm::Howard);
+
+    // dense graphs use Young-Tarjan-Orlin as well
+    MCMgraph dense = generateGraph(GraphFamily::DenseMatrix, 100000, 1);
+    ASSERT_THROW(selectMaximumCycleMeanAlgorithm(dense) == MCMAlgorithm::YoungTarjanOrlin);
+    MCMgraph grid = generateGraph(GraphFamily::Grid, 10000, 1);
+    ASSERT_THROW(selectMaximumCycleMeanAlgorithm(grid) == MCMAlgorithm::Howard);
+
+    // the thresholds can be changed to recalibrate the selection
+    MCMSelectionThresholds defaults = mcmSelectionThresholds();
+    MCMSelectionThresholds t = defaults;
+    t.minZeroDelayShare = 0.0;
+    setMCMSelectionThresholds(t);
+    ASSERT_THROW(selectMaximumCycleMeanAlgorithm(g1) == MCMAlgorithm::YoungTarjanOrlin);
+    t.minZeroDelayShare = 2.0;
+    t.minDensity = INFINITY;
+    setMCMSelectionThresholds(t);
+    ASSERT_THROW(selectMaximumCycleMeanAlgorithm(sdf) == MCMAlgorithm::Howard);
+    ASSERT_THROW(selectMaximumCycleMeanAlgorithm(dense) == MCMAlgorithm::Howard);
+    setMCMSelectionThresholds(defaults);
+
+    std::vector<const MCMedge *> cycle;
+    ASSERT_APPROX_EQUAL(10.0 / 3.0, maximumCycleRatio(g1, &cycle), 1e-5);
+    ASSERT_THROW(cycle.size() == 1);
+    ASSERT_APPROX_EQUAL(
+            10.0 / 3.0, maximumCycleRatio(g1, &cycle, MCMAlgorithm::YoungTarjanOrlin), 1e-5);
+
+    bool thrown = false;
+    try {
+        static_cast<void>(maximumCycleRatio(g1, nullptr, MCMAlgorithm::Karp));
+    } catch (MPException &) {
+        thrown = true;
+    }
+    ASSERT_THROW(thrown);
+
+    MCMgraph g2 = makeGraph2();
+    ASSERT_THROW(selectMaximumCycleMeanAlgorithm(g2) == MCMAlgorithm::Howard);
+    ASSERT_EQUAL(-INFINITY, maximumCycleMean(g2));
+
+    MCMgraph gr = makeRandomGraph(1000, 20000, 3);
+    ASSERT_THROW(selectMaximumCycleMeanAlgorithm(gr) == MCMAlgorithm::Howard);
+    CDouble expected = maxCycleMeanYoungTarjanOrlin(gr);
+    ASSERT_APPROX_EQUAL(expected, maximumCycleMean(gr), 1e-6 * expected);
+}
+
 /// Test MCM Karp.
 void MCMTest::test_karp() { // NOLINT(*to-static)
     std::cout << "Running test: MCM-Karp\n";
@@ -369,6 +637,523 @@ void MCMTest::test_prune() { // NOLINT(*to-static)
     CDouble mcr2 = maxCycleRatioAndCriticalCycleYoungTarjanOrlin(*result, nullptr);
 
     ASSERT_APPROX_EQUAL(mcr1, mcr2, 1e3);
+
+    // parallel edges keep only the Pareto front of (more weight, fewer delays); of the
+    // equal edges 0 and 4 the one with the smallest id is kept
+    MCMgraph parallel;
+    MCMnode &p0 = *parallel.addNode(0);
+    MCMnode &p1 = *parallel.addNode(1);
+    parallel.addEdge(0, p0, p1, 5.0, 1.0);
+    parallel.addEdge(1, p0, p1, 3.0, 1.0);
+    parallel.addEdge(2, p0, p1, 6.0, 2.0);
+    parallel.addEdge(3, p0, p1, 4.0, 2.0);
+    parallel.addEdge(4, p0, p1, 5.0, 1.0);
+    parallel.addEdge(5, p0, p1, 5.0, 3.0);
+    parallel.addEdge(6, p0, p1, 7.0, 3.0);
+    parallel.addEdge(7, p1, p0, 1.0, 1.0);
+    parallel.addEdge(8, p0, p0, 2.0, 1.0);
+    std::unique_ptr<MCMgraph> pruned = parallel.pruneEdges();
+    ASSERT_EQUAL(pruned->getEdges().size(), 5);
+    std::set<CId> kept;
+    for (const auto &e : pruned->getEdges()) {
+        kept.insert(e.id);
+    }
+    ASSERT_THROW(kept == std::set<CId>({0, 2, 6, 7, 8}));
+}
+
+/// Cross-check the algorithms on the generated graph families.
+void MCMTest::test_generated_graphs() { // NOLINT(*to-static)
+    std::cout << "Running test: MCM-generated-graphs\n";
+
+    for (auto family : allGraphFamilies()) {
+        for (unsigned int seed = 1; seed <= 3; seed++) {
+            // generation is deterministic for a given seed, so every algorithm
+            // gets its own copy (Karp's SCC decomposition hides nodes)
+            MCMgraph g1 = generateGraph(family, 500, seed);
+            MCMgraph g2 = generateGraph(family, 500, seed);
+            MCMgraph g3 = generateGraph(family, 500, seed);
+            ASSERT_EQUAL(g1.getEdges().size(), g2.getEdges().size());
+            CDouble expected = maximumCycleMeanKarpGeneral(g1);
+            ASSERT_APPROX_EQUAL(expected, maximumCycleMeanHowardGeneral(g2, nullptr), 1e-6);
+            ASSERT_APPROX_EQUAL(expected, maxCycleMeanYoungTarjanOrlin(g3), 1e-6);
+        }
+    }
+}
+
+/// Test the conversion to a graph in which every visible edge has one delay.
+void MCMTest::test_longest_delay_edges() { // NOLINT(*to-static)
+    std::cout << "Running test: MCM-longest-delay-edges\n";
+
+    // a cycle with three delays and fractional weights
+    MCMgraph g;
+    MCMnode &n0 = *g.addNode(0);
+    MCMnode &n1 = *g.addNode(1);
+    MCMnode &n2 = *g.addNode(2);
+    g.addEdge(0, n0, n1, 1.5, 3.0);
+    g.addEdge(1, n1, n2, 2.25, 0.0);
+    g.addEdge(2, n2, n0, 0.5, 0.0);
+    addLongestDelayEdgesToMCMgraph(g);
+    for (const auto &e : g.getEdges()) {
+        ASSERT_THROW(!e.visible || e.d == 1.0);
+    }
+    ASSERT_APPROX_EQUAL(4.25 / 3.0, maximumCycleMeanHowardGeneral(g, nullptr), 1e-9);
+
+    // the mean of the converted graph is the cycle ratio of the original
+    for (unsigned int seed = 1; seed <= 3; seed++) {
+        MCMgraph h = generateGraph(GraphFamily::SDF, 2000, seed);
+        CDouble expected = maximumCycleRatioHoward(h);
+        // the generated graphs have no edges with more than one delay
+        const size_t nrEdges = h.getEdges().size();
+        size_t nrDelayed = 0;
+        for (const auto &e : h.getEdges()) {
+            nrDelayed += static_cast<size_t>(e.d);
+        }
+        addLongestDelayEdgesToMCMgraph(h);
+        // every added edge ends in the source of a delayed edge, which
+        // bounds the size of the result
+        std::set<CId> sources;
+        for (const auto &e : h.getEdges()) {
+            if (e.visible) {
+                sources.insert(e.src->id);
+            }
+        }
+        for (const auto &e : h.getEdges()) {
+            ASSERT_THROW(e.id < nrEdges || sources.count(e.dst->id) == 1);
+        }
+        ASSERT_THROW(h.nrVisibleEdges() <= nrDelayed * (sources.size() + 1));
+        ASSERT_APPROX_EQUAL(expected, maximumCycleMeanHowardGeneral(h, nullptr), 1e-6);
+    }
+}
+
+/// Test the incremental engine against recomputation from scratch.
+void MCMTest::test_incremental() { // NOLINT(*to-static)
+    std::cout << "Running test: MCM-incremental\n";
+
+    struct Edge {
+        CId src;
+        CId dst;
+        CDouble w;
+        CDouble d;
+    };
+
+    for (bool ratio : {false, true}) {
+        MCMgraph g = generateGraph(ratio ? GraphFamily::SDF : GraphFamily::RandomSparse, 2000, 1);
+        if (ratio) {
+            // every cycle of the SDF graphs has a delay, make all delays positive
+            for (auto &e : g.getEdges()) {
+                e.d += 0.5;
+            }
+        }
+        std::map<CId, Edge> edges;
+        std::map<CId, unsigned int> outDegree;
+        CId nrNodes = 0;
+        for (const auto &e : g.getEdges()) {
+            edges[e.id] = {e.src->id, e.dst->id, e.w, e.d};
+            outDegree[e.src->id]++;
+        }
+        nrNodes = static_cast<CId>(g.getNodes().size());
+
+        IncrementalMCM engine(g, ratio);
+        ASSERT_APPROX_EQUAL(ratio ? maximumCycleRatioHoward(g) : maximumCycleMeanHowardGeneral(g, nullptr),
+                            engine.value(),
+                            1e-6);
+
+        std::mt19937 rng(5);
+        CId nextId = static_cast<CId>(edges.size());
+        const unsigned int nrUpdates = 300;
+        for (unsigned int k = 0; k < nrUpdates; k++) {
+            // pick a random existing edge
+            auto it = edges.begin();
+            std::advance(it, rng() % edges.size());
+            CDouble result = 0;
+            switch (rng() % 3) {
+            case 0:
+                it->second.w = static_cast<CDouble>(1 + (rng() % 1000));
+                result = engine.setWeight(it->first, it->second.w);
+                break;
+            case 1: {
+                Edge e = {static_cast<CId>(rng() % nrNodes),
+                          static_cast<CId>(rng() % nrNodes),
+                          static_cast<CDouble>(1 + (rng() % 1000)),
+                          1.0};
+                edges[nextId] = e;
+                outDegree[e.src]++;
+                result = engine.insertEdge(nextId++, e.src, e.dst, e.w, e.d);
+                break;
+            }
+            default:
+                if (outDegree[it->second.src] == 1) {
+                    continue;
+                }
+                outDegree[it->second.src]--;
+                result = engine.removeEdge(it->first);
+                edges.erase(it);
+            }
+            ASSERT_EQUAL(result, engine.value());
+
+            if (k % 50 == 49) {
+                MCMgraph h;
+                std::vector<MCMnode *> nodes;
+                for (CId n = 0; n < nrNodes; n++) {
+                    nodes.push_back(h.addNode(n));
+                }
+                for (const auto &[id, e] : edges) {
+                    h.addEdge(id, *nodes[e.src], *nodes[e.dst], e.w, e.d);
+                }
+                CDouble expected =
+                        ratio ? maximumCycleRatioHoward(h) : maximumCycleMeanHowardGeneral(h, nullptr);
+                ASSERT_APPROX_EQUAL(expected, engine.value(), 1e-6);
+
+                // the critical cycle has the maximal mean or ratio
+                CDouble weight = 0;
+                CDouble delay = 0;
+                for (CId id : engine.criticalCycle()) {
+                    weight += edges[id].w;
+                    delay += ratio ? edges[id].d : 1.0;
+                }
+                ASSERT_APPROX_EQUAL(expected, weight / delay, 1e-6);
+            }
+        }
+        // most updates are handled without rerunning Howard's algorithm
+        ASSERT_THROW(engine.nrRecomputations() < nrUpdates / 2);
+    }
+}
+
+/// Test the batched analysis against the analysis of the individual scenarios.
+void MCMTest::test_batch() { // NOLINT(*to-static)
+    std::cout << "Running test: MCM-batch\n";
+
+    std::mt19937 rng(7);
+    const size_t nrScenarios = 37;
+    for (auto family : allGraphFamilies()) {
+        for (unsigned int size : {100U, 1000U}) {
+            MCMgraph g = generateGraph(family, size, size);
+            for (auto &e : g.getEdges()) {
+                e.d += 0.5;
+            }
+            std::vector<std::vector<CDouble>> weights(nrScenarios);
+            std::vector<CDouble> means;
+            std::vector<CDouble> ratios;
+            for (auto &row : weights) {
+                for (auto &e : g.getEdges()) {
+                    e.w = static_cast<CDouble>(rng() % 1000) / 8.0;
+                    row.push_back(e.w);
+                }
+                means.push_back(maximumCycleMeanHowardGeneral(g, nullptr));
+                ratios.push_back(maximumCycleRatioHoward(g));
+            }
+
+            for (unsigned int nrThreads : {1U, 3U}) {
+                for (auto algorithm :
+                     {MCMAlgorithm::Automatic, MCMAlgorithm::Karp, MCMAlgorithm::Howard}) {
+                    std::vector<CDouble> result = maximumCycleMeans(g, weights, algorithm, nrThreads);
+                    ASSERT_EQUAL(result.size(), nrScenarios);
+                    for (size_t s = 0; s < nrScenarios; s++) {
+                        ASSERT_APPROX_EQUAL(means[s], result[s], 1e-6);
+                    }
+                }
+                std::vector<CDouble> result = maximumCycleRatios(g, weights, nrThreads);
+                for (size_t s = 0; s < nrScenarios; s++) {
+                    ASSERT_APPROX_EQUAL(ratios[s], result[s], 1e-6);
+                }
+            }
+        }
+    }
+
+    // a cycle without delay
+    MCMgraph g = makeGraph1();
+    for (auto &e : g.getEdges()) {
+        e.d = 0.0;
+    }
+    std::vector<std::vector<CDouble>> weights(2, std::vector<CDouble>(g.getEdges().size(), 1.0));
+    ASSERT_THROW(maximumCycleRatios(g, weights) == std::vector<CDouble>(2, INFINITY));
+
+    // the weights must match the edges
+    weights[1].pop_back();
+    bool thrown = false;
+    try {
+        maximumCycleMeans(g, weights);
+    } catch (MPException &) {
+        thrown = true;
+    }
+    ASSERT_THROW(thrown);
+}
+
+/// Test the exact cycle means and ratios.
+void MCMTest::test_exact() { // NOLINT(*to-static)
+    std::cout << "Running test: MCM-exact\n";
+
+    // two cycles whose ratios differ by less than the tolerance of Howard
+    MCMgraph g;
+    MCMnode &n0 = *g.addNode(0);
+    MCMnode &n1 = *g.addNode(1);
+    MCMnode &n2 = *g.addNode(2);
+    g.addEdge(0, n0, n1, 1000000002.0, 1000000001.0);
+    g.addEdge(1, n1, n0, 0.0, 0.0);
+    g.addEdge(2, n0, n2, 1000000001.0, 1000000000.0);
+    g.addEdge(3, n2, n0, 0.0, 0.0);
+    for (auto algorithm : {MCMAlgorithm::Howard, MCMAlgorithm::YoungTarjanOrlin}) {
+        std::vector<const MCMedge *> cycle;
+        CFraction r = maximumCycleRatioExact(g, &cycle, algorithm);
+        ASSERT_EQUAL(r.numerator(), 1000000001);
+        ASSERT_EQUAL(r.denominator(), 1000000000);
+        ASSERT_EQUAL(cycle.size(), 2);
+    }
+    CFraction mean = maximumCycleMeanExact(g);
+    ASSERT_EQUAL(mean.numerator(), 500000001);
+    ASSERT_EQUAL(mean.denominator(), 1);
+
+    // the exact results agree with the floating point results and the cycles
+    for (auto family : allGraphFamilies()) {
+        for (unsigned int seed = 1; seed <= 3; seed++) {
+            MCMgraph h = generateGraph(family, 1000, seed);
+            for (auto &e : h.getEdges()) {
+                e.d += 1.0;
+            }
+            for (bool ratio : {false, true}) {
+                std::vector<const MCMedge *> cycle;
+                CFraction r = ratio ? maximumCycleRatioExact(h, &cycle, MCMAlgorithm::Howard)
+                                    : maximumCycleMeanExact(h, &cycle, MCMAlgorithm::Howard);
+                CDouble expected =
+                        ratio ? maximumCycleRatioHoward(h) : maximumCycleMeanHowardGeneral(h, nullptr);
+                ASSERT_APPROX_EQUAL(expected, r.value(), 1e-6);
+                std::int64_t w = 0;
+                std::int64_t d = 0;
+                for (const auto *e : cycle) {
+                    w += static_cast<std::int64_t>(e->w);
+                    d += ratio ? static_cast<std::int64_t>(e->d) : 1;
+                }
+                ASSERT_EQUAL(w * r.denominator(), d * r.numerator());
+                ASSERT_THROW(std::gcd(r.numerator(), r.denominator()) == 1);
+            }
+        }
+    }
+
+    // weights must be integers
+    g.getEdges().front().w = 0.5;
+    bool thrown = false;
+    try {
+        maximumCycleRatioExact(g);
+    } catch (MPException &) {
+        thrown = true;
+    }
+    ASSERT_THROW(thrown);
+}
+
+/// Test the bounds of the approximate analysis.
+void MCMTest::test_approximate() { // NOLINT(*to-static)
+    std::cout << "Running test: MCM-approximate\n";
+
+    for (auto family : allGraphFamilies()) {
+        for (unsigned int seed = 1; seed <= 3; seed++) {
+            MCMgraph g = generateGraph(family, 2000, seed);
+            for (bool ratio : {false, true}) {
+                CDouble expected =
+                        ratio ? maximumCycleRatioHoward(g) : maximumCycleMeanHowardGeneral(g, nullptr);
+                ApproximateMCM approximation(g, ratio);
+                ASSERT_THROW(approximation.lowerBound() <= expected + 1e-9);
+
+                // no budget leaves valid bounds
+                ASSERT_THROW(!approximation.refine(1e-3, std::chrono::nanoseconds(0)));
+                std::atomic<bool> cancel(true);
+                ASSERT_THROW(!approximation.refine(1e-3, std::chrono::nanoseconds::max(), &cancel));
+
+                ASSERT_THROW(approximation.refine(1e-3));
+                CDouble lower = approximation.lowerBound();
+                CDouble upper = approximation.upperBound();
+                ASSERT_THROW(lower <= expected + 1e-9 && expected <= upper + 1e-9);
+                ASSERT_THROW(upper - lower <= 1e-3 * std::fabs(upper));
+
+                // the critical cycle attains the lower bound
+                CDouble weight = 0.0;
+                CDouble delay = 0.0;
+                for (const auto *e : approximation.criticalCycle()) {
+                    weight += e->w;
+                    delay += ratio ? e->d : 1.0;
+                }
+                ASSERT_APPROX_EQUAL(lower, weight / delay, 1e-9);
+
+                // refining further keeps the bounds nested
+                approximation.refine(0.0);
+                ASSERT_THROW(approximation.lowerBound() >= lower);
+                ASSERT_THROW(approximation.upperBound() <= upper);
+                ASSERT_APPROX_EQUAL(expected, approximation.lowerBound(), 1e-6);
+            }
+        }
+    }
+}
+
+/// Test the longest paths against a full sweep Bellman-Ford.
+void MCMTest::test_longest_paths() { // NOLINT(*to-static)
+    std::cout << "Running test: MCM-longest-paths\n";
+
+    for (auto family : allGraphFamilies()) {
+        MCMgraph g = generateGraph(family, 1000, 1);
+        CDouble mu = maximumCycleMeanHowardGeneral(g, nullptr);
+        std::vector<CDouble> lengths = g.longestPathLengths(0, mu);
+
+        // reference: sweep over all edges until nothing changes
+        std::map<CId, CDouble> expected;
+        for (const auto &n : g.getNodes()) {
+            expected[n.id] = n.id == 0 ? 0.0 : -DBL_MAX;
+        }
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (const auto &e : g.getEdges()) {
+                if (expected[e.src->id] != -DBL_MAX
+                    && expected[e.src->id] + e.w - mu > expected[e.dst->id] + 1e-6) {
+                    expected[e.dst->id] = expected[e.src->id] + e.w - mu;
+                    changed = true;
+                }
+            }
+        }
+        std::map<CId, CDouble> paths = g.normalizedLongestPaths(0, mu);
+        size_t k = 0;
+        for (const auto &n : g.getNodes()) {
+            ASSERT_APPROX_EQUAL(expected[n.id], lengths[k++], 1e-6);
+            ASSERT_EQUAL(paths[n.id], lengths[n.id]);
+        }
+
+        // above the maximum cycle mean there is a positive cycle
+        bool thrown = false;
+        try {
+            auto unbounded = g.longestPathLengths(0, mu - 1.0);
+        } catch (MPException &) {
+            thrown = true;
+        }
+        ASSERT_THROW(thrown);
+    }
+
+    // an acyclic graph, with per node normalization
+    MCMgraph g;
+    MCMnode &n0 = *g.addNode(0);
+    MCMnode &n1 = *g.addNode(1);
+    MCMnode &n2 = *g.addNode(2);
+    MCMnode &n3 = *g.addNode(3);
+    g.addEdge(0, n0, n1, 2.0, 1.0);
+    g.addEdge(1, n0, n2, 1.0, 1.0);
+    g.addEdge(2, n1, n2, 3.0, 1.0);
+    g.addEdge(3, n3, n0, 7.0, 1.0);
+    std::vector<CDouble> lengths = g.longestPathLengths(0, {1.0, -DBL_MAX, 0.0, 0.0});
+    ASSERT_THROW(lengths == std::vector<CDouble>({0.0, 1.0, 4.0, -DBL_MAX}));
+}
+
+/// Test repeated queries on a compiled Young-Tarjan-Orlin graph.
+void MCMTest::test_compiled_yto() { // NOLINT(*to-static)
+    std::cout << "Running test: MCM-compiled-yto\n";
+
+    // node ids need not be consecutive
+    MCMgraph g = generateGraph(GraphFamily::RandomSparse, 500, 3);
+    for (auto &n : g.getNodes()) {
+        n.id = 10 * n.id + 7;
+    }
+    for (auto &e : g.getEdges()) {
+        e.d = 1.0 + static_cast<CDouble>(e.id % 3);
+    }
+    CompiledYTOgraph compiled(g);
+
+    std::mt19937 rng(3);
+    for (unsigned int k = 0; k < 20; k++) {
+        for (unsigned int j = 0; j < 10; j++) {
+            auto e = g.getEdges().begin();
+            std::advance(e, rng() % g.getEdges().size());
+            e->w = static_cast<CDouble>(1 + (rng() % 1000));
+            e->d = static_cast<CDouble>(1 + (rng() % 3));
+            compiled.setWeight(e->id, e->w);
+            compiled.setDelay(e->id, e->d);
+        }
+        std::map<CId, const MCMedge *> edges;
+        for (const auto &e : g.getEdges()) {
+            edges[e.id] = &e;
+        }
+
+        std::vector<CId> cycle;
+        CDouble ratio = compiled.maximumCycleRatio(&cycle);
+        ASSERT_APPROX_EQUAL(maximumCycleRatioHoward(g), ratio, 1e-6);
+        CDouble weight = 0.0;
+        CDouble delay = 0.0;
+        for (size_t i = 0; i < cycle.size(); i++) {
+            const MCMedge *e = edges[cycle[i]];
+            ASSERT_THROW(e->dst == edges[cycle[(i + 1) % cycle.size()]]->src);
+            weight += e->w;
+            delay += e->d;
+        }
+        ASSERT_APPROX_EQUAL(ratio, weight / delay, 1e-6);
+
+        ASSERT_APPROX_EQUAL(maximumCycleMeanHowardGeneral(g, nullptr), compiled.maximumCycleMean(), 1e-6);
+    }
+
+    bool thrown = false;
+    try {
+        compiled.setWeight(100000, 1.0);
+    } catch (MPException &) {
+        thrown = true;
+    }
+    ASSERT_THROW(thrown);
+}
+
+/// Test the extraction of the critical graph.
+void MCMTest::test_critical_graph() { // NOLINT(*to-static)
+    std::cout << "Running test: MCM-critical-graph\n";
+
+    // two critical cycles sharing node 1, a separate critical self-loop, a
+    // non-critical cycle and a critical cycle reached through an edge
+    MCMgraph g;
+    std::vector<MCMnode *> n;
+    for (CId i = 0; i < 7; i++) {
+        n.push_back(g.addNode(i));
+    }
+    g.addEdge(0, *n[0], *n[1], 4.0, 1.0);
+    g.addEdge(1, *n[1], *n[0], 2.0, 1.0);
+    g.addEdge(2, *n[1], *n[2], 3.0, 1.0);
+    g.addEdge(3, *n[2], *n[1], 3.0, 1.0);
+    g.addEdge(4, *n[3], *n[3], 3.0, 1.0);
+    g.addEdge(5, *n[4], *n[5], 1.0, 1.0);
+    g.addEdge(6, *n[5], *n[4], 1.0, 1.0);
+    g.addEdge(7, *n[6], *n[3], 5.0, 1.0);
+    g.addEdge(8, *n[2], *n[0], 1.0, 1.0);
+
+    CriticalGraph c = criticalGraph(g);
+    ASSERT_APPROX_EQUAL(3.0, c.cycleMean, 1e-9);
+    std::set<CId> edges;
+    for (const auto *e : c.edges) {
+        edges.insert(e->id);
+    }
+    ASSERT_THROW(edges == std::set<CId>({0, 1, 2, 3, 4}));
+    ASSERT_EQUAL(c.nodes.size(), 4);
+    ASSERT_EQUAL(c.nrClasses, 2);
+    for (size_t k = 0; k < c.edges.size(); k++) {
+        ASSERT_THROW(c.nodes[c.ij[2 * k]] == c.edges[k]->src);
+        ASSERT_THROW(c.nodes[c.ij[(2 * k) + 1]] == c.edges[k]->dst);
+        ASSERT_EQUAL(c.nodeClass[c.ij[2 * k]], c.nodeClass[c.ij[(2 * k) + 1]]);
+    }
+
+    // every cycle of the critical graph of a generated graph is critical
+    for (auto family : allGraphFamilies()) {
+        for (bool ratio : {false, true}) {
+            MCMgraph h = generateGraph(family, 1000, 2);
+            CriticalGraph ch = criticalGraph(h, ratio);
+            ASSERT_APPROX_EQUAL(ratio ? maximumCycleRatioHoward(h) : maximumCycleMeanHowardGeneral(h, nullptr),
+                                ch.cycleMean,
+                                1e-6);
+            ASSERT_THROW(!ch.edges.empty());
+
+            MCMgraph sub;
+            for (size_t i = 0; i < ch.nodes.size(); i++) {
+                sub.addNode(static_cast<CId>(i));
+            }
+            for (size_t k = 0; k < ch.edges.size(); k++) {
+                sub.addEdge(static_cast<CId>(k),
+                            *sub.getNode(static_cast<CId>(ch.ij[2 * k])),
+                            *sub.getNode(static_cast<CId>(ch.ij[(2 * k) + 1])),
+                            ch.edges[k]->w,
+                            ratio ? ch.edges[k]->d : 1.0);
+            }
+            ASSERT_APPROX_EQUAL(ch.cycleMean, maximumCycleRatioHoward(sub), 1e-6);
+            ASSERT_APPROX_EQUAL(ch.cycleMean, minCycleRatioYoungTarjanOrlin(sub), 1e-6);
+        }
+    }
 }
 
 // NOLINTEND(*magic-numbers,*simplify-boolean-expr)
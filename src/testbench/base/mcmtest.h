@@ -15,7 +15,19 @@ public:
 
     void test_dg();
     void test_howard();
+    void test_howard_warm_start();
+    void test_howard_ratio();
+    void test_automatic();
     void test_karp();
     void test_yto();
     void test_prune();
+    void test_generated_graphs();
+    void test_longest_delay_edges();
+    void test_incremental();
+    void test_batch();
+    void test_exact();
+    void test_approximate();
+    void test_longest_paths();
+    void test_compiled_yto();
+    void test_critical_graph();
 };
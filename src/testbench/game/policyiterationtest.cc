@@ -3,6 +3,8 @@
 #include "game/strategyvector.h"
 #include <algorithm>
 
+#include "generators.h"
+
 #include "policyiterationtest.h"
 #include "testing.h"
 
@@ -16,6 +18,7 @@ void PolicyIterationTest::Run() {
     testTwoPlayersTest();
     testSimpleTest();
     testInvalidInputGraphTest();
+    testGeneratedGameTest();
 };
 
 void PolicyIterationTest::SetUp() {};
@@ -189,3 +192,22 @@ void PolicyIterationTest::testInvalidInputGraphTest() {
         // SUCCEED();
     }
 }
+
+void PolicyIterationTest::testGeneratedGameTest() {
+
+    std::cout << "Running test: GeneratedGameTest" << std::endl;
+
+    std::unique_ptr<MaxPlusGameAutomatonWithRewards> game = Generators::generateGame(200, 3, 7);
+    ASSERT_EQUAL(game->getV0().size() + game->getV1().size(), 200);
+
+    PolicyIteration<MPAStateLabel, MPAREdgeLabel> pi;
+    PolicyIteration<MPAStateLabel, MPAREdgeLabel>::PolicyIterationResult result =
+            pi.solve(*game);
+
+    // rewards are in [1, 10] and delays in [1, 1000]
+    ASSERT_EQUAL(result.values.size(), 200);
+    for (const auto &v : result.values) {
+        ASSERT_THROW(v.second >= 1.0 / Generators::MAX_WEIGHT - 1e-9);
+        ASSERT_THROW(v.second <= 10.0 + 1e-9);
+    }
+}
@@ -22,4 +22,5 @@ public:
     void testTwoPlayersTest();
     void testSimpleTest();
     void testInvalidInputGraphTest();
+    void testGeneratedGameTest();
 };
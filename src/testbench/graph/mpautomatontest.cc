@@ -1,11 +1,22 @@
 #include <algorithm>
 #include <base/basic_types.h>
+#include <map>
 #include <memory>
-
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "base/analysis/mcm/mcm.h"
+#include "base/analysis/mcm/mcmgraph.h"
+#include "base/fsm/arenafsm.h"
 #include "base/fsm/fsm.h"
+#include "generators.h"
 #include "mpautomatontest.h"
 
+#include "base/fsm/iofsm.h"
 #include "graph/mpautomaton.h"
+#include "graph/smpls.h"
 #include "testing.h"
 
 #define ASSERT_EPSILON 0.001
@@ -26,6 +37,17 @@ void MPAutomatonTest::Run() {
     testMinimizeFSM();
     testDFSFSM();
     testDetectCycleFSM();
+    testGeneratedSMPLS();
+    testArenaFSM();
+    testTypedTraversalFSM();
+    testLabelIndexFSM();
+    testDeterminizeSubsetsFSM();
+    testMinimizePartitionFSM();
+    testSearchEnginesFSM();
+    testLazyProductFSM();
+    testTrimFSM();
+    testTransitionIndexFSM();
+    testConcurrentConstructionFSM();
 }
 
 void MPAutomatonTest::testCreateFSM() { // NOLINT(*to-static)
@@ -102,7 +124,10 @@ void MPAutomatonTest::testDeterminizeFSM() { // NOLINT(*to-static)
     CDouble mcr1 = mpaDeterminized->calculateMCRAndCycle(&cycle);
 
     ASSERT_APPROX_EQUAL(mcr, mcr1, ASSERT_EPSILON);
+    ASSERT_APPROX_EQUAL(5.0, mcr, ASSERT_EPSILON);
     ASSERT_EQUAL(cycle.size(), 2);
+    ASSERT_THROW(cycle[0] != nullptr && cycle[1] != nullptr);
+    ASSERT_THROW(cycle[0]->getDestination() == cycle[1]->getSource());
 }
 
 void MPAutomatonTest::testMinimizeFSM() { // NOLINT(*to-static)
@@ -255,4 +280,702 @@ void MPAutomatonTest::testDetectCycleFSM() { // NOLINT(*to-static)
     }
 }
 
+void MPAutomatonTest::testGeneratedSMPLS() {
+    std::cout << "Running test: GeneratedSMPLS" << std::endl;
+
+    // every state of the mode automaton becomes one state per token
+    std::unique_ptr<SMPLS::SMPLS> smpls = Generators::generateSMPLS(3, 4, 0.5, 50, 2, 11);
+    std::unique_ptr<MaxPlusAutomaton> mpa = smpls->convertToMaxPlusAutomaton();
+    ASSERT_EQUAL(mpa->getStates().size(), 200);
+    ASSERT_EQUAL(mpa->getInitialStates().size(), 4);
+
+    // the generated automata are strongly connected, so the ratio of delay
+    // (in [1, 1000]) over reward (in [1, 10]) is in between
+    std::unique_ptr<MaxPlusAutomatonWithRewards> mpar =
+            Generators::generateMaxPlusAutomatonWithRewards(1000, 3, 2, 11);
+    ASSERT_EQUAL(mpar->getStates().size(), 1000);
+    CDouble mcr = mpar->calculateMCR();
+    ASSERT_THROW(mcr >= 0.1 && mcr <= 1000.0);
+}
+
+void MPAutomatonTest::testArenaFSM() { // NOLINT(*to-static)
+    std::cout << "Running test: ArenaFSM" << std::endl;
+
+    FSM::Labeled::FiniteStateMachine<int, int> fsa;
+
+    const auto *s0 = fsa.addState(3);
+    const auto *s1 = fsa.addState(5);
+    const auto *s2 = fsa.addState(6);
+    const auto *s3 = fsa.addState(7);
+
+    fsa.addEdge(*s0, 1, *s1);
+    fsa.addEdge(*s1, 2, *s2);
+    fsa.addEdge(*s0, 2, *s2);
+    fsa.addEdge(*s2, 1, *s0);
+    fsa.addEdge(*s3, 1, *s0);
+    fsa.setInitialState(*s0);
+
+    FSM::Arena::FiniteStateMachine<int, int> arena(fsa);
+    ASSERT_EQUAL(arena.nrStates(), 4);
+    ASSERT_EQUAL(arena.nrEdges(), 5);
+    ASSERT_EQUAL(arena.getInitialState(), 0);
+    ASSERT_EQUAL(arena.getStateLabeled(6), 2);
+    ASSERT_EQUAL(arena.checkStateLabeled(4), FSM::Arena::NO_STATE);
+    ASSERT(arena.findEdge(3, 2, 6) != FSM::Arena::NO_EDGE);
+    ASSERT(arena.findEdge(3, 1, 6) == FSM::Arena::NO_EDGE);
+    ASSERT_EQUAL(arena.getDestination(arena.getEdge(2, 0)), 0);
+    ASSERT(arena.getEdge(1, 0) == FSM::Arena::NO_EDGE);
+    ASSERT_EQUAL(arena.nextStatesOfEdgeLabel(0, 2).size(), 1);
+    ASSERT_EQUAL(arena.reachableStates().size(), 3);
+    ASSERT(arena.hasDirectedCycle());
+
+    // edges added later are appended to the outgoing edges in order
+    arena.addEdge(1, 3, 3);
+    arena.addEdge(0, 3, 3);
+    std::vector<int> labels;
+    for (auto e : arena.getOutgoingEdges(0)) {
+        labels.push_back(arena.getEdgeLabel(e));
+    }
+    ASSERT(labels == std::vector<int>({1, 2, 3}));
+    ASSERT_EQUAL(arena.reachableStates().size(), 4);
+
+    // compacting renumbers the edges by source and keeps their order
+    arena.compact();
+    for (FSM::Arena::EdgeIndex e = 0; e < arena.nrEdges(); e++) {
+        ASSERT(e == 0 || arena.getSource(e - 1) <= arena.getSource(e));
+    }
+    std::vector<int> compactLabels;
+    for (auto e : arena.getOutgoingEdges(0)) {
+        compactLabels.push_back(arena.getEdgeLabel(e));
+    }
+    ASSERT(compactLabels == labels);
+
+    auto labeled = arena.toLabeled();
+    ASSERT_EQUAL(labeled->getStates().size(), 4);
+    ASSERT_EQUAL(labeled->getEdges().size(), 7);
+    ASSERT_EQUAL(labeled->getInitialState()->getLabel(), 3);
+    ASSERT(labeled->findEdge(5, 3, 7) != nullptr);
+
+    // acyclic machine
+    FSM::Arena::FiniteStateMachine<int, int> dag;
+    auto a = dag.addState(0);
+    auto b = dag.addState(1);
+    auto c = dag.addState(2);
+    dag.addEdge(a, 0, b);
+    dag.addEdge(a, 0, c);
+    dag.addEdge(b, 0, c);
+    ASSERT(!dag.hasDirectedCycle());
+
+    // a generated max-plus automaton converts without loss
+    std::unique_ptr<MaxPlusAutomaton> mpa = Generators::generateMaxPlusAutomaton(500, 3, 2, 5);
+    FSM::Arena::FiniteStateMachine<MPAStateLabel, MPAEdgeLabel> mpaArena(*mpa);
+    ASSERT_EQUAL(mpaArena.nrStates(), mpa->getStates().size());
+    ASSERT_EQUAL(mpaArena.nrEdges(), mpa->getEdges().size());
+    ASSERT_EQUAL(mpaArena.reachableStates().size(), mpa->reachableStates()->size());
+}
+
+void MPAutomatonTest::testTypedTraversalFSM() { // NOLINT(*to-static)
+    std::cout << "Running test: TypedTraversalFSM" << std::endl;
+
+    std::unique_ptr<MaxPlusAutomaton> mpa = Generators::generateMaxPlusAutomaton(200, 3, 2, 7);
+
+    // every edge is visited once as an outgoing edge of its source
+    size_t nrStates = 0;
+    size_t nrEdges = 0;
+    for (const auto *s : mpa->getTypedStates()) {
+        nrStates++;
+        for (const auto *e : s->getTypedOutgoingEdges()) {
+            ASSERT(e->getSource() == s);
+            ASSERT(mpa->getStateLabeled(e->getDestination()->getLabel()) == e->getDestination());
+            nrEdges++;
+        }
+    }
+    ASSERT_EQUAL(nrStates, mpa->getStates().size());
+    ASSERT_EQUAL(nrEdges, mpa->getEdges().size());
+
+    size_t nrAllEdges = 0;
+    for (const auto *e : mpa->getTypedEdges()) {
+        ASSERT(e->getLabel().mode == MPString("m0") || e->getLabel().mode == MPString("m1"));
+        nrAllEdges++;
+    }
+    ASSERT_EQUAL(nrAllEdges, nrEdges);
+
+    for (const auto *s : mpa->getTypedInitialStates()) {
+        ASSERT_EQUAL(s->getLabel().id, 0);
+    }
+    ASSERT(mpa->getTypedFinalStates().empty());
+}
+
+void MPAutomatonTest::testLabelIndexFSM() { // NOLINT(*to-static)
+    std::cout << "Running test: LabelIndexFSM" << std::endl;
+
+    // the label types of the library are hashed
+    static_assert(FSM::IsHashable<MPAStateLabel>::value);
+    static_assert(FSM::IsHashable<MPAEdgeLabel>::value);
+    static_assert(FSM::IsHashable<MPAREdgeLabel>::value);
+    static_assert(FSM::IsHashable<IOAEdgeLabel>::value);
+    static_assert(FSM::IsHashable<MPString>::value);
+
+    std::hash<MPAStateLabel> hashState;
+    ASSERT_EQUAL(hashState(makeMPAStateLabel(3, 1)), hashState(makeMPAStateLabel(3, 1)));
+    ASSERT(hashState(makeMPAStateLabel(3, 1)) != hashState(makeMPAStateLabel(1, 3)));
+    std::hash<MPAREdgeLabel> hashEdge;
+    ASSERT_EQUAL(hashEdge(makeRewardEdgeLabel(MPTime(2.0), MPString("a"), 1.0)),
+                 hashEdge(makeRewardEdgeLabel(MPTime(2.0), MPString("a"), 1.0)));
+
+    MaxPlusAutomaton mpa;
+    const auto *s0 = mpa.addState(makeMPAStateLabel(0, 0));
+    const auto *s1 = mpa.addState(makeMPAStateLabel(1, 0));
+    mpa.addEdge(*s0, makeMPAEdgeLabel(MPTime(1.0), MPString("a")), *s1);
+    ASSERT(mpa.hasStateLabeled(makeMPAStateLabel(1, 0)));
+    ASSERT(!mpa.hasStateLabeled(makeMPAStateLabel(1, 1)));
+    ASSERT(mpa.getStateLabeled(makeMPAStateLabel(1, 0)) == s1);
+    ASSERT(mpa.checkStateLabeled(makeMPAStateLabel(2, 0)) == nullptr);
+
+    // states may share a label; the index follows the most recent one that remains
+    FSM::Labeled::FiniteStateMachine<int, int> fsa;
+    const auto *a = fsa.addState(5);
+    const auto *b = fsa.addState(5);
+    const auto *c = fsa.addState(6);
+    fsa.addEdge(*a, 1, *c);
+    fsa.addEdge(*b, 2, *c);
+    ASSERT(fsa.getStateLabeled(5) == b);
+    fsa.removeState(*b);
+    ASSERT(fsa.hasStateLabeled(5));
+    ASSERT(fsa.getStateLabeled(5) == a);
+    ASSERT(fsa.findEdge(5, 1, 6) != nullptr);
+    fsa.removeState(*a);
+    ASSERT(!fsa.hasStateLabeled(5));
+    ASSERT(fsa.checkStateLabeled(5) == nullptr);
+    ASSERT(fsa.checkStateLabeled(6) == c);
+}
+
+void MPAutomatonTest::testDeterminizeSubsetsFSM() { // NOLINT(*to-static)
+    std::cout << "Running test: DeterminizeSubsetsFSM" << std::endl;
+
+    // (a|b)*a(a|b)^3: the smallest deterministic automaton has 2^4 states
+    FSM::Labeled::FiniteStateMachine<int, char> nfa;
+    std::vector<FSM::Labeled::StateRef<int, char>> q;
+    for (int i = 0; i < 5; i++) {
+        q.push_back(nfa.addState(i));
+    }
+    nfa.addEdge(*q[0], 'a', *q[0]);
+    nfa.addEdge(*q[0], 'b', *q[0]);
+    nfa.addEdge(*q[0], 'a', *q[1]);
+    for (int i = 1; i < 4; i++) {
+        nfa.addEdge(*q[i], 'a', *q[i + 1]);
+        nfa.addEdge(*q[i], 'b', *q[i + 1]);
+    }
+    nfa.setInitialState(*q[0]);
+
+    auto dfa = nfa.determinizeEdgeLabels();
+    ASSERT_EQUAL(dfa->getStates().size(), 16);
+    ASSERT_EQUAL(dfa->getEdges().size(), 32);
+
+    // every subset contains the initial state, which names it, and has one successor per label
+    ASSERT_EQUAL(dfa->getInitialState()->getLabel(), 0);
+    for (const auto *s : dfa->getTypedStates()) {
+        ASSERT_EQUAL(s->getLabel(), 0);
+        std::set<char> labels;
+        for (const auto *e : s->getTypedOutgoingEdges()) {
+            ASSERT(labels.insert(e->getLabel()).second);
+        }
+        ASSERT_EQUAL(labels.size(), 2);
+    }
+
+    // the deterministic automaton is deterministic already
+    auto again = dfa->determinizeEdgeLabels();
+    ASSERT_EQUAL(again->getStates().size(), 16);
+    ASSERT_EQUAL(again->getEdges().size(), 32);
+}
+
+void MPAutomatonTest::testMinimizePartitionFSM() { // NOLINT(*to-static)
+    std::cout << "Running test: MinimizePartitionFSM" << std::endl;
+
+    // a nondeterministic automaton: the states 1 and 2 are bisimilar, 3 and 4 are not,
+    // 4 can make a transition with label 1 to both the class of 1 and 2 and to 0
+    {
+        FSM::Labeled::FiniteStateMachine<int, int> fsa;
+        std::vector<FSM::Labeled::StateRef<int, int>> q;
+        for (int i = 0; i < 5; i++) {
+            q.push_back(fsa.addState(0));
+        }
+        fsa.addEdge(*q[0], 0, *q[1]);
+        fsa.addEdge(*q[0], 0, *q[2]);
+        fsa.addEdge(*q[1], 1, *q[0]);
+        fsa.addEdge(*q[2], 1, *q[0]);
+        fsa.addEdge(*q[0], 2, *q[3]);
+        fsa.addEdge(*q[0], 2, *q[4]);
+        fsa.addEdge(*q[3], 1, *q[1]);
+        fsa.addEdge(*q[4], 1, *q[2]);
+        fsa.addEdge(*q[4], 1, *q[0]);
+        fsa.setInitialState(*q[0]);
+        auto fsaMin = fsa.minimizeEdgeLabels();
+        ASSERT_EQUAL(fsaMin->getStates().size(), 4);
+    }
+
+    // compare to naive refinement on signatures on random automata
+    std::mt19937 rng(7);
+    for (int round = 0; round < 20; round++) {
+        const int n = 200;
+        FSM::Labeled::FiniteStateMachine<int, int> fsa;
+        std::vector<FSM::Labeled::StateRef<int, int>> q;
+        for (int i = 0; i < n; i++) {
+            q.push_back(fsa.addState(static_cast<int>(rng() % 2)));
+        }
+        std::vector<std::vector<std::pair<int, int>>> out(n);
+        for (int k = 0; k < 2 * n; k++) {
+            int src = static_cast<int>(rng() % n);
+            int l = static_cast<int>(rng() % 2);
+            int dst = static_cast<int>(rng() % (n / 4));
+            fsa.addEdge(*q[src], l, *q[dst]);
+            out[src].emplace_back(l, dst);
+        }
+        fsa.setInitialState(*q[0]);
+
+        for (bool ignoreStateLabels : {false, true}) {
+            std::vector<int> block(n);
+            for (int i = 0; i < n; i++) {
+                block[i] = ignoreStateLabels ? 0 : q[i]->getLabel();
+            }
+            size_t nrBlocks = 0;
+            while (true) {
+                std::map<std::pair<int, std::set<std::pair<int, int>>>, int> signatures;
+                std::vector<int> next(n);
+                for (int i = 0; i < n; i++) {
+                    std::set<std::pair<int, int>> sig;
+                    for (const auto &e : out[i]) {
+                        sig.emplace(e.first, block[e.second]);
+                    }
+                    auto key = std::make_pair(block[i], sig);
+                    next[i] = signatures.emplace(key, static_cast<int>(signatures.size()))
+                                      .first->second;
+                }
+                block = next;
+                if (signatures.size() == nrBlocks) {
+                    break;
+                }
+                nrBlocks = signatures.size();
+            }
+
+            auto fsaMin = fsa.minimizeEdgeLabels(ignoreStateLabels);
+            ASSERT_EQUAL(fsaMin->getStates().size(), nrBlocks);
+            auto fsaMin2 = fsaMin->minimizeEdgeLabels(ignoreStateLabels);
+            ASSERT_EQUAL(fsaMin2->getStates().size(), nrBlocks);
+        }
+    }
+}
+
+void MPAutomatonTest::testSearchEnginesFSM() { // NOLINT(*to-static)
+    std::cout << "Running test: SearchEnginesFSM" << std::endl;
+
+    // a random automaton with levels large enough to be explored in parallel
+    const int n = 50000;
+    FSM::Labeled::FiniteStateMachine<int, int> fsa;
+    std::vector<FSM::Labeled::StateRef<int, int>> q;
+    for (int i = 0; i < n; i++) {
+        q.push_back(fsa.addState(i));
+    }
+    std::mt19937 rng(11);
+    std::vector<std::vector<int>> out(n);
+    for (int k = 0; k < 3 * n; k++) {
+        // states in the second half are not reachable from the first half
+        int src = static_cast<int>(rng() % n);
+        int dst = static_cast<int>(rng() % (n / 2)) + (src < n / 2 ? 0 : n / 2);
+        fsa.addEdge(*q[src], 0, *q[dst]);
+        out[src].push_back(dst);
+    }
+    fsa.setInitialState(*q[0]);
+
+    // distances from the initial state
+    std::vector<int> distance(n, -1);
+    std::vector<int> queue{0};
+    distance[0] = 0;
+    for (size_t k = 0; k < queue.size(); k++) {
+        for (int d : out[queue[k]]) {
+            if (distance[d] < 0) {
+                distance[d] = distance[queue[k]] + 1;
+                queue.push_back(d);
+            }
+        }
+    }
+
+    // the virtual DFS, the DFS with a visitor and reachableStates agree
+    std::set<int> byLambda;
+    FSM::Abstract::DepthFirstSearchLambda dfs(fsa);
+    dfs.setOnEnterLambda([&byLambda](FSM::Abstract::StateRef s) {
+        byLambda.insert(static_cast<FSM::Labeled::StateRef<int, int>>(s)->getLabel());
+    });
+    dfs.DoDepthFirstSearch();
+    ASSERT_EQUAL(byLambda.size(), queue.size());
+
+    struct Counter : FSM::Abstract::SearchVisitor {
+        size_t entered = 0;
+        size_t left = 0;
+        void onEnterState(FSM::Abstract::StateRef) { this->entered++; }
+        void onLeaveState(FSM::Abstract::StateRef) { this->left++; }
+    };
+    Counter counter;
+    FSM::Abstract::depthFirstSearch(fsa, fsa.getInitialStates(), counter);
+    ASSERT_EQUAL(counter.entered, queue.size());
+    ASSERT_EQUAL(counter.left, queue.size());
+    ASSERT_EQUAL(fsa.reachableStates()->size(), queue.size());
+
+    // breadth first, sequential and in parallel, visits by increasing distance
+    for (unsigned int nrThreads : {1U, 4U}) {
+        struct Levels : FSM::Abstract::SearchVisitor {
+            std::vector<int> visited;
+            void onEnterState(FSM::Abstract::StateRef s) {
+                this->visited.push_back(
+                        static_cast<FSM::Labeled::StateRef<int, int>>(s)->getLabel());
+            }
+        };
+        Levels levels;
+        FSM::Abstract::breadthFirstSearch(fsa, fsa.getInitialStates(), levels, nrThreads);
+        ASSERT_EQUAL(levels.visited.size(), queue.size());
+        ASSERT_EQUAL(std::set<int>(levels.visited.begin(), levels.visited.end()).size(),
+                     queue.size());
+        for (size_t k = 1; k < levels.visited.size(); k++) {
+            ASSERT(distance[levels.visited[k - 1]] <= distance[levels.visited[k]]);
+        }
+    }
+
+    // an aborting visitor stops the search
+    struct Abort : FSM::Abstract::SearchVisitor {
+        size_t entered = 0;
+        void onEnterState(FSM::Abstract::StateRef) { this->entered++; }
+        [[nodiscard]] bool aborted() const { return this->entered >= 10; }
+    };
+    Abort abort;
+    FSM::Abstract::breadthFirstSearch(fsa, fsa.getStateRefs(), abort);
+    ASSERT_EQUAL(abort.entered, 10);
+}
+
+namespace {
+
+// product of a max-plus automaton and an environment that restricts its modes
+using Environment = FSM::Labeled::FiniteStateMachine<int, MPString>;
+
+class ModeProduct : public FSM::Product::FiniteStateMachine {
+public:
+    ModeProduct(const MaxPlusAutomaton &mpa, const Environment &env) :
+        FSM::Product::FiniteStateMachine(mpa, env) {}
+
+    [[nodiscard]] bool matchEdges(const FSM::Abstract::Edge &e1,
+                                  const FSM::Abstract::Edge &e2) const override {
+        return static_cast<const MPAEdge &>(e1).getLabel().mode
+               == static_cast<const FSM::Labeled::Edge<int, MPString> &>(e2).getLabel();
+    }
+};
+
+CDouble productEdgeDelay(const FSM::Abstract::Edge &e) {
+    const auto &pe = static_cast<const FSM::Product::Edge &>(e);
+    return static_cast<CDouble>(static_cast<const MPAEdge &>(pe.getEdgeA()).getLabel().delay);
+}
+
+} // namespace
+
+void MPAutomatonTest::testLazyProductFSM() { // NOLINT(*to-static)
+    std::cout << "Running test: LazyProductFSM" << std::endl;
+
+    auto mpa = Generators::generateMaxPlusAutomaton(200, 3, 2, 5);
+
+    // the environment never takes mode m0 twice in a row
+    Environment env;
+    const auto *q0 = env.addState(0);
+    const auto *q1 = env.addState(1);
+    env.addEdge(*q0, MPString("m0"), *q1);
+    env.addEdge(*q0, MPString("m1"), *q0);
+    env.addEdge(*q1, MPString("m1"), *q0);
+    env.setInitialState(*q0);
+
+    ModeProduct product(*mpa, env);
+    ASSERT_EQUAL(product.getStates().size(), 1);
+    ASSERT_EQUAL(product.getEdges().size(), 0);
+
+    // the pairs reachable in the product
+    std::set<std::pair<CId, CId>> pairs;
+    std::vector<std::pair<MPAStateRef, FSM::Labeled::StateRef<int, MPString>>> queue;
+    queue.emplace_back(mpa->getInitialState(), env.getInitialState());
+    pairs.emplace(queue[0].first->getId(), queue[0].second->getId());
+    size_t nrEdges = 0;
+    for (size_t k = 0; k < queue.size(); k++) {
+        for (const auto *e1 : queue[k].first->getTypedOutgoingEdges()) {
+            for (const auto *e2 : queue[k].second->getTypedOutgoingEdges()) {
+                if (e1->getLabel().mode == e2->getLabel()) {
+                    nrEdges++;
+                    if (pairs.emplace(e1->getDestination()->getId(), e2->getDestination()->getId())
+                                .second) {
+                        queue.emplace_back(e1->getDestination(), e2->getDestination());
+                    }
+                }
+            }
+        }
+    }
+
+    // a DFS explores exactly the reachable pairs
+    struct Counter : FSM::Abstract::SearchVisitor {
+        size_t entered = 0;
+        void onEnterState(FSM::Abstract::StateRef) { this->entered++; }
+    };
+    Counter counter;
+    FSM::Abstract::depthFirstSearch(product, product.getInitialStates(), counter);
+    ASSERT_EQUAL(counter.entered, pairs.size());
+    ASSERT_EQUAL(product.getStates().size(), pairs.size());
+    ASSERT_EQUAL(product.getEdges().size(), nrEdges);
+    ASSERT(product.getStates().size() < 2 * mpa->getStates().size());
+    for (const auto &i : product.getStates()) {
+        const auto &ps = static_cast<const FSM::Product::State &>(*i.second);
+        ASSERT(pairs.count(std::make_pair(ps.getStateA().getId(), ps.getStateB().getId())) == 1);
+    }
+
+    // the maximum cycle mean of the product equals the one of the materialized product
+    MaxPlusAutomaton materialized;
+    std::map<std::pair<CId, CId>, MPAStateRef> stateOf;
+    for (const auto &p : pairs) {
+        stateOf[p] = materialized.addState(
+                makeMPAStateLabel(static_cast<unsigned int>(stateOf.size()), 0));
+    }
+    for (const auto &[sa, sb] : queue) {
+        for (const auto *e1 : sa->getTypedOutgoingEdges()) {
+            for (const auto *e2 : sb->getTypedOutgoingEdges()) {
+                if (e1->getLabel().mode == e2->getLabel()) {
+                    materialized.addEdge(
+                            *stateOf[std::make_pair(sa->getId(), sb->getId())],
+                            e1->getLabel(),
+                            *stateOf[std::make_pair(e1->getDestination()->getId(),
+                                                    e2->getDestination()->getId())]);
+                }
+            }
+        }
+    }
+    materialized.setInitialState(
+            *stateOf[std::make_pair(mpa->getInitialState()->getId(), q0->getId())]);
+
+    auto one = [](const FSM::Abstract::Edge &) { return 1.0; };
+    Graphs::MCMgraph g = Graphs::reachableMCMgraph(product, productEdgeDelay, one);
+    ASSERT_EQUAL(g.getNodes().size(), pairs.size());
+    auto delay = [](const FSM::Abstract::Edge &e) {
+        return static_cast<CDouble>(static_cast<const MPAEdge &>(e).getLabel().delay);
+    };
+    Graphs::MCMgraph gm = Graphs::reachableMCMgraph(materialized, delay, one);
+    ASSERT_APPROX_EQUAL(Graphs::maximumCycleMean(g), Graphs::maximumCycleMean(gm), ASSERT_EPSILON);
+
+    // the virtual DFS explores a fresh product only until it finds a cycle
+    ModeProduct again(*mpa, env);
+    FSM::Abstract::DetectCycle dc(again);
+    ASSERT(dc.checkForCycles());
+    ASSERT(again.getStates().size() < pairs.size());
+
+    // a breadth first search asked for several threads explores a product from one thread,
+    // also with levels large enough to be followed in parallel otherwise
+    auto large = Generators::generateMaxPlusAutomaton(20000, 4, 2, 5);
+    ModeProduct sequential(*large, env);
+    Counter byDFS;
+    FSM::Abstract::depthFirstSearch(sequential, sequential.getInitialStates(), byDFS);
+    ModeProduct threaded(*large, env);
+    ASSERT(threaded.exploresOnDemand());
+    size_t largest = 0;
+    for (FSM::Abstract::BFSFrontier frontier(threaded, threaded.getInitialStates(), 4);
+         !frontier.atEnd();
+         frontier.advance()) {
+        largest = std::max(largest, frontier.getStates().size());
+    }
+    ASSERT(largest >= 4096);
+    ASSERT_EQUAL(threaded.getStates().size(), byDFS.entered);
+    ASSERT_EQUAL(threaded.getEdges().size(), sequential.getEdges().size());
+    ModeProduct visited(*large, env);
+    Counter byBFS;
+    FSM::Abstract::breadthFirstSearch(visited, visited.getInitialStates(), byBFS, 4);
+    ASSERT_EQUAL(byBFS.entered, byDFS.entered);
+}
+
+void MPAutomatonTest::testTrimFSM() { // NOLINT(*to-static)
+    std::cout << "Running test: TrimFSM" << std::endl;
+
+    // a cycle 0 <-> 1 with a dangling path 1 -> 2 -> 3, a state 4 that reaches the cycle
+    // but is not reachable itself, and an isolated state 5
+    auto build = [](FSM::Labeled::FiniteStateMachine<int, int> &fsa) {
+        std::vector<FSM::Labeled::StateRef<int, int>> q;
+        for (int i = 0; i < 6; i++) {
+            q.push_back(fsa.addState(i));
+        }
+        fsa.addEdge(*q[0], 0, *q[1]);
+        fsa.addEdge(*q[1], 0, *q[0]);
+        fsa.addEdge(*q[1], 1, *q[2]);
+        fsa.addEdge(*q[2], 1, *q[3]);
+        fsa.addEdge(*q[4], 0, *q[0]);
+        fsa.addEdge(*q[0], 2, *q[0]);
+        fsa.setInitialState(*q[0]);
+        fsa.addFinalState(*q[3]);
+        return q;
+    };
+
+    // removal with and without the incoming edge index gives the same result
+    for (bool indexed : {false, true}) {
+        FSM::Labeled::FiniteStateMachine<int, int> fsa;
+        auto q = build(fsa);
+        fsa.indexIncomingEdges(indexed);
+        ASSERT_EQUAL(fsa.hasIncomingEdgeIndex(), indexed);
+        if (indexed) {
+            ASSERT_EQUAL(q[0]->getIncomingEdges().size(), 3);
+        }
+        fsa.removeState(*q[0]);
+        ASSERT_EQUAL(fsa.getStates().size(), 5);
+        ASSERT_EQUAL(fsa.getEdges().size(), 2);
+        ASSERT(fsa.getInitialStates().empty());
+        ASSERT(q[1]->getOutgoingEdges().size() == 1);
+        fsa.removeState(*q[3]);
+        ASSERT(fsa.getFinalStates().empty());
+        ASSERT_EQUAL(fsa.getEdges().size(), 1);
+        if (indexed) {
+            ASSERT(q[2]->getIncomingEdges().size() == 1);
+            ASSERT(q[1]->getIncomingEdges().empty());
+        }
+    }
+
+    {
+        FSM::Labeled::FiniteStateMachine<int, int> fsa;
+        build(fsa);
+        fsa.trim(true, false);
+        ASSERT_EQUAL(fsa.getStates().size(), 4);
+        ASSERT(!fsa.hasStateLabeled(4) && !fsa.hasStateLabeled(5));
+        ASSERT_EQUAL(fsa.getEdges().size(), 5);
+    }
+    {
+        FSM::Labeled::FiniteStateMachine<int, int> fsa;
+        build(fsa);
+        fsa.trim(false, true);
+        ASSERT_EQUAL(fsa.getStates().size(), 3);
+        ASSERT(fsa.hasStateLabeled(4) && !fsa.hasStateLabeled(2) && !fsa.hasStateLabeled(3));
+        ASSERT_EQUAL(fsa.getEdges().size(), 4);
+        ASSERT(fsa.getFinalStates().empty());
+    }
+    {
+        FSM::Labeled::FiniteStateMachine<int, int> fsa;
+        build(fsa);
+        fsa.indexIncomingEdges();
+        fsa.trim();
+        ASSERT_EQUAL(fsa.getStates().size(), 2);
+        ASSERT_EQUAL(fsa.getEdges().size(), 3);
+        ASSERT_EQUAL(fsa.getInitialState()->getLabel(), 0);
+        ASSERT_EQUAL(fsa.getStateLabeled(0)->getIncomingEdges().size(), 2);
+    }
+
+    // the mode FSM of an SMPLS drops its dangling states
+    SMPLS::EdgeLabeledModeFSM modes;
+    const auto *m0 = modes.addState(0);
+    const auto *m1 = modes.addState(1);
+    const auto *m2 = modes.addState(2);
+    modes.addEdge(*m0, MPString("a"), *m0);
+    modes.addEdge(*m0, MPString("b"), *m1);
+    modes.addEdge(*m1, MPString("b"), *m2);
+    modes.setInitialState(*m0);
+    modes.removeDanglingStates();
+    ASSERT_EQUAL(modes.getStates().size(), 1);
+    ASSERT_EQUAL(modes.getEdges().size(), 1);
+}
+
+void MPAutomatonTest::testTransitionIndexFSM() { // NOLINT(*to-static)
+    std::cout << "Running test: TransitionIndexFSM" << std::endl;
+
+    // lookups with and without the transition index agree, also after updates
+    for (bool indexed : {false, true}) {
+        FSM::Labeled::FiniteStateMachine<int, int> fsa;
+        std::vector<FSM::Labeled::StateRef<int, int>> q;
+        for (int i = 0; i < 4; i++) {
+            q.push_back(fsa.addState(i));
+        }
+        // a second state with label 3 forces findEdge to consider both
+        const auto *q3b = fsa.addState(3);
+        const auto *e01 = fsa.addEdge(*q[0], 0, *q[1]);
+        const auto *e01b = fsa.addEdge(*q[0], 1, *q[1]);
+        const auto *e12 = fsa.addEdge(*q[1], 0, *q[2]);
+        const auto *e33 = fsa.addEdge(*q3b, 2, *q[0]);
+        fsa.indexTransitions(indexed);
+        ASSERT_EQUAL(fsa.hasTransitionIndex(), indexed);
+
+        ASSERT(fsa.getEdge(*q[0], *q[1]) == e01);
+        ASSERT(fsa.getEdge(*q[1], *q[0]) == nullptr);
+        ASSERT(fsa.findEdge(0, 1, 1) == e01b);
+        ASSERT(fsa.findEdge(1, 0, 2) == e12);
+        ASSERT(fsa.findEdge(1, 1, 2) == nullptr);
+        ASSERT(fsa.findEdge(7, 0, 2) == nullptr);
+        ASSERT(fsa.findEdge(3, 2, 0) == e33);
+
+        fsa.setEdgeLabel(e12, 5);
+        ASSERT(fsa.findEdge(1, 0, 2) == nullptr);
+        ASSERT(fsa.findEdge(1, 5, 2) == e12);
+
+        fsa.removeEdge(*e01);
+        ASSERT(fsa.getEdge(*q[0], *q[1]) == e01b);
+        ASSERT(fsa.findEdge(0, 0, 1) == nullptr);
+
+        const auto *e23 = fsa.addEdge(*q[2], 4, *q[3]);
+        ASSERT(fsa.getEdge(*q[2], *q[3]) == e23);
+        ASSERT(fsa.findEdge(2, 4, 3) == e23);
+
+        fsa.removeState(*q[1]);
+        ASSERT(fsa.getEdge(*q[0], *q[2]) == nullptr);
+        ASSERT(fsa.findEdge(0, 1, 1) == nullptr);
+    }
+
+    // relabeling parallel edges keeps the lookups in id order, as without the index
+    std::vector<FSM::Labeled::EdgeRef<int, int>> first;
+    std::vector<FSM::Labeled::EdgeRef<int, int>> found;
+    for (bool indexed : {false, true}) {
+        FSM::Labeled::FiniteStateMachine<int, int> fsa;
+        fsa.indexTransitions(indexed);
+        const auto *s = fsa.addState(0);
+        const auto *t = fsa.addState(1);
+        const auto *e1 = fsa.addEdge(*s, 0, *t);
+        const auto *e2 = fsa.addEdge(*s, 1, *t);
+        fsa.setEdgeLabel(e1, 2);
+        fsa.setEdgeLabel(e2, 2);
+        fsa.setEdgeLabel(e1, 1);
+        fsa.setEdgeLabel(e1, 2);
+        first.push_back(e1);
+        found.push_back(fsa.getEdge(*s, *t));
+        found.push_back(fsa.findEdge(0, 2, 1));
+        ASSERT(fsa.findEdge(0, 1, 1) == nullptr);
+    }
+    ASSERT(found[0] == first[0] && found[1] == first[0]);
+    ASSERT(found[2] == first[1] && found[3] == first[1]);
+}
+
+void MPAutomatonTest::testConcurrentConstructionFSM() { // NOLINT(*to-static)
+    std::cout << "Running test: ConcurrentConstructionFSM" << std::endl;
+
+    const unsigned int nrAutomata = 4;
+    const unsigned int nrStates = 2000;
+    std::vector<std::unique_ptr<MaxPlusAutomaton>> automata(nrAutomata);
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < nrAutomata; i++) {
+        threads.emplace_back([&automata, i]() {
+            automata[i] = Generators::generateMaxPlusAutomaton(nrStates, 3, 2, i);
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    std::set<CId> ids;
+    for (unsigned int i = 0; i < nrAutomata; i++) {
+        const auto &mpa = *automata[i];
+        auto serial = Generators::generateMaxPlusAutomaton(nrStates, 3, 2, i);
+        ASSERT_EQUAL(mpa.getStates().size(), serial->getStates().size());
+        ASSERT_EQUAL(mpa.getEdges().size(), serial->getEdges().size());
+
+        // the states are ordered by id as they were created
+        CId expected = 0;
+        for (const auto *st : mpa.getTypedStates()) {
+            ASSERT_EQUAL(st->getLabel().id, expected++);
+            ASSERT(ids.insert(st->getId()).second);
+        }
+        for (const auto &it : mpa.getEdges()) {
+            ASSERT(ids.insert(it.first).second);
+        }
+    }
+}
+
 // NOLINTEND(*magic-numbers,*simplify-boolean-expr)
@@ -20,4 +20,15 @@ public:
     void testMinimizeFSM();
     void testDetectCycleFSM();
     void testDFSFSM();
+    void testGeneratedSMPLS();
+    void testArenaFSM();
+    void testTypedTraversalFSM();
+    void testLabelIndexFSM();
+    void testDeterminizeSubsetsFSM();
+    void testMinimizePartitionFSM();
+    void testSearchEnginesFSM();
+    void testLazyProductFSM();
+    void testTrimFSM();
+    void testTransitionIndexFSM();
+    void testConcurrentConstructionFSM();
 };